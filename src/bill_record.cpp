@@ -0,0 +1,144 @@
+#include "bill_record.h"
+#include "car_codec.h"
+#include "mapped_file.h"
+#include "segment_index.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+constexpr std::size_t BillRecord::PLATE_BYTES;
+
+namespace bill_records {
+
+const char FILE_MAGIC[8] = { 'P', 'K', 'B', 'I', 'L', 'L', '0', '1' };
+
+namespace {
+
+/**
+ * @brief Number of bytes covered by each record's checksum.
+ */
+constexpr std::size_t CHECKED_BYTES = RECORD_SIZE - 4;
+
+/**
+ * @brief How much of the mapping is summed before its pages are released.
+ */
+constexpr std::size_t RELEASE_CHUNK = 8 * 1024 * 1024;
+
+std::int64_t toCents(const double amount) {
+    return static_cast<std::int64_t>(std::llround(amount * 100.0));
+}
+
+std::int64_t toUnixSeconds(const std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+}
+
+void putI64(std::string& out, const std::int64_t value) {
+    car_codec::putU64(out, static_cast<std::uint64_t>(value));
+}
+
+std::int64_t getI64(const char* p) {
+    return static_cast<std::int64_t>(car_codec::getU64(p));
+}
+
+}  // namespace
+
+BillRecord makeRecord(const Car& car, const FeeBreakdown& fee, const std::chrono::system_clock::time_point exitTime) {
+    BillRecord record;
+    record.carId = car.id;
+    const std::size_t plateLength = std::min(car.licensePlate.size(), BillRecord::PLATE_BYTES);
+    std::memcpy(record.plate, car.licensePlate.data(), plateLength);
+    record.entryTime = toUnixSeconds(car.parkingTime);
+    record.exitTime = toUnixSeconds(exitTime);
+    record.minutesParked = static_cast<std::uint32_t>(std::llround(fee.hours * 60.0));
+    record.grossCents = toCents(fee.gross);
+    record.discountCents = toCents(fee.discount);
+    record.gstCents = toCents(fee.gst);
+    record.totalCents = toCents(fee.total);
+    return record;
+}
+
+void encode(std::string& out, const BillRecord& record) {
+    const std::size_t start = out.size();
+    car_codec::putU32(out, static_cast<std::uint32_t>(record.carId));
+    out.append(record.plate, BillRecord::PLATE_BYTES);
+    putI64(out, record.entryTime);
+    putI64(out, record.exitTime);
+    car_codec::putU32(out, record.minutesParked);
+    putI64(out, record.grossCents);
+    putI64(out, record.discountCents);
+    putI64(out, record.gstCents);
+    putI64(out, record.totalCents);
+    car_codec::putU32(out, car_codec::crc32(out.data() + start, CHECKED_BYTES));
+}
+
+bool decode(const char* p, BillRecord& record) {
+    if (car_codec::crc32(p, CHECKED_BYTES) != car_codec::getU32(p + CHECKED_BYTES)) return false;
+    record.carId = static_cast<std::int32_t>(car_codec::getU32(p));
+    std::memcpy(record.plate, p + 4, BillRecord::PLATE_BYTES);
+    record.plate[BillRecord::PLATE_BYTES] = '\0';
+    record.entryTime = getI64(p + 24);
+    record.exitTime = getI64(p + 32);
+    record.minutesParked = car_codec::getU32(p + 40);
+    record.grossCents = getI64(p + 44);
+    record.discountCents = getI64(p + 52);
+    record.gstCents = getI64(p + 60);
+    record.totalCents = getI64(p + 68);
+    return true;
+}
+
+/**
+ * @brief Walks the records at a fixed stride, summing those whose exit time is in the window.
+ *
+ * Only the fields the sums need are read from each verified record.
+ */
+BillTotals reconcile(const std::string& path, const std::int64_t from, const std::int64_t to) {
+    BillTotals totals;
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() < sizeof(FILE_MAGIC) ||
+        std::memcmp(file.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0)
+        return totals;
+    file.adviseSequential();
+
+    const char* const base = file.data();
+    const std::size_t records = (file.size() - sizeof(FILE_MAGIC)) / RECORD_SIZE;
+    totals.truncatedTail = (file.size() - sizeof(FILE_MAGIC)) % RECORD_SIZE != 0;
+    std::size_t released = 0;
+    for (std::size_t i = 0; i < records; ++i) {
+        const char* p = base + sizeof(FILE_MAGIC) + i * RECORD_SIZE;
+        const std::size_t offset = static_cast<std::size_t>(p - base);
+        if (offset - released >= RELEASE_CHUNK) {
+            file.release(released, offset - released);
+            released = offset;
+        }
+        if (car_codec::crc32(p, CHECKED_BYTES) != car_codec::getU32(p + CHECKED_BYTES)) {
+            ++totals.corrupt;
+            continue;
+        }
+        const std::int64_t exitTime = getI64(p + 32);
+        if (exitTime >= from && exitTime < to) {
+            ++totals.bills;
+            totals.grossCents += getI64(p + 44);
+            totals.discountCents += getI64(p + 52);
+            totals.gstCents += getI64(p + 60);
+            totals.totalCents += getI64(p + 68);
+        }
+    }
+    return totals;
+}
+
+BillTotals reconcileSegments(const std::string& journalPath, const std::int64_t from, const std::int64_t to) {
+    BillTotals totals;
+    for (const std::string& file : segment_index::filesInRange(journalPath, from, to)) {
+        const BillTotals part = reconcile(file, from, to);
+        totals.bills += part.bills;
+        totals.corrupt += part.corrupt;
+        totals.truncatedTail = totals.truncatedTail || part.truncatedTail;
+        totals.grossCents += part.grossCents;
+        totals.discountCents += part.discountCents;
+        totals.gstCents += part.gstCents;
+        totals.totalCents += part.totalCents;
+    }
+    return totals;
+}
+
+}  // namespace bill_records
@@ -0,0 +1,103 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "car.h"
+#include "pricing.h"
+
+/**
+ * @struct BillRecord
+ * @brief The machine-readable form of one bill, stored alongside the human text bill.
+ *
+ * Money is kept in integer cents so that summing millions of records reproduces the billed totals
+ * exactly, with no floating-point drift.
+ */
+struct BillRecord {
+    /**
+     * @brief Number of plate characters stored; longer plates are truncated.
+     */
+    static constexpr std::size_t PLATE_BYTES = 20;
+
+    std::int32_t carId = 0;
+    char plate[PLATE_BYTES + 1] = {};  ///< NUL-terminated license plate.
+    std::int64_t entryTime = 0;        ///< Entry time in Unix seconds.
+    std::int64_t exitTime = 0;         ///< Exit time in Unix seconds.
+    std::uint32_t minutesParked = 0;   ///< Whole minutes billed.
+    std::int64_t grossCents = 0;
+    std::int64_t discountCents = 0;
+    std::int64_t gstCents = 0;
+    std::int64_t totalCents = 0;
+};
+
+/**
+ * @struct BillTotals
+ * @brief Result of a reconciliation pass over a bill record file.
+ */
+struct BillTotals {
+    std::size_t bills = 0;         ///< Records inside the time window.
+    std::size_t corrupt = 0;       ///< Records whose checksum did not match; excluded from the sums.
+    bool truncatedTail = false;    ///< True if the file ends with a partial record.
+    std::int64_t grossCents = 0;
+    std::int64_t discountCents = 0;
+    std::int64_t gstCents = 0;
+    std::int64_t totalCents = 0;
+};
+
+/**
+ * @namespace bill_records
+ * @brief Fixed-width binary encoding of bill records and the streaming reconciliation over them.
+ *
+ * A bill record file starts with the 8-byte magic FILE_MAGIC followed by RECORD_SIZE-byte records:
+ * [i32 car ID][20-byte plate, NUL padded][i64 entry][i64 exit][u32 minutes]
+ * [i64 gross][i64 discount][i64 GST][i64 total][u32 CRC-32 of the preceding 76 bytes],
+ * all little-endian. Record n therefore lives at a fixed offset and needs no parsing to locate.
+ */
+namespace bill_records {
+
+constexpr std::size_t RECORD_SIZE = 80;
+extern const char FILE_MAGIC[8];
+
+/**
+ * @brief Builds the record for a car leaving at exitTime with the given charge.
+ */
+BillRecord makeRecord(const Car& car, const FeeBreakdown& fee, std::chrono::system_clock::time_point exitTime);
+
+/**
+ * @brief Appends exactly RECORD_SIZE bytes encoding the record.
+ */
+void encode(std::string& out, const BillRecord& record);
+
+/**
+ * @brief Decodes the RECORD_SIZE bytes at p.
+ * @return False if the checksum does not match.
+ */
+bool decode(const char* p, BillRecord& record);
+
+/**
+ * @brief Sums the bills of a record file whose exit time falls in [from, to).
+ *
+ * The file is memory-mapped and walked once at a fixed stride; pages already summed are released
+ * as the pass advances, so memory use stays bounded however large the file is.
+ *
+ * @param path Path of the bill record file. A missing file sums to zero.
+ * @param from Start of the window, Unix seconds, inclusive.
+ * @param to End of the window, Unix seconds, exclusive.
+ * @return The number of bills and their summed amounts.
+ */
+BillTotals reconcile(const std::string& path, std::int64_t from, std::int64_t to);
+
+/**
+ * @brief Sums the bills of a rotated record journal whose exit time falls in [from, to).
+ *
+ * Only the segments whose time range overlaps the window are opened, so a daily reconciliation
+ * reads one or two segments however long the history is.
+ *
+ * @param journalPath Path of the active bill record file ("bill_records.bin").
+ * @param from Start of the window, Unix seconds, inclusive.
+ * @param to End of the window, Unix seconds, exclusive.
+ * @return The combined totals of the segments read.
+ */
+BillTotals reconcileSegments(const std::string& journalPath, std::int64_t from, std::int64_t to);
+
+}  // namespace bill_records
@@ -0,0 +1,113 @@
+#include "bill_renderer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+BillRenderer::BillRenderer(const std::size_t initialCapacity) : buffer(initialCapacity) {}
+
+/**
+ * @brief Renders one bill, replacing whatever the buffer held before.
+ *
+ * @param car The departing car.
+ * @param fee The itemised charge for the car's stay.
+ * @param layout Human for the decorated gate bill, Compact for a single machine-readable line.
+ */
+void BillRenderer::render(const Car& car, const FeeBreakdown& fee, const Layout layout) {
+    length = 0;
+    if (layout == Layout::Compact)
+        renderCompact(car, fee);
+    else
+        renderHuman(car, fee);
+}
+
+/**
+ * @brief Writes the bill in the same layout the gate has always printed.
+ */
+void BillRenderer::renderHuman(const Car& car, const FeeBreakdown& fee) {
+    appendLiteral("\n========= 🧾 PARKING BILL 🧾 =========\n");
+    appendLiteral("Car ID            : "); appendInt(car.id); appendLiteral("\n");
+    appendLiteral("Owner Name        : "); append(car.ownerName); appendLiteral("\n");
+    appendLiteral("License Plate     : "); append(car.licensePlate); appendLiteral("\n");
+    appendLiteral("Hours Parked      : "); appendFixed2(fee.hours); appendLiteral("\n");
+    appendLiteral("Rate per Hour (₹) : "); appendFixed2(fee.rate); appendLiteral("\n");
+    appendLiteral("Gross (₹)         : "); appendFixed2(fee.gross); appendLiteral("\n");
+    if (fee.discount > 0) {
+        appendLiteral("Discount (30%)    : -"); appendFixed2(fee.discount); appendLiteral("\n");
+    }
+    appendLiteral("GST @ 18% (₹)     : "); appendFixed2(fee.gst); appendLiteral("\n");
+    appendLiteral("TOTAL (₹)         : "); appendFixed2(fee.total); appendLiteral("\n");
+    appendLiteral("======================================\n");
+}
+
+/**
+ * @brief Writes the bill as a single line:
+ *        BILL|id|owner|plate|hours|rate|gross|discount|gst|total
+ */
+void BillRenderer::renderCompact(const Car& car, const FeeBreakdown& fee) {
+    appendLiteral("BILL|");
+    appendInt(car.id);         appendLiteral("|");
+    appendField(car.ownerName);    appendLiteral("|");
+    appendField(car.licensePlate); appendLiteral("|");
+    appendFixed2(fee.hours);   appendLiteral("|");
+    appendFixed2(fee.rate);    appendLiteral("|");
+    appendFixed2(fee.gross);   appendLiteral("|");
+    appendFixed2(fee.discount); appendLiteral("|");
+    appendFixed2(fee.gst);     appendLiteral("|");
+    appendFixed2(fee.total);   appendLiteral("\n");
+}
+
+void BillRenderer::append(const char* text, const std::size_t len) {
+    if (length + len > buffer.size())
+        buffer.resize((length + len) * 2);
+    std::memcpy(buffer.data() + length, text, len);
+    length += len;
+}
+
+void BillRenderer::appendField(const std::string& text) {
+    const std::size_t start = length;
+    append(text);
+    for (std::size_t i = start; i < length; ++i)
+        if (buffer[i] == '|' || buffer[i] == '\r' || buffer[i] == '\n') buffer[i] = ' ';
+}
+
+void BillRenderer::appendInt(const long long value) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    unsigned long long v = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                     : static_cast<unsigned long long>(value);
+    do {
+        *--p = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    if (value < 0) *--p = '-';
+    append(p, static_cast<std::size_t>(end - p));
+}
+
+/**
+ * @brief Formats a value with two decimals by rounding it to whole hundredths.
+ *
+ * Values too large to be represented as a 64-bit count of hundredths, and non-finite values,
+ * fall back to snprintf into a stack buffer, which does not allocate either.
+ *
+ * @param value The amount or quantity to print.
+ */
+void BillRenderer::appendFixed2(const double value) {
+    if (!std::isfinite(value) || std::fabs(value) >= 9.0e16) {
+        char text[352];
+        const int n = std::snprintf(text, sizeof(text), "%.2f", value);
+        if (n > 0) append(text, static_cast<std::size_t>(n) < sizeof(text) ? static_cast<std::size_t>(n) : sizeof(text) - 1);
+        return;
+    }
+    const long long hundredths = std::llround(value * 100.0);
+    const unsigned long long magnitude = hundredths < 0 ? 0ULL - static_cast<unsigned long long>(hundredths)
+                                                        : static_cast<unsigned long long>(hundredths);
+    if (hundredths < 0) appendLiteral("-");
+    appendInt(static_cast<long long>(magnitude / 100));
+    const char fraction[3] = {
+        '.',
+        static_cast<char>('0' + magnitude / 10 % 10),
+        static_cast<char>('0' + magnitude % 10)
+    };
+    append(fraction, sizeof(fraction));
+}
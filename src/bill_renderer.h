@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "car.h"
+#include "pricing.h"
+
+/**
+ * @class BillRenderer
+ * @brief Formats parking bills into a reusable, preallocated character buffer.
+ *
+ * The renderer replaces std::ostringstream-based bill formatting. Text and numbers are written
+ * directly into an internal buffer that is reused from one bill to the next, and numbers are
+ * formatted with integer arithmetic instead of locale-aware stream insertion, so rendering a bill
+ * performs no heap allocation once the buffer is large enough.
+ */
+class BillRenderer {
+public:
+    /**
+     * @enum Layout
+     * @brief The output format of a rendered bill.
+     */
+    enum class Layout {
+        Human,   ///< The decorated multi-line bill shown at the gate and kept in bill_history.txt.
+        Compact  ///< One '|' separated line per bill for machine consumption.
+    };
+
+    /**
+     * @brief Constructs a renderer with a buffer large enough for typical bills.
+     * @param initialCapacity Number of bytes to preallocate.
+     */
+    explicit BillRenderer(std::size_t initialCapacity = 1024);
+
+    /**
+     * @brief Renders the bill for a car into the internal buffer, replacing the previous bill.
+     * @param car The departing car.
+     * @param fee The itemised charge for the car's stay.
+     * @param layout The output format.
+     */
+    void render(const Car& car, const FeeBreakdown& fee, Layout layout = Layout::Human);
+
+    /**
+     * @brief Returns the rendered bill. Valid until the next call to render().
+     */
+    const char* data() const { return buffer.data(); }
+
+    /**
+     * @brief Returns the length in bytes of the rendered bill.
+     */
+    std::size_t size() const { return length; }
+
+    /**
+     * @brief Returns a copy of the rendered bill as a string.
+     */
+    std::string str() const { return std::string(buffer.data(), length); }
+
+private:
+    void renderHuman(const Car& car, const FeeBreakdown& fee);
+    void renderCompact(const Car& car, const FeeBreakdown& fee);
+
+    /**
+     * @brief Appends raw bytes, growing the buffer only if it is too small.
+     */
+    void append(const char* text, std::size_t len);
+
+    /**
+     * @brief Appends a string literal without computing its length at run time.
+     */
+    template<std::size_t N>
+    void appendLiteral(const char (&text)[N]) { append(text, N - 1); }
+
+    void append(const std::string& text) { append(text.data(), text.size()); }
+
+    /**
+     * @brief Appends a free-text field of the compact layout, with '|' and line breaks replaced
+     *        by spaces so the line keeps its fields.
+     */
+    void appendField(const std::string& text);
+
+    /**
+     * @brief Appends a signed integer in decimal.
+     */
+    void appendInt(long long value);
+
+    /**
+     * @brief Appends a value with exactly two decimal places, rounded half away from zero.
+     */
+    void appendFixed2(double value);
+
+    std::vector<char> buffer;
+    std::size_t length = 0;
+};
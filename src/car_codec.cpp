@@ -0,0 +1,127 @@
+#include "car_codec.h"
+#include <array>
+#include <chrono>
+#include <cstring>
+
+namespace car_codec {
+
+namespace {
+
+/**
+ * @brief Builds the byte-at-a-time lookup table for the reflected CRC-32 polynomial.
+ */
+std::array<std::uint32_t, 256> makeCrcTable() {
+    std::array<std::uint32_t, 256> table;
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+
+void putString(std::string& out, const std::string& value) {
+    putU32(out, static_cast<std::uint32_t>(value.size()));
+    out.append(value);
+}
+
+bool getString(const char*& p, const char* end, std::string& value) {
+    if (end - p < 4) return false;
+    const std::uint32_t length = getU32(p);
+    p += 4;
+    if (static_cast<std::size_t>(end - p) < length) return false;
+    value.assign(p, length);
+    p += length;
+    return true;
+}
+
+/**
+ * @brief Flag bits stored in the single flags byte of an encoded car.
+ */
+enum : unsigned char {
+    FLAG_RESERVED = 1,
+    FLAG_DYNAMIC = 2
+};
+
+}  // namespace
+
+void putU32(std::string& out, const std::uint32_t value) {
+    const char bytes[4] = {
+        static_cast<char>(value), static_cast<char>(value >> 8),
+        static_cast<char>(value >> 16), static_cast<char>(value >> 24)
+    };
+    out.append(bytes, 4);
+}
+
+void putU64(std::string& out, const std::uint64_t value) {
+    putU32(out, static_cast<std::uint32_t>(value));
+    putU32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+std::uint32_t getU32(const char* p) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<std::uint32_t>(b[0]) | static_cast<std::uint32_t>(b[1]) << 8 |
+           static_cast<std::uint32_t>(b[2]) << 16 | static_cast<std::uint32_t>(b[3]) << 24;
+}
+
+std::uint64_t getU64(const char* p) {
+    return static_cast<std::uint64_t>(getU32(p)) | static_cast<std::uint64_t>(getU32(p + 4)) << 32;
+}
+
+/**
+ * @brief Appends a car as: id, parking time (ns), hourly rate (IEEE-754 bits), flags, then the
+ *        twelve text fields in declaration order.
+ */
+void encodeCar(std::string& out, const Car& car) {
+    using namespace std::chrono;
+    putU32(out, static_cast<std::uint32_t>(car.id));
+    putU64(out, static_cast<std::uint64_t>(
+        duration_cast<nanoseconds>(car.parkingTime.time_since_epoch()).count()));
+    std::uint64_t rateBits;
+    std::memcpy(&rateBits, &car.hourlyRate, sizeof(rateBits));
+    putU64(out, rateBits);
+    out.push_back(static_cast<char>((car.reservedSlot ? FLAG_RESERVED : 0) |
+                                    (car.dynamicPricing ? FLAG_DYNAMIC : 0)));
+    const std::string* fields[] = {
+        &car.ownerName, &car.licensePlate, &car.model, &car.color, &car.fuelType,
+        &car.phone, &car.email, &car.membership, &car.paymentMethod, &car.slot,
+        &car.slotSize, &car.exitGate
+    };
+    for (const std::string* field : fields) putString(out, *field);
+}
+
+bool decodeCar(const char*& p, const char* end, Car& car) {
+    using namespace std::chrono;
+    const char* cursor = p;
+    if (end - cursor < 21) return false;
+    car.id = static_cast<int>(getU32(cursor));
+    const std::int64_t ns = static_cast<std::int64_t>(getU64(cursor + 4));
+    car.parkingTime = system_clock::time_point(duration_cast<system_clock::duration>(nanoseconds(ns)));
+    const std::uint64_t rateBits = getU64(cursor + 12);
+    std::memcpy(&car.hourlyRate, &rateBits, sizeof(rateBits));
+    const unsigned char flags = static_cast<unsigned char>(cursor[20]);
+    car.reservedSlot = (flags & FLAG_RESERVED) != 0;
+    car.dynamicPricing = (flags & FLAG_DYNAMIC) != 0;
+    cursor += 21;
+    std::string* fields[] = {
+        &car.ownerName, &car.licensePlate, &car.model, &car.color, &car.fuelType,
+        &car.phone, &car.email, &car.membership, &car.paymentMethod, &car.slot,
+        &car.slotSize, &car.exitGate
+    };
+    for (std::string* field : fields)
+        if (!getString(cursor, end, *field)) return false;
+    p = cursor;
+    return true;
+}
+
+std::uint32_t crc32(const void* data, const std::size_t length, const std::uint32_t seed) {
+    static const std::array<std::uint32_t, 256> table = makeCrcTable();
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint32_t c = seed ^ 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < length; ++i)
+        c = table[(c ^ bytes[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+}  // namespace car_codec
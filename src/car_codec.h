@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "car.h"
+
+/**
+ * @brief Compact binary encoding of Car records shared by the event log and snapshots.
+ *
+ * All integers are written little-endian regardless of the host, strings are length-prefixed,
+ * and the parking time is stored as nanoseconds since the Unix epoch.
+ */
+namespace car_codec {
+
+/**
+ * @brief Appends a 32-bit unsigned integer in little-endian order.
+ */
+void putU32(std::string& out, std::uint32_t value);
+
+/**
+ * @brief Appends a 64-bit unsigned integer in little-endian order.
+ */
+void putU64(std::string& out, std::uint64_t value);
+
+/**
+ * @brief Reads a little-endian 32-bit unsigned integer; the caller checks bounds.
+ */
+std::uint32_t getU32(const char* p);
+
+/**
+ * @brief Reads a little-endian 64-bit unsigned integer; the caller checks bounds.
+ */
+std::uint64_t getU64(const char* p);
+
+/**
+ * @brief Appends the binary encoding of a car.
+ * @param out Buffer to append to.
+ * @param car The car to encode.
+ */
+void encodeCar(std::string& out, const Car& car);
+
+/**
+ * @brief Decodes one car and advances the cursor past it.
+ * @param p Cursor into the encoded data; advanced on success.
+ * @param end One past the last readable byte.
+ * @param car Receives the decoded car.
+ * @return False if the data is truncated or malformed.
+ */
+bool decodeCar(const char*& p, const char* end, Car& car);
+
+/**
+ * @brief Computes the CRC-32 (IEEE 802.3) checksum of a byte range.
+ * @param data Pointer to the bytes.
+ * @param length Number of bytes.
+ * @param seed A previous CRC to continue from, or 0 to start fresh.
+ * @return The checksum.
+ */
+std::uint32_t crc32(const void* data, std::size_t length, std::uint32_t seed = 0);
+
+}  // namespace car_codec
@@ -0,0 +1,91 @@
+#include "car_csv.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+namespace car_csv {
+
+bool parseInt(const FieldView field, int& out) {
+    if (field.empty() || field.size > 9) return false;
+    int value = 0;
+    for (std::size_t i = 0; i < field.size; ++i) {
+        const char c = field.data[i];
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    out = value;
+    return true;
+}
+
+bool parseDouble(const FieldView field, double& out) {
+    char text[32];
+    if (field.empty() || field.size >= sizeof(text)) return false;
+    std::memcpy(text, field.data, field.size);
+    text[field.size] = '\0';
+    char* parsedEnd = nullptr;
+    out = std::strtod(text, &parsedEnd);
+    return parsedEnd == text + field.size;
+}
+
+bool parseCtime(const FieldView field, std::chrono::system_clock::time_point& out) {
+    static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    const char* p = field.data;
+    const char* const end = field.data + field.size;
+    if (field.size < 24) return false;
+    p += 4;  // weekday is implied by the date
+
+    std::tm tm = std::tm();
+    tm.tm_mon = -1;
+    for (int m = 0; m < 12; ++m)
+        if (std::memcmp(p, MONTHS + 3 * m, 3) == 0) tm.tm_mon = m;
+    if (tm.tm_mon < 0) return false;
+    p += 3;
+
+    int* const parts[] = { &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &tm.tm_year };
+    for (int* part : parts) {
+        while (p < end && (*p == ' ' || *p == ':')) ++p;
+        const char* digits = p;
+        while (p < end && *p >= '0' && *p <= '9') ++p;
+        if (!parseInt(FieldView(digits, static_cast<std::size_t>(p - digits)), *part)) return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_isdst = -1;
+    const std::time_t t = std::mktime(&tm);
+    if (t == static_cast<std::time_t>(-1)) return false;
+    out = std::chrono::system_clock::from_time_t(t);
+    return true;
+}
+
+bool isHeader(const FieldView& first) {
+    return first.equals("CarID");
+}
+
+bool carFromRow(const std::vector<FieldView>& fields, Car& car) {
+    if (fields.size() != ROW_FIELDS || !parseInt(fields[COL_ID], car.id) ||
+        !parseDouble(fields[COL_RATE], car.hourlyRate) || !parseCtime(fields[COL_TIME], car.parkingTime))
+        return false;
+    std::string* const text[] = {
+        &car.ownerName, &car.licensePlate, &car.model, &car.color, &car.fuelType, &car.phone,
+        &car.email, &car.membership, &car.paymentMethod, &car.slot, &car.slotSize
+    };
+    for (std::size_t i = 0; i < sizeof(text) / sizeof(text[0]); ++i)
+        text[i]->assign(fields[COL_OWNER + i].data, fields[COL_OWNER + i].size);
+    car.dynamicPricing = fields[COL_DYNAMIC].equals("Yes");
+    return true;
+}
+
+void appendField(std::string& row, const std::string& field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos) {
+        row += field;
+        return;
+    }
+    row += '"';
+    for (const char c : field) {
+        if (c == '"') row += '"';
+        row += c;
+    }
+    row += '"';
+}
+
+}  // namespace car_csv
@@ -0,0 +1,67 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "car.h"
+#include "mapped_file.h"
+
+/**
+ * @brief Writing and parsing of the car rows ParkingLot keeps in cars_data.csv and Customer_details.csv.
+ *
+ * Both files share one layout: the car's ID, its text fields, rate and pricing flag, and a local
+ * timestamp as printed by std::ctime (the entry time for admissions, the removal time for departures).
+ * Fields are parsed straight from FieldViews, without intermediate strings.
+ */
+namespace car_csv {
+
+/**
+ * @brief Number of columns in a car row.
+ */
+constexpr std::size_t ROW_FIELDS = 15;
+
+/**
+ * @brief Column positions shared by both files.
+ */
+enum Column : std::size_t {
+    COL_ID = 0, COL_OWNER, COL_PLATE, COL_MODEL, COL_COLOR, COL_FUEL, COL_PHONE, COL_EMAIL,
+    COL_MEMBERSHIP, COL_PAYMENT, COL_SLOT, COL_SIZE, COL_RATE, COL_DYNAMIC, COL_TIME
+};
+
+/**
+ * @brief Parses a non-negative decimal integer of at most nine digits.
+ */
+bool parseInt(FieldView field, int& out);
+
+/**
+ * @brief Parses a decimal number; the whole field must be consumed.
+ */
+bool parseDouble(FieldView field, double& out);
+
+/**
+ * @brief Parses a local time written by std::ctime, e.g. "Wed Aug 13 12:34:53 2025".
+ */
+bool parseCtime(FieldView field, std::chrono::system_clock::time_point& out);
+
+/**
+ * @brief Returns true if the field is the "CarID" heading of a header row.
+ */
+bool isHeader(const FieldView& first);
+
+/**
+ * @brief Builds a car from a split row, copying only the fields the car keeps.
+ *
+ * The row's timestamp becomes the car's parking time. The reserved flag and exit gate are not
+ * stored in the files and keep their defaults.
+ *
+ * @return False if the row has the wrong number of fields or a field does not parse.
+ */
+bool carFromRow(const std::vector<FieldView>& fields, Car& car);
+
+/**
+ * @brief Appends a text field to a row being written, quoted if it holds a comma, a quote or a line
+ *        break (with quotes doubled), so the row keeps ROW_FIELDS columns for CsvReader.
+ */
+void appendField(std::string& row, const std::string& field);
+
+}  // namespace car_csv
@@ -0,0 +1,157 @@
+#include "csv_reader.h"
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief How far the reader advances before releasing the pages behind it.
+ */
+constexpr std::size_t RELEASE_CHUNK = 16 * 1024 * 1024;
+
+/**
+ * @brief Returns the record's bytes without the trailing line break.
+ */
+FieldView trimLineEnd(const char* begin, const char* next) {
+    const char* end = next;
+    if (end > begin && end[-1] == '\n') --end;
+    if (end > begin && end[-1] == '\r') --end;
+    return FieldView(begin, static_cast<std::size_t>(end - begin));
+}
+
+}  // namespace
+
+CsvReader::CsvReader(const std::string& path, const char delimiter, const bool hasHeader)
+    : file(path), delimiter(delimiter), hasHeader(hasHeader) {
+    cursor = file.data();
+    file.adviseSequential();
+    current.reserve(32);
+    if (!hasHeader) return;
+    const char* const end = file.data() + file.size();
+    while (cursor && cursor < end && headerRaw.empty()) {
+        const char* start = cursor;
+        cursor = parseRecord(cursor, end, delimiter, current, scratch);
+        headerRaw = trimLineEnd(start, cursor);
+    }
+    for (const FieldView& name : current) headerNames.push_back(name.str());
+    current.clear();
+}
+
+/**
+ * @brief Splits a record into fields.
+ *
+ * Most records have no quotes at all; those are split with memchr over the line. A quoted field runs to the matching closing quote; characters between that quote and the next
+ * delimiter are ignored. Fields with "" escapes are unescaped into scratch, and their views are
+ * pointed into scratch only after the whole record is parsed, since scratch may grow meanwhile.
+ */
+const char* CsvReader::parseRecord(const char* p, const char* const end, const char delimiter,
+                                   std::vector<FieldView>& fields, std::string& scratch,
+                                   const std::size_t fieldLimit) {
+    fields.clear();
+    scratch.clear();
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    const char* lineEnd = nl ? nl : end;
+    if (!std::memchr(p, '"', static_cast<std::size_t>(lineEnd - p))) {
+        if (lineEnd > p && lineEnd[-1] == '\r') --lineEnd;
+        const char* next = nl ? nl + 1 : end;
+        for (;;) {
+            if (fieldLimit && fields.size() + 1 == fieldLimit) {
+                const char* cut = static_cast<const char*>(std::memchr(p, delimiter, static_cast<std::size_t>(lineEnd - p)));
+                fields.push_back(FieldView(p, static_cast<std::size_t>((cut ? cut : lineEnd) - p)));
+                return next;
+            }
+            const char* cut = static_cast<const char*>(std::memchr(p, delimiter, static_cast<std::size_t>(lineEnd - p)));
+            if (!cut) break;
+            fields.push_back(FieldView(p, static_cast<std::size_t>(cut - p)));
+            p = cut + 1;
+        }
+        fields.push_back(FieldView(p, static_cast<std::size_t>(lineEnd - p)));
+        return next;
+    }
+
+    const std::size_t NOT_ESCAPED = static_cast<std::size_t>(-1);
+    std::vector<std::size_t>* escapedOffsets = nullptr;
+    std::vector<std::size_t> offsets;
+
+    for (;;) {
+        if (p < end && *p == '"') {
+            const char* content = ++p;
+            bool escaped = false;
+            for (;;) {
+                const char* quote = static_cast<const char*>(std::memchr(p, '"', static_cast<std::size_t>(end - p)));
+                if (!quote) { p = end; break; }
+                if (quote + 1 < end && quote[1] == '"') { escaped = true; p = quote + 2; continue; }
+                p = quote;
+                break;
+            }
+            const char* contentEnd = p;
+            if (p < end) ++p;
+            if (escaped) {
+                if (!escapedOffsets) {
+                    offsets.assign(fields.size(), NOT_ESCAPED);
+                    escapedOffsets = &offsets;
+                }
+                escapedOffsets->push_back(scratch.size());
+                for (const char* c = content; c < contentEnd; ++c) {
+                    scratch += *c;
+                    if (*c == '"') ++c;
+                }
+                fields.push_back(FieldView(nullptr, scratch.size() - escapedOffsets->back()));
+            } else {
+                if (escapedOffsets) escapedOffsets->push_back(NOT_ESCAPED);
+                fields.push_back(FieldView(content, static_cast<std::size_t>(contentEnd - content)));
+            }
+            while (p < end && *p != delimiter && *p != '\n') ++p;
+        } else {
+            const char* start = p;
+            while (p < end && *p != delimiter && *p != '\n') ++p;
+            const char* fieldEnd = (p > start && (p == end || *p == '\n') && p[-1] == '\r') ? p - 1 : p;
+            if (escapedOffsets) escapedOffsets->push_back(NOT_ESCAPED);
+            fields.push_back(FieldView(start, static_cast<std::size_t>(fieldEnd - start)));
+        }
+
+        if (p < end && *p == delimiter) { ++p; continue; }
+        if (p < end) ++p;  // the line break
+        break;
+    }
+
+    if (escapedOffsets)
+        for (std::size_t i = 0; i < fields.size(); ++i)
+            if (offsets[i] != NOT_ESCAPED) fields[i].data = scratch.data() + offsets[i];
+    if (fieldLimit && fields.size() > fieldLimit) fields.resize(fieldLimit);
+    return p;
+}
+
+/**
+ * @brief Parses records until one that is neither empty nor a repeat of the header.
+ */
+bool CsvReader::next() {
+    const char* const end = file.data() + file.size();
+    while (cursor && cursor < end) {
+        const std::size_t offset = static_cast<std::size_t>(cursor - file.data());
+        if (offset - released >= RELEASE_CHUNK) {
+            file.release(released, offset - released);
+            released = offset;
+        }
+
+        const char* start = cursor;
+        cursor = parseRecord(cursor, end, delimiter, current, scratch, fieldLimit);
+        rawRecord = trimLineEnd(start, cursor);
+        if (rawRecord.empty()) continue;
+
+        if (hasHeader && rawRecord.size == headerRaw.size &&
+            std::memcmp(rawRecord.data, headerRaw.data, rawRecord.size) == 0) {
+            ++repeatedHeaders;
+            continue;
+        }
+        ++records;
+        return true;
+    }
+    current.clear();
+    return false;
+}
+
+int CsvReader::column(const char* name) const {
+    for (std::size_t i = 0; i < headerNames.size(); ++i)
+        if (headerNames[i] == name) return static_cast<int>(i);
+    return -1;
+}
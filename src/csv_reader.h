@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+/**
+ * @class CsvReader
+ * @brief Streaming, zero-copy reader for CSV files such as Customer_details.csv.
+ *
+ * The file is memory-mapped and walked one record at a time. Each record's fields are exposed as
+ * FieldViews into the mapping, so reading allocates nothing per row or per field; only a field that
+ * contains escaped quotes ("") is unescaped, into a scratch buffer the reader reuses. Quoted fields
+ * may contain delimiters and line breaks. Pages already read are released as the reader advances,
+ * so resident memory stays bounded on files of any size.
+ *
+ * With a header, the first non-empty record is taken as the header and any later record identical
+ * to it, as appended by writers that repeat the header, is skipped. Empty lines are skipped.
+ */
+class CsvReader {
+public:
+    /**
+     * @brief Opens and maps a CSV file and reads its header; check isOpen() for success.
+     * @param path Path of the file.
+     * @param delimiter Field separator.
+     * @param hasHeader Whether the first record names the columns.
+     */
+    explicit CsvReader(const std::string& path, char delimiter = ',', bool hasHeader = true);
+
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    /**
+     * @brief Returns true if the file was mapped.
+     */
+    bool isOpen() const { return file.isOpen(); }
+
+    /**
+     * @brief Advances to the next data record.
+     * @return False at the end of the file.
+     */
+    bool next();
+
+    /**
+     * @brief Splits at most the first limit fields of each record; 0, the default, splits them all.
+     *
+     * A scan that only needs the leading columns skips the work of splitting the rest of every row.
+     * raw() still covers the whole record.
+     */
+    void setFieldLimit(std::size_t limit) { fieldLimit = limit; }
+
+    /**
+     * @brief Returns the fields of the current record. Valid until the next call to next().
+     */
+    const std::vector<FieldView>& fields() const { return current; }
+
+    /**
+     * @brief Returns one field of the current record, or an empty view if the record is shorter.
+     */
+    FieldView field(std::size_t index) const { return index < current.size() ? current[index] : FieldView(); }
+
+    /**
+     * @brief Returns the raw bytes of the current record, without its line ending. Valid while the reader lives.
+     */
+    FieldView raw() const { return rawRecord; }
+
+    /**
+     * @brief Returns the column names from the header, empty if there is none.
+     */
+    const std::vector<std::string>& header() const { return headerNames; }
+
+    /**
+     * @brief Returns the position of a named column, or -1 if the header has no such column.
+     */
+    int column(const char* name) const;
+
+    /**
+     * @brief Returns the number of data records returned so far.
+     */
+    std::size_t getRecordCount() const { return records; }
+
+    /**
+     * @brief Returns the number of repeated header records skipped so far.
+     */
+    std::size_t getRepeatedHeaderCount() const { return repeatedHeaders; }
+
+    /**
+     * @brief Returns the size of the mapped file in bytes.
+     */
+    std::size_t size() const { return file.size(); }
+
+    /**
+     * @brief Splits one CSV record into fields.
+     *
+     * Views point into [begin, end) except for fields with escaped quotes, which point into scratch.
+     *
+     * @param begin Start of the record.
+     * @param end End of the buffer; the record ends at the first line break outside quotes.
+     * @param delimiter Field separator.
+     * @param fields Receives the fields; cleared first.
+     * @param scratch Reused storage for unescaped fields; cleared first.
+     * @param fieldLimit Maximum number of fields to return, or 0 for all.
+     * @return The start of the following record.
+     */
+    static const char* parseRecord(const char* begin, const char* end, char delimiter,
+                                   std::vector<FieldView>& fields, std::string& scratch,
+                                   std::size_t fieldLimit = 0);
+
+private:
+    MappedFile file;
+    char delimiter;
+    bool hasHeader;
+    std::size_t fieldLimit = 0;
+    const char* cursor = nullptr;
+    std::size_t released = 0;
+    FieldView rawRecord;
+    FieldView headerRaw;
+    std::vector<FieldView> current;
+    std::string scratch;
+    std::vector<std::string> headerNames;
+    std::size_t records = 0;
+    std::size_t repeatedHeaders = 0;
+};
@@ -0,0 +1,142 @@
+#include "event_log.h"
+#include "car_codec.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Identifies a parking event log and its format version.
+ */
+const char LOG_MAGIC[8] = { 'P', 'K', 'E', 'V', 'L', 'O', 'G', '1' };
+
+/**
+ * @brief Size of the [length][crc] frame header and of the [lsn][type] body prefix.
+ */
+constexpr std::size_t FRAME_HEADER = 8;
+constexpr std::size_t BODY_PREFIX = 9;
+
+/**
+ * @brief Reads a whole file into memory with plain read() calls.
+ * @return False if the file does not exist or cannot be read.
+ */
+bool readWholeFile(const std::string& path, std::string& out) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0)
+        out.resize(static_cast<std::size_t>(info.st_size));
+    std::size_t filled = 0;
+    while (filled < out.size()) {
+        const ssize_t n = ::read(fd, &out[filled], out.size() - filled);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        filled += static_cast<std::size_t>(n);
+    }
+    out.resize(filled);
+    ::close(fd);
+    return true;
+}
+
+}  // namespace
+
+JournalOptions EventLog::writeThroughOptions() {
+    JournalOptions options;
+    options.flushBytes = 0;
+    return options;
+}
+
+EventLog::EventLog(const std::string& path, const std::uint64_t nextLsn, const JournalOptions& options)
+    : journal(path, std::string(LOG_MAGIC, sizeof(LOG_MAGIC)), options), nextLsn(nextLsn) {}
+
+void EventLog::appendAdmission(const Car& car) {
+    scratch.clear();
+    car_codec::encodeCar(scratch, car);
+    appendRecord(LogEventType::Admission);
+}
+
+void EventLog::appendDeparture(const int carId) {
+    scratch.clear();
+    car_codec::putU32(scratch, static_cast<std::uint32_t>(carId));
+    appendRecord(LogEventType::Departure);
+}
+
+/**
+ * @brief Wraps the encoded payload in scratch with its LSN, type, length and checksum.
+ */
+void EventLog::appendRecord(const LogEventType type) {
+    frame.clear();
+    car_codec::putU32(frame, static_cast<std::uint32_t>(BODY_PREFIX + scratch.size()));
+    car_codec::putU32(frame, 0);
+    car_codec::putU64(frame, nextLsn++);
+    frame.push_back(static_cast<char>(type));
+    frame.append(scratch);
+    const std::uint32_t crc = car_codec::crc32(frame.data() + FRAME_HEADER, frame.size() - FRAME_HEADER);
+    for (int i = 0; i < 4; ++i)
+        frame[4 + i] = static_cast<char>(crc >> (8 * i));
+    journal.append(frame);
+}
+
+/**
+ * @brief Replays a log file record by record.
+ *
+ * The file is read into memory in one pass and decoded in place. Each record's length and CRC are
+ * verified before it is decoded; the first record that fails ends the replay. With repairTail the
+ * file is then truncated to the end of the last valid record.
+ *
+ * @param path Path of the log file.
+ * @param apply Called once per valid record.
+ * @param repairTail Whether to cut off a torn tail.
+ * @return Counts and the position of the last valid record.
+ */
+ReplayStats EventLog::replay(const std::string& path, const std::function<void(const LogEvent&)>& apply,
+                             const bool repairTail) {
+    ReplayStats stats;
+    std::string data;
+    if (!readWholeFile(path, data) || data.empty()) return stats;
+    if (data.size() < sizeof(LOG_MAGIC) || data.compare(0, sizeof(LOG_MAGIC), LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+        stats.badHeader = true;
+        return stats;
+    }
+
+    LogEvent event;
+    const char* p = data.data() + sizeof(LOG_MAGIC);
+    const char* const end = data.data() + data.size();
+    stats.validBytes = sizeof(LOG_MAGIC);
+    while (p < end) {
+        if (static_cast<std::size_t>(end - p) < FRAME_HEADER) { stats.tornTail = true; break; }
+        const std::uint32_t length = car_codec::getU32(p);
+        const std::uint32_t crc = car_codec::getU32(p + 4);
+        const char* body = p + FRAME_HEADER;
+        if (length < BODY_PREFIX || static_cast<std::size_t>(end - body) < length ||
+            car_codec::crc32(body, length) != crc) {
+            stats.tornTail = true;
+            break;
+        }
+
+        event.lsn = car_codec::getU64(body);
+        event.type = static_cast<LogEventType>(body[8]);
+        const char* payload = body + BODY_PREFIX;
+        const char* payloadEnd = body + length;
+        bool ok = false;
+        if (event.type == LogEventType::Admission) {
+            ok = car_codec::decodeCar(payload, payloadEnd, event.car);
+        } else if (event.type == LogEventType::Departure && payloadEnd - payload >= 4) {
+            event.car.id = static_cast<int>(car_codec::getU32(payload));
+            ok = true;
+        }
+        if (!ok) { stats.tornTail = true; break; }
+
+        apply(event);
+        ++stats.events;
+        stats.lastLsn = event.lsn;
+        p = body + length;
+        stats.validBytes = static_cast<std::size_t>(p - data.data());
+    }
+
+    if (repairTail && stats.tornTail && ::truncate(path.c_str(), static_cast<off_t>(stats.validBytes)) != 0)
+        stats.validBytes = data.size();
+    return stats;
+}
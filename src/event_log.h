@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "car.h"
+#include "journal_writer.h"
+
+/**
+ * @enum LogEventType
+ * @brief Kinds of records stored in the parking event log.
+ */
+enum class LogEventType : std::uint8_t {
+    Admission = 1,  ///< A car entered the lot; the record holds the full car.
+    Departure = 2   ///< A car left the lot; the record holds its ID.
+};
+
+/**
+ * @struct LogEvent
+ * @brief One decoded record of the event log.
+ */
+struct LogEvent {
+    LogEventType type = LogEventType::Admission;
+    std::uint64_t lsn = 0;  ///< Log sequence number, increasing by one per record.
+    Car car;                ///< The admitted car, or for departures a car whose only meaningful field is id.
+};
+
+/**
+ * @struct ReplayStats
+ * @brief Outcome of reading an event log from disk.
+ */
+struct ReplayStats {
+    std::size_t events = 0;       ///< Number of valid records applied.
+    std::uint64_t lastLsn = 0;    ///< Sequence number of the last valid record, 0 if none.
+    std::size_t validBytes = 0;   ///< Length of the file up to the end of the last valid record.
+    bool tornTail = false;        ///< True if trailing bytes failed their length or checksum check.
+    bool badHeader = false;       ///< True if the file exists but does not start with the log magic.
+};
+
+/**
+ * @class EventLog
+ * @brief Append-only binary write-ahead log of admissions and departures.
+ *
+ * The file starts with an 8-byte magic string followed by records framed as
+ * [u32 body length][u32 CRC-32 of body][body], where the body is [u64 LSN][u8 type][payload].
+ * Admissions carry the car encoded with car_codec; departures carry the car ID. Records are
+ * written through a JournalWriter which, by default, hands every record to the kernel as soon as
+ * it is appended so that a process crash loses nothing.
+ *
+ * On startup the log is replayed to rebuild the set of parked cars. Replay stops at the first
+ * record whose frame or checksum is invalid, which is how a record torn by a crash mid-write is
+ * detected; the torn tail can then be cut off so new records follow the last good one.
+ */
+class EventLog {
+public:
+    /**
+     * @brief Journal options that write each record through to the kernel immediately.
+     */
+    static JournalOptions writeThroughOptions();
+
+    /**
+     * @brief Opens (creating if needed) the log for appending.
+     * @param path Path of the log file.
+     * @param nextLsn Sequence number to give the next appended record.
+     * @param options Buffering of appended records.
+     */
+    EventLog(const std::string& path, std::uint64_t nextLsn, const JournalOptions& options = writeThroughOptions());
+
+    /**
+     * @brief Appends an admission record for the car.
+     */
+    void appendAdmission(const Car& car);
+
+    /**
+     * @brief Appends a departure record for the car ID.
+     */
+    void appendDeparture(int carId);
+
+    /**
+     * @brief Writes any buffered records to the file.
+     */
+    void flush() { journal.flush(); }
+
+    /**
+     * @brief Returns the sequence number of the most recently appended record.
+     */
+    std::uint64_t getLastLsn() const { return nextLsn - 1; }
+
+    /**
+     * @brief Returns the path of the log file.
+     */
+    const std::string& getPath() const { return journal.getPath(); }
+
+    /**
+     * @brief Reads a log file and calls apply for every valid record, in order.
+     *
+     * The same LogEvent object is reused for every call so that decoding does not reallocate the
+     * car's strings for each record; apply must copy anything it keeps.
+     *
+     * @param path Path of the log file. A missing file replays nothing.
+     * @param apply Called once per valid record.
+     * @param repairTail If true, a torn tail is truncated away so appends continue after the last good record.
+     * @return Counts and the position of the last valid record.
+     */
+    static ReplayStats replay(const std::string& path, const std::function<void(const LogEvent&)>& apply,
+                              bool repairTail = false);
+
+private:
+    /**
+     * @brief Frames the body currently in scratch and appends it to the journal.
+     */
+    void appendRecord(LogEventType type);
+
+    JournalWriter journal;
+    std::uint64_t nextLsn;
+    std::string scratch;
+    std::string frame;
+};
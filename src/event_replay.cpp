@@ -0,0 +1,58 @@
+#include "event_replay.h"
+#include "gate_protocol.h"
+#include <chrono>
+#include <cstdio>
+#include <istream>
+
+/**
+ * @brief Dispatches each line to the lot, counting outcomes; only the first malformed line is described.
+ */
+GateReplayStats replayGateEvents(ParkingLot& lot, std::istream& in) {
+    GateReplayStats stats;
+    std::string line;
+    GateCommand command;
+    std::size_t lineNumber = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#' || line == "\r") continue;
+        if (const char* error = parseGateCommand(line, command)) {
+            if (stats.rejected++ == 0) stats.firstError = "line " + std::to_string(lineNumber) + ": " + error;
+            continue;
+        }
+        ++stats.events;
+        switch (command.type) {
+        case GateCommandType::Park:
+            ++(lot.admit(command.admission) != 0 ? stats.parked : stats.refused);
+            break;
+        case GateCommandType::Remove:
+            ++(lot.removeCarByIdAndOwner(command.carId, command.owner) ? stats.removed : stats.unknownCars);
+            break;
+        case GateCommandType::Quote:
+            ++(lot.quoteFee(command.carId) >= 0.0 ? stats.quotes : stats.unknownCars);
+            break;
+        case GateCommandType::Lookup:
+            ++(lot.getCarByID(command.carId).id == command.carId ? stats.lookups : stats.unknownCars);
+            break;
+        case GateCommandType::Display:
+            lot.displayCars();
+            ++stats.displays;
+            break;
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+std::string formatReplayReport(const GateReplayStats& s) {
+    char text[512];
+    const double rate = s.seconds > 0.0 ? static_cast<double>(s.events) / s.seconds : 0.0;
+    std::snprintf(text, sizeof(text),
+                  "Replayed %zu events in %.3f s (%.0f events/s, %.2f us/event)\n"
+                  "Parked %zu, refused %zu, removed %zu, quoted %zu, looked up %zu, displayed %zu, unknown car %zu\n"
+                  "Rejected %zu malformed line(s)%s%s\n",
+                  s.events, s.seconds, rate, s.events > 0 ? s.seconds * 1e6 / static_cast<double>(s.events) : 0.0,
+                  s.parked, s.refused, s.removed, s.quotes, s.lookups, s.displays, s.unknownCars,
+                  s.rejected, s.firstError.empty() ? "" : "; first at ", s.firstError.c_str());
+    return text;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+class ParkingLot;
+
+/**
+ * @struct GateReplayStats
+ * @brief What a replay did and how long it took.
+ */
+struct GateReplayStats {
+    std::size_t events = 0;       ///< Lines that held a well-formed event.
+    std::size_t parked = 0;       ///< PARK events that admitted a car.
+    std::size_t refused = 0;      ///< PARK events refused for lack of a slot.
+    std::size_t removed = 0;      ///< REMOVE events that removed a car.
+    std::size_t displays = 0;     ///< DISPLAY events.
+    std::size_t quotes = 0;       ///< QUOTE events answered for a parked car.
+    std::size_t lookups = 0;      ///< LOOKUP events that found a parked car.
+    std::size_t unknownCars = 0;  ///< REMOVE, QUOTE and LOOKUP events naming no parked car, or the wrong owner.
+    std::size_t rejected = 0;     ///< Malformed lines, skipped.
+    std::string firstError;       ///< "line N: reason" for the first rejected line, if any.
+    double seconds = 0.0;         ///< Wall time from the first line read to the last event processed.
+};
+
+/**
+ * @brief Feeds a stream of gate events through a lot as fast as it will take them.
+ *
+ * One gate record per line, as parsed by parseGateCommand(): PARK, REMOVE, QUOTE, LOOKUP or
+ * DISPLAY with '|'-separated fields. Blank lines and lines starting with '#' are skipped, and
+ * malformed lines are counted and skipped; the replay carries on.
+ *
+ * @param lot The lot to drive.
+ * @param in The events, e.g. a file or std::cin.
+ * @return Counts of what happened and the elapsed time.
+ */
+GateReplayStats replayGateEvents(ParkingLot& lot, std::istream& in);
+
+/**
+ * @brief Formats a replay's counts and throughput for the console.
+ */
+std::string formatReplayReport(const GateReplayStats& stats);
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include <sys/un.h>
+
+/**
+ * @brief Fills in the address of a Unix domain socket.
+ * @return False if the path does not fit in sockaddr_un.
+ */
+bool gateSocketAddress(const std::string& socketPath, sockaddr_un& address);
+
+/**
+ * @brief Connects to a Unix domain socket, e.g. a GateServer's.
+ * @return The connected, blocking socket, or -1 on failure.
+ */
+int connectGateSocket(const std::string& socketPath);
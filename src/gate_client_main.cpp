@@ -0,0 +1,95 @@
+#include "gate_client.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @brief Prints how to run the client.
+ */
+static void usage(const char* program) {
+    std::cerr << "Usage: " << program << " <socket>\n"
+              << "  Sends gate records from stdin, one per line, to a daemon started with --daemon <socket>\n"
+              << "  and prints one reply per record.\n";
+}
+
+/**
+ * @brief Writes all of a buffer to a socket.
+ * @return False if the connection failed.
+ */
+static bool sendAll(const int fd, const char* data, std::size_t length) {
+    while (length > 0) {
+        const ssize_t written = ::send(fd, data, length, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        length -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief A stub gate client: pipelines every record on stdin to a gate daemon and prints the replies.
+ *
+ * Requests are sent from a second thread while replies are read, so the client never waits for one
+ * reply before sending the next request. When stdin ends the sending side is shut down, and the
+ * client exits once the daemon has answered everything.
+ *
+ * @return 0 on success, 1 if the daemon cannot be reached, 2 on a bad command line.
+ */
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    const int fd = connectGateSocket(argv[1]);
+    if (fd < 0) {
+        std::cerr << "Cannot connect to " << argv[1] << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t requests = 0;
+    std::thread sender([fd, &requests] {
+        std::string batch;
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            batch += line;
+            batch += '\n';
+            ++requests;
+            if (batch.size() >= 64 * 1024) {
+                if (!sendAll(fd, batch.data(), batch.size())) break;
+                batch.clear();
+            }
+        }
+        sendAll(fd, batch.data(), batch.size());
+        ::shutdown(fd, SHUT_WR);
+    });
+
+    std::size_t replies = 0;
+    char buffer[64 * 1024];
+    while (true) {
+        const ssize_t received = ::read(fd, buffer, sizeof(buffer));
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        for (ssize_t i = 0; i < received; ++i)
+            if (buffer[i] == '\n') ++replies;
+        std::cout.write(buffer, received);
+    }
+    sender.join();
+    ::close(fd);
+    std::cout.flush();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    char summary[128];
+    std::snprintf(summary, sizeof(summary), "%zu requests, %zu replies in %.3f s\n", requests, replies, seconds);
+    std::cerr << summary;
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include "gate_protocol.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief A cursor over the fields of one record.
+ */
+class FieldReader {
+public:
+    FieldReader(const char* begin, const char* end) : cursor(begin), end(end) {}
+
+    /**
+     * @brief Moves to the next field.
+     * @return False if the record has no more fields.
+     */
+    bool next() {
+        if (done) return false;
+        fieldBegin = cursor;
+        const void* bar = std::memchr(cursor, '|', static_cast<std::size_t>(end - cursor));
+        fieldEnd = bar ? static_cast<const char*>(bar) : end;
+        done = !bar;
+        cursor = bar ? fieldEnd + 1 : end;
+        return true;
+    }
+
+    bool atEnd() const { return done; }
+    std::size_t size() const { return static_cast<std::size_t>(fieldEnd - fieldBegin); }
+    bool is(const char* text) const { return size() == std::strlen(text) && std::memcmp(fieldBegin, text, size()) == 0; }
+    void copyTo(std::string& out) const { out.assign(fieldBegin, size()); }
+
+    bool digits() const {
+        if (fieldBegin == fieldEnd) return false;
+        for (const char* p = fieldBegin; p != fieldEnd; ++p)
+            if (*p < '0' || *p > '9') return false;
+        return true;
+    }
+
+    bool contains(const char c) const { return std::memchr(fieldBegin, c, size()) != nullptr; }
+
+    bool flag(bool& value) const {
+        if (size() != 1) return false;
+        switch (*fieldBegin) {
+        case 'y': case 'Y': value = true; return true;
+        case 'n': case 'N': value = false; return true;
+        default: return false;
+        }
+    }
+
+    /**
+     * @brief Reads a positive car ID of at most nine digits.
+     */
+    bool id(int& value) const {
+        if (!digits() || size() > 9) return false;
+        int parsed = 0;
+        for (const char* p = fieldBegin; p != fieldEnd; ++p) parsed = parsed * 10 + (*p - '0');
+        value = parsed;
+        return parsed > 0;
+    }
+
+    /**
+     * @brief Reads a plain decimal number (digits with at most one '.') from 0 to max.
+     *
+     * Signs, exponents, hex, whitespace, "inf" and "nan" are refused, so the value is always finite.
+     */
+    bool number(double& value, const double max) const {
+        char text[32];
+        if (size() == 0 || size() >= sizeof(text)) return false;
+        bool digit = false;
+        bool point = false;
+        for (const char* p = fieldBegin; p != fieldEnd; ++p) {
+            if (*p >= '0' && *p <= '9') digit = true;
+            else if (*p == '.' && !point) point = true;
+            else return false;
+        }
+        if (!digit) return false;
+        std::memcpy(text, fieldBegin, size());
+        text[size()] = '\0';
+        char* stop = nullptr;
+        value = std::strtod(text, &stop);
+        return *stop == '\0' && value <= max;
+    }
+
+private:
+    const char* cursor;
+    const char* end;
+    const char* fieldBegin = nullptr;
+    const char* fieldEnd = nullptr;
+    bool done = false;
+};
+
+/**
+ * @brief Reads one text field of a PARK record into its destination.
+ */
+bool textField(FieldReader& fields, std::string& out) {
+    if (!fields.next()) return false;
+    fields.copyTo(out);
+    return true;
+}
+
+const char* parsePark(FieldReader& fields, AdmissionRequest& request) {
+    static const char* const tooFew = "PARK needs 16 fields";
+    if (!textField(fields, request.ownerName) || !textField(fields, request.licensePlate) ||
+        !textField(fields, request.model) || !textField(fields, request.color) ||
+        !textField(fields, request.fuelType))
+        return tooFew;
+    if (!fields.next()) return tooFew;
+    if (!fields.digits()) return "phone must be digits";
+    fields.copyTo(request.phone);
+    if (!fields.next()) return tooFew;
+    if (!fields.contains('@')) return "email must contain '@'";
+    fields.copyTo(request.email);
+    if (!textField(fields, request.membership) || !textField(fields, request.paymentMethod) ||
+        !textField(fields, request.slot) || !textField(fields, request.slotSize))
+        return tooFew;
+    if (!fields.next()) return tooFew;
+    if (!fields.flag(request.reservedSlot)) return "reserved slot must be y or n";
+    if (!textField(fields, request.exitGate)) return tooFew;
+    if (!fields.next()) return tooFew;
+    if (!fields.number(request.hourlyRate, MAX_GATE_HOURLY_RATE)) return "hourly rate must be a number from 0 to 100000";
+    if (!fields.next()) return tooFew;
+    if (!fields.flag(request.dynamicPricing)) return "dynamic pricing must be y or n";
+    if (!fields.next()) return tooFew;
+    if (!fields.number(request.parkingHours, MAX_GATE_PARKING_HOURS)) return "hours must be a number from 0 to 8784";
+    return fields.atEnd() ? nullptr : tooFew;
+}
+
+/**
+ * @brief Reads the car ID field shared by REMOVE, QUOTE and LOOKUP.
+ */
+const char* parseCarId(FieldReader& fields, int& id, const char* usage) {
+    return fields.next() && fields.id(id) ? nullptr : usage;
+}
+
+void appendField(std::string& out, const std::string& field) {
+    out += '|';
+    const std::size_t start = out.size();
+    out += field;
+    for (std::size_t i = start; i < out.size(); ++i)
+        if (out[i] == '|' || out[i] == '\r' || out[i] == '\n') out[i] = ' ';
+}
+
+/**
+ * @brief Appends a number the way FieldReader::number reads it: a plain decimal from 0 to max.
+ *
+ * Six decimals with trailing zeros trimmed; values outside the range (or NaN) are clamped to it.
+ */
+void appendNumber(std::string& out, double value, const double max) {
+    if (!(value >= 0)) value = 0;
+    if (value > max) value = max;
+    char number[32];
+    int length = std::snprintf(number, sizeof(number), "|%.6f", value);
+    while (number[length - 1] == '0') --length;
+    if (number[length - 1] == '.') --length;
+    out.append(number, static_cast<std::size_t>(length));
+}
+
+}  // namespace
+
+const char* parseGateCommand(const char* data, std::size_t length, GateCommand& command) {
+    if (length > 0 && data[length - 1] == '\n') --length;
+    if (length > 0 && data[length - 1] == '\r') --length;
+    FieldReader fields(data, data + length);
+    fields.next();
+    if (fields.is("PARK")) {
+        command.type = GateCommandType::Park;
+        return parsePark(fields, command.admission);
+    }
+    if (fields.is("REMOVE")) {
+        command.type = GateCommandType::Remove;
+        static const char* const usage = "REMOVE needs a car ID and an owner";
+        if (const char* error = parseCarId(fields, command.carId, usage)) return error;
+        if (!fields.next()) return usage;
+        fields.copyTo(command.owner);
+        return fields.atEnd() ? nullptr : usage;
+    }
+    if (fields.is("QUOTE") || fields.is("LOOKUP")) {
+        const bool quote = fields.is("QUOTE");
+        command.type = quote ? GateCommandType::Quote : GateCommandType::Lookup;
+        const char* usage = quote ? "QUOTE needs a car ID" : "LOOKUP needs a car ID";
+        if (const char* error = parseCarId(fields, command.carId, usage)) return error;
+        return fields.atEnd() ? nullptr : usage;
+    }
+    if (fields.is("DISPLAY")) {
+        command.type = GateCommandType::Display;
+        return fields.atEnd() ? nullptr : "DISPLAY takes no fields";
+    }
+    return "unknown command";
+}
+
+void appendParkRecord(const AdmissionRequest& r, std::string& out) {
+    out += "PARK";
+    appendField(out, r.ownerName);
+    appendField(out, r.licensePlate);
+    appendField(out, r.model);
+    appendField(out, r.color);
+    appendField(out, r.fuelType);
+    appendField(out, r.phone);
+    appendField(out, r.email);
+    appendField(out, r.membership);
+    appendField(out, r.paymentMethod);
+    appendField(out, r.slot);
+    appendField(out, r.slotSize);
+    out += r.reservedSlot ? "|y" : "|n";
+    appendField(out, r.exitGate);
+    appendNumber(out, r.hourlyRate, MAX_GATE_HOURLY_RATE);
+    out += r.dynamicPricing ? "|y" : "|n";
+    appendNumber(out, r.parkingHours, MAX_GATE_PARKING_HOURS);
+    out += '\n';
+}
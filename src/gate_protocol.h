@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "parking_lot.h"
+
+/**
+ * @brief The requests a gate controller can send.
+ */
+enum class GateCommandType {
+    Park,     ///< PARK|owner|plate|model|color|fuel|phone|email|membership|payment|slot|size|reserved|exit gate|rate|dynamic|hours
+    Remove,   ///< REMOVE|car id|owner
+    Quote,    ///< QUOTE|car id
+    Lookup,   ///< LOOKUP|car id
+    Display   ///< DISPLAY
+};
+
+/**
+ * @struct GateCommand
+ * @brief One parsed gate record. Only the fields of its type are meaningful.
+ */
+struct GateCommand {
+    GateCommandType type = GateCommandType::Display;
+    AdmissionRequest admission;  ///< Park.
+    int carId = 0;               ///< Remove, Quote, Lookup.
+    std::string owner;           ///< Remove.
+};
+
+/**
+ * @brief Largest hourly rate a gate record may carry.
+ */
+constexpr double MAX_GATE_HOURLY_RATE = 100000.0;
+
+/**
+ * @brief Largest parking duration, in hours, a gate record may carry: one year.
+ */
+constexpr double MAX_GATE_PARKING_HOURS = 24.0 * 366.0;
+
+/**
+ * @brief Parses and validates one gate record in a single pass.
+ *
+ * A record is one line of '|'-separated fields, starting with the command name in capitals; a
+ * trailing "\r\n" or "\n" is ignored. Fields are copied straight into the command's strings and
+ * checked as they are reached: phone digits only, email containing '@', y/n flags, rate and hours
+ * written as plain decimals no larger than MAX_GATE_HOURLY_RATE and MAX_GATE_PARKING_HOURS,
+ * positive car IDs, and the exact field count. Fields cannot contain '|' or newlines.
+ *
+ * @param data The record.
+ * @param length Its length in bytes.
+ * @param command Receives the record; its strings keep their capacity between calls.
+ * @return Null on success, otherwise a short description of the first problem found.
+ */
+const char* parseGateCommand(const char* data, std::size_t length, GateCommand& command);
+
+/**
+ * @brief Parses and validates one gate record held in a string.
+ */
+inline const char* parseGateCommand(const std::string& record, GateCommand& command) {
+    return parseGateCommand(record.data(), record.size(), command);
+}
+
+/**
+ * @brief Appends a PARK record for an admission request, with a trailing newline.
+ *
+ * Any '|', '\r' or '\n' inside a field is replaced by a space so the record stays parseable. The
+ * rate and hours are written as plain decimals with up to six places, clamped to the accepted range.
+ */
+void appendParkRecord(const AdmissionRequest& request, std::string& out);
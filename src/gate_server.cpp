@@ -0,0 +1,273 @@
+#include "gate_server.h"
+#include "gate_client.h"
+#include "parking_lot.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+constexpr std::size_t GateServer::MAX_LINE;
+constexpr std::size_t GateServer::MAX_PENDING_REPLY;
+
+namespace {
+
+/**
+ * @brief Epoll events handled per wait.
+ */
+constexpr int MAX_EVENTS = 64;
+
+/**
+ * @brief Bytes read from a client per readiness event.
+ */
+constexpr std::size_t READ_CHUNK = 64 * 1024;
+
+/**
+ * @brief Removes a stale socket file left by an earlier server, but never a regular file.
+ */
+void removeStaleSocket(const std::string& path) {
+    struct stat info;
+    if (::lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) ::unlink(path.c_str());
+}
+
+}  // namespace
+
+GateServer::GateServer(ParkingLot& lot, const std::string& socketPath) : lot(lot), socketPath(socketPath) {}
+
+GateServer::~GateServer() {
+    for (const auto& client : clients) ::close(client.first);
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(socketPath.c_str());
+    }
+    if (epollFd >= 0) ::close(epollFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+}
+
+bool GateServer::listen() {
+    sockaddr_un address;
+    if (!gateSocketAddress(socketPath, address)) {
+        error = "socket path too long: " + socketPath;
+        return false;
+    }
+    removeStaleSocket(socketPath);
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0) {
+        error = std::string("cannot listen on ") + socketPath + ": " + std::strerror(errno);
+        if (listenFd >= 0) ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    const bool watchingListener = epollFd >= 0 && ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+    event.data.fd = wakeFd;
+    if (!watchingListener || wakeFd < 0 || ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) != 0) {
+        error = std::string("cannot set up the event loop: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Waits for readiness and dispatches it until the wake descriptor fires.
+ */
+void GateServer::run() {
+    epoll_event events[MAX_EVENTS];
+    while (true) {
+        const int ready = ::epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        for (int i = 0; i < ready; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                std::uint64_t count;
+                if (::read(wakeFd, &count, sizeof(count)) < 0) {}
+                return;
+            }
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            const auto found = clients.find(fd);
+            if (found == clients.end()) continue;
+            if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN)) {
+                closeClient(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) writeClient(fd, found->second);
+            if (events[i].events & EPOLLIN) {
+                const auto stillOpen = clients.find(fd);
+                if (stillOpen != clients.end() && stillOpen->second.reading) readClient(fd, stillOpen->second);
+            }
+        }
+    }
+}
+
+void GateServer::stop() {
+    const std::uint64_t one = 1;
+    if (wakeFd >= 0 && ::write(wakeFd, &one, sizeof(one)) < 0) {}
+}
+
+void GateServer::acceptClients() {
+    while (true) {
+        const int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN once the backlog is empty; other errors drop the attempt
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        clients[fd];
+    }
+}
+
+/**
+ * @brief Reads what the client has sent, answers every complete line, and starts sending the replies.
+ */
+void GateServer::readClient(const int fd, Client& client) {
+    const std::size_t kept = client.input.size();
+    client.input.resize(kept + READ_CHUNK);
+    const ssize_t received = ::read(fd, &client.input[kept], READ_CHUNK);
+    client.input.resize(kept + static_cast<std::size_t>(received > 0 ? received : 0));
+    if (received < 0) {
+        if (errno != EAGAIN && errno != EINTR) closeClient(fd);
+        return;
+    }
+    if (received == 0) {
+        // A last request without a newline is still answered
+        if (!client.input.empty()) answer(client.input.data(), client.input.size(), client.output);
+        client.input.clear();
+        client.finished = true;
+        writeClient(fd, client);
+        return;
+    }
+
+    std::size_t start = 0;
+    while (true) {
+        const void* newline = std::memchr(client.input.data() + start, '\n', client.input.size() - start);
+        if (!newline) break;
+        const std::size_t end = static_cast<std::size_t>(static_cast<const char*>(newline) - client.input.data());
+        answer(client.input.data() + start, end - start, client.output);
+        start = end + 1;
+    }
+    client.input.erase(0, start);
+    if (client.input.size() >= MAX_LINE) {
+        closeClient(fd);
+        return;
+    }
+    writeClient(fd, client);
+}
+
+/**
+ * @brief Sends as much pending output as the socket takes, then adjusts what the loop waits for.
+ */
+void GateServer::writeClient(const int fd, Client& client) {
+    std::size_t sent = 0;
+    while (sent < client.output.size()) {
+        const ssize_t written = ::send(fd, client.output.data() + sent, client.output.size() - sent, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            closeClient(fd);
+            return;
+        }
+        sent += static_cast<std::size_t>(written);
+    }
+    client.output.erase(0, sent);
+    if (client.finished && client.output.empty()) {
+        closeClient(fd);
+        return;
+    }
+    updateInterest(fd, client);
+}
+
+void GateServer::updateInterest(const int fd, Client& client) {
+    const bool reading = !client.finished && client.output.size() < MAX_PENDING_REPLY;
+    const bool writing = !client.output.empty();
+    if (reading == client.reading && writing == client.writing) return;
+    client.reading = reading;
+    client.writing = writing;
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = (reading ? EPOLLIN : 0u) | (writing ? EPOLLOUT : 0u);
+    event.data.fd = fd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void GateServer::closeClient(const int fd) {
+    ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    clients.erase(fd);
+}
+
+/**
+ * @brief Parses one request line, applies it to the lot and appends the reply line.
+ */
+void GateServer::answer(const char* line, const std::size_t length, std::string& reply) {
+    ++requests;
+    char text[96];
+    if (const char* problem = parseGateCommand(line, length, command)) {
+        reply += "ERR ";
+        reply += problem;
+        reply += '\n';
+        return;
+    }
+    switch (command.type) {
+    case GateCommandType::Park: {
+        const int id = lot.admit(command.admission);
+        if (id == 0) {
+            reply += "REFUSED no free slot\n";
+            return;
+        }
+        std::snprintf(text, sizeof(text), "OK %d\n", id);
+        reply += text;
+        return;
+    }
+    case GateCommandType::Remove:
+        reply += lot.removeCarByIdAndOwner(command.carId, command.owner) ? "OK\n" : "ERR no such car for that owner\n";
+        return;
+    case GateCommandType::Quote: {
+        const double fee = lot.quoteFee(command.carId);
+        if (fee < 0.0) {
+            reply += "ERR no such car\n";
+            return;
+        }
+        std::snprintf(text, sizeof(text), "OK %.2f\n", fee);
+        reply += text;
+        return;
+    }
+    case GateCommandType::Lookup: {
+        const Car car = lot.getCarByID(command.carId);
+        if (car.id != command.carId) {
+            reply += "ERR no such car\n";
+            return;
+        }
+        std::snprintf(text, sizeof(text), "OK %d|", car.id);
+        reply += text;
+        reply += car.ownerName + '|' + car.licensePlate + '|' + car.slot + '|' + car.slotSize;
+        std::snprintf(text, sizeof(text), "|%.2f\n", car.hourlyRate);
+        reply += text;
+        return;
+    }
+    case GateCommandType::Display:
+        reply += "ERR DISPLAY is not served over the socket\n";
+        return;
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include "gate_protocol.h"
+
+class ParkingLot;
+
+/**
+ * @class GateServer
+ * @brief Serves gate records from many clients over a Unix domain socket, against one lot.
+ *
+ * One thread runs an epoll loop over the listening socket and every client, all non-blocking.
+ * Each client sends gate records (see parseGateCommand) one per line and gets one reply line per
+ * record, in order:
+ *
+ *     PARK|...        -> OK <car id>            or  REFUSED no free slot
+ *     REMOVE|id|owner -> OK                     or  ERR no such car for that owner
+ *     QUOTE|id        -> OK <fee>               or  ERR no such car
+ *     LOOKUP|id       -> OK id|owner|plate|slot|size|rate  or  ERR no such car
+ *     DISPLAY         -> ERR DISPLAY is not served over the socket
+ *     malformed       -> ERR <reason>
+ *
+ * Clients may pipeline: every complete line already read is answered before the loop waits
+ * again, and the replies to one read go back in as few writes as the socket accepts. A client
+ * whose unread replies pass MAX_PENDING_REPLY bytes is not read from until it catches up, and
+ * one that sends a line longer than MAX_LINE bytes is disconnected. A client may shut down its
+ * sending side after its last request and still receive every reply.
+ */
+class GateServer {
+public:
+    /**
+     * @brief Longest request line accepted, including the newline.
+     */
+    static constexpr std::size_t MAX_LINE = 4096;
+
+    /**
+     * @brief Reply bytes a client may leave unread before the server stops reading its requests.
+     */
+    static constexpr std::size_t MAX_PENDING_REPLY = 1024 * 1024;
+
+    /**
+     * @brief Creates a server for a lot; nothing is opened until listen().
+     * @param lot The lot to serve; only the server's thread may use it while run() is active.
+     * @param socketPath Filesystem path of the socket; an existing socket file there is replaced.
+     */
+    GateServer(ParkingLot& lot, const std::string& socketPath);
+
+    /**
+     * @brief Closes every connection and removes the socket file.
+     */
+    ~GateServer();
+
+    GateServer(const GateServer&) = delete;
+    GateServer& operator=(const GateServer&) = delete;
+
+    /**
+     * @brief Binds and listens on the socket and sets up the event loop.
+     * @return False, with the reason in getError(), if the socket could not be set up.
+     */
+    bool listen();
+
+    /**
+     * @brief Serves clients until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return. Safe to call from any thread and from a signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Returns why listen() failed.
+     */
+    const std::string& getError() const { return error; }
+
+    /**
+     * @brief Returns the number of requests answered so far.
+     */
+    std::size_t getRequestCount() const { return requests; }
+
+private:
+    /**
+     * @brief A connected client and its unprocessed input and unsent output.
+     */
+    struct Client {
+        std::string input;
+        std::string output;
+        bool reading = true;   ///< False while the client has too many unread replies.
+        bool writing = false;  ///< True while EPOLLOUT is registered.
+        bool finished = false; ///< The client shut down its side; closed once its replies are sent.
+    };
+
+    void acceptClients();
+    void readClient(int fd, Client& client);
+    void writeClient(int fd, Client& client);
+    void closeClient(int fd);
+    void updateInterest(int fd, Client& client);
+    void answer(const char* line, std::size_t length, std::string& reply);
+
+    ParkingLot& lot;
+    std::string socketPath;
+    std::string error;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::unordered_map<int, Client> clients;
+    GateCommand command;
+    std::size_t requests = 0;
+};
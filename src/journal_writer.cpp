@@ -0,0 +1,272 @@
+#include "journal_writer.h"
+#include "trace.h"
+#include "segment_index.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Syncs a file's data, and only the metadata needed to read it back, to disk.
+ */
+int syncData(const int fd) {
+#if defined(__linux__)
+    return ::fdatasync(fd);
+#else
+    return ::fsync(fd);
+#endif
+}
+
+}  // namespace
+
+constexpr std::int64_t JournalWriter::NO_TIMESTAMP;
+
+JournalWriter::JournalWriter(const std::string& path, const std::string& header, const JournalOptions& options)
+    : path(path), header(header), options(options) {
+    buffer.reserve(options.flushBytes > 0 ? options.flushBytes + 1024 : 1024);
+}
+
+JournalWriter::~JournalWriter() {
+    close();
+}
+
+/**
+ * @brief Buffers a row and flushes if the buffer is full or its oldest row has waited too long.
+ *
+ * @param data Pointer to the bytes to append.
+ * @param length Number of bytes to append.
+ * @param timestamp Unix seconds the row describes, or NO_TIMESTAMP.
+ */
+void JournalWriter::append(const char* data, const std::size_t length, const std::int64_t timestamp) {
+    const auto now = std::chrono::steady_clock::now();
+    if (buffer.empty()) oldestBuffered = now;
+    if (timestamp != NO_TIMESTAMP) {
+        firstRecord = std::min(firstRecord, timestamp);
+        lastRecord = std::max(lastRecord, timestamp);
+    }
+    buffer.append(data, length);
+    ++bufferedRecords;
+    count(recordCount);
+    if (flushDue(now)) flush();
+}
+
+void JournalWriter::flushIfDue() {
+    if (!buffer.empty() && flushDue(std::chrono::steady_clock::now())) flush();
+}
+
+bool JournalWriter::flushDue(const std::chrono::steady_clock::time_point now) const {
+    switch (options.durability) {
+    case Durability::FsyncPerEvent:
+        return true;
+    case Durability::GroupCommit:
+        if (bufferedRecords >= options.groupCommitRecords || now - oldestBuffered >= options.groupCommitInterval)
+            return true;
+        break;
+    case Durability::None:
+        break;
+    }
+    return buffer.size() >= options.flushBytes || now - oldestBuffered >= options.flushInterval;
+}
+
+std::chrono::steady_clock::time_point JournalWriter::flushDeadline() const {
+    if (buffer.empty()) return std::chrono::steady_clock::time_point::max();
+    switch (options.durability) {
+    case Durability::FsyncPerEvent:
+        return oldestBuffered;
+    case Durability::GroupCommit:
+        return oldestBuffered + std::min<std::chrono::milliseconds>(options.groupCommitInterval, options.flushInterval);
+    case Durability::None:
+        break;
+    }
+    return oldestBuffered + options.flushInterval;
+}
+
+/**
+ * @brief Hands all buffered rows to the operating system in a single write, then syncs them if durability asks for it.
+ *
+ * If the file cannot be opened or written the rows stay buffered, so a later flush can retry. When
+ * a write fails part way, the bytes that did reach the file are dropped from the buffer first, so
+ * the retry continues where the file ends instead of writing them twice.
+ * A failed sync is reported but not retried, since the rows are already written.
+ *
+ * @return True if the buffer is empty afterwards and, when required, synced.
+ */
+bool JournalWriter::flush() {
+    if (buffer.empty()) return true;
+    TRACE_SPAN("journal.flush");
+    if (fd < 0 && !openFile()) return false;
+    const std::size_t written = writeAll(buffer.data(), buffer.size());
+    fileBytes += written;
+    if (written < buffer.size()) {
+        buffer.erase(0, written);
+        return false;
+    }
+    buffer.clear();
+    bufferedRecords = 0;
+    bool synced = true;
+    if (options.durability != Durability::None) {
+        TRACE_SPAN("journal.sync");
+        synced = syncData(fd) == 0;
+        ++syncs;
+        count(syscalls);
+    }
+    if (segmentDue()) rotate();
+    return synced;
+}
+
+void JournalWriter::close() {
+    flush();
+    if (fd >= 0) {
+        ::close(fd);
+        count(syscalls);
+        fd = -1;
+    }
+}
+
+IoStats JournalWriter::getIoStats() const {
+    IoStats stats;
+    stats.records = recordCount.load(std::memory_order_relaxed);
+    stats.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+    stats.filesOpened = filesOpened.load(std::memory_order_relaxed);
+    stats.syscalls = syscalls.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief Opens the active file, writing the header if it is empty and working out when its segment began.
+ *
+ * A segment's start is the end of the previous indexed segment; a non-empty file with no index
+ * predates rotation, so its start is recorded as 0 (unknown).
+ */
+bool JournalWriter::openFile() {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    count(syscalls);
+    if (fd < 0) return false;
+    count(filesOpened);
+    struct stat info;
+    fileBytes = ::fstat(fd, &info) == 0 ? static_cast<std::size_t>(info.st_size) : 0;
+    count(syscalls);
+    if (recordSize > 0 && fileBytes > 0) {
+        // Cut a torn trailing record (or header) back to the last whole one
+        const std::size_t whole = fileBytes < header.size()
+            ? 0 : header.size() + (fileBytes - header.size()) / recordSize * recordSize;
+        if (whole != fileBytes) {
+            const bool cut = ::ftruncate(fd, static_cast<off_t>(whole)) == 0;
+            count(syscalls);
+            if (!cut) {
+                // Appending after the fragment would misalign every later record
+                ::close(fd);
+                count(syscalls);
+                fd = -1;
+                return false;
+            }
+            fileBytes = whole;
+        }
+    }
+    if (segmentStart < 0 && (options.segmentBytes > 0 || options.segmentAge.count() > 0)) {
+        IoStats indexIo;
+        const std::vector<SegmentInfo> closed = segment_index::readClosed(path, &indexIo);
+        countIndexIo(indexIo);
+        segmentStart = !closed.empty() ? closed.back().endTime
+                     : fileBytes > 0    ? 0
+                                        : static_cast<std::int64_t>(std::time(nullptr));
+        // Rows left by an earlier run were stamped no earlier than the last closed segment's
+        if (!closed.empty() && fileBytes > header.size())
+            firstRecord = std::min(firstRecord, closed.back().lastRecord);
+    }
+    if (!header.empty() && fileBytes == 0) fileBytes = writeAll(header.data(), header.size());
+    return true;
+}
+
+bool JournalWriter::segmentDue() const {
+    if (options.segmentBytes > 0 && fileBytes >= options.segmentBytes) return true;
+    return options.segmentAge.count() > 0 && segmentStart >= 0 &&
+           std::time(nullptr) - segmentStart >= static_cast<std::int64_t>(options.segmentAge.count());
+}
+
+/**
+ * @brief Retires the active file as the next numbered segment.
+ *
+ * The rename happens before the index line is written, so after a crash between the two the
+ * segment exists but is unindexed and is simply not found by range queries, rather than the index
+ * naming a file that does not exist. The indexed record range is the segment's own time range,
+ * widened to the timestamps of the rows appended to it.
+ */
+void JournalWriter::rotate() {
+    ::close(fd);
+    count(syscalls);
+    fd = -1;
+    IoStats indexIo;
+    const std::vector<SegmentInfo> closed = segment_index::readClosed(path, &indexIo);
+    SegmentInfo segment;
+    segment.sequence = closed.empty() ? 1 : closed.back().sequence + 1;
+    segment.startTime = segmentStart < 0 ? 0 : segmentStart;
+    segment.endTime = static_cast<std::int64_t>(std::time(nullptr));
+    segment.bytes = fileBytes;
+    segment.firstRecord = std::min(segment.startTime, firstRecord);
+    segment.lastRecord = std::max(segment.endTime, lastRecord);
+    segment.file = segment_index::segmentPath(path, segment.sequence);
+    const bool renamed = std::rename(path.c_str(), segment.file.c_str()) == 0;
+    count(syscalls);
+    if (renamed) segment_index::appendClosed(path, segment, &indexIo);
+    countIndexIo(indexIo);
+    if (!renamed) return;
+    segmentStart = segment.endTime;
+    firstRecord = std::numeric_limits<std::int64_t>::max();
+    lastRecord = NO_TIMESTAMP;
+    fileBytes = 0;
+}
+
+std::size_t JournalWriter::writeAll(const char* data, const std::size_t length) {
+    std::size_t done = 0;
+    while (done < length) {
+        const ssize_t written = ::write(fd, data + done, length - done);
+        count(syscalls);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        count(bytesWritten, static_cast<std::uint64_t>(written));
+        done += static_cast<std::size_t>(written);
+    }
+    return done;
+}
+
+std::string formatIoReport(const char* const* names, const IoStats* stats, const std::size_t count) {
+    std::string report;
+    char line[192];
+    std::snprintf(line, sizeof(line), "%-22s %10s %12s %8s %10s %10s %10s\n",
+                  "journal", "records", "bytes", "opens", "syscalls", "bytes/rec", "calls/rec");
+    report += line;
+    for (std::size_t i = 0; i < count; ++i) {
+        const IoStats& s = stats[i];
+        const double records = s.records > 0 ? static_cast<double>(s.records) : 1.0;
+        std::snprintf(line, sizeof(line), "%-22s %10llu %12llu %8llu %10llu %10.1f %10.3f\n", names[i],
+                      static_cast<unsigned long long>(s.records), static_cast<unsigned long long>(s.bytesWritten),
+                      static_cast<unsigned long long>(s.filesOpened), static_cast<unsigned long long>(s.syscalls),
+                      static_cast<double>(s.bytesWritten) / records, static_cast<double>(s.syscalls) / records);
+        report += line;
+    }
+    return report;
+}
+
+JournalStreamBuf::int_type JournalStreamBuf::overflow(const int_type ch) {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+    const char c = traits_type::to_char_type(ch);
+    journal.append(&c, 1);
+    return ch;
+}
+
+std::streamsize JournalStreamBuf::xsputn(const char* data, const std::streamsize count) {
+    journal.append(data, static_cast<std::size_t>(count));
+    return count;
+}
+
+int JournalStreamBuf::sync() {
+    return journal.flush() ? 0 : -1;
+}
@@ -0,0 +1,285 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <streambuf>
+#include <string>
+
+/**
+ * @brief How far a JournalWriter goes to make written rows survive a power failure.
+ */
+enum class Durability {
+    None,           ///< Rows are handed to the operating system on flush and never synced.
+    GroupCommit,    ///< Buffered rows are written and synced together once enough accumulate or the oldest waits too long.
+    FsyncPerEvent   ///< Every row is written and synced before append() returns.
+};
+
+/**
+ * @struct IoStats
+ * @brief What a JournalWriter has asked of the operating system, counted since it was created.
+ *
+ * Syscalls are the open, fstat, write, data sync, close and rename calls the writer makes on its own
+ * file, plus the calls that read and append its segment index when it opens a file or rotates.
+ */
+struct IoStats {
+    std::uint64_t records = 0;       ///< Rows appended.
+    std::uint64_t bytesWritten = 0;  ///< Bytes handed to write(), including headers.
+    std::uint64_t filesOpened = 0;   ///< Successful open() calls.
+    std::uint64_t syscalls = 0;      ///< All calls counted above, successful or not.
+
+    IoStats& operator+=(const IoStats& other) {
+        records += other.records;
+        bytesWritten += other.bytesWritten;
+        filesOpened += other.filesOpened;
+        syscalls += other.syscalls;
+        return *this;
+    }
+};
+
+/**
+ * @brief Formats one row of I/O counts per name, with bytes and syscalls per record, as a table for the console.
+ */
+std::string formatIoReport(const char* const* names, const IoStats* stats, std::size_t count);
+
+/**
+ * @struct JournalOptions
+ * @brief Thresholds that decide when a JournalWriter hands its buffered rows to the operating system.
+ */
+struct JournalOptions {
+    /**
+     * @brief Flush once this many bytes are buffered. 0 writes every row through immediately.
+     */
+    std::size_t flushBytes = 64 * 1024;
+
+    /**
+     * @brief Flush once the oldest buffered row has waited this long.
+     */
+    std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000);
+
+    /**
+     * @brief Close the active file as a segment once it reaches this size. 0 disables size-based rotation.
+     */
+    std::size_t segmentBytes = 0;
+
+    /**
+     * @brief Close the active file as a segment once it has been active this long. 0 disables time-based rotation.
+     */
+    std::chrono::seconds segmentAge = std::chrono::seconds(0);
+
+    /**
+     * @brief Whether and how often flushed rows are synced to disk.
+     */
+    Durability durability = Durability::None;
+
+    /**
+     * @brief With group commit, flush and sync once this many rows are buffered.
+     */
+    std::size_t groupCommitRecords = 64;
+
+    /**
+     * @brief With group commit, flush and sync once the oldest buffered row has waited this long.
+     */
+    std::chrono::milliseconds groupCommitInterval = std::chrono::milliseconds(10);
+};
+
+/**
+ * @class JournalWriter
+ * @brief A long-lived, buffered, append-only writer for one persistence file.
+ *
+ * The writer keeps its file descriptor open for its whole lifetime and collects rows in memory,
+ * issuing a single write() per flush instead of a stat/open/write/close sequence per row. The file
+ * is opened lazily on the first flush; if it is empty at that point the optional header line is
+ * written first. Buffered rows are flushed when the size or age threshold is reached, on flush(),
+ * and on destruction.
+ *
+ * The durability option adds a data sync to each flush. Per-event durability flushes and syncs
+ * every row; group commit also flushes once groupCommitRecords rows are buffered or the oldest
+ * has waited groupCommitInterval, so a burst of rows shares one write and one sync, and a crash
+ * loses at most that many rows or that much time.
+ *
+ * With a segment size or age set, the file at path is the active segment of a rotated journal:
+ * after a flush that takes it past either limit it is renamed to a numbered segment, recorded with
+ * its time range in the journal's segment index (see segment_index), and a fresh active file with
+ * its own header is started on the next flush. Rotation happens only between flushes, so rows are
+ * never split across segments. Rows appended with a timestamp widen the indexed range to cover
+ * them, so a row stamped just before a rotation but written just after it is still found.
+ */
+class JournalWriter {
+public:
+    /**
+     * @brief Timestamp of a row that carries none; it leaves the segment's indexed time range alone.
+     */
+    static constexpr std::int64_t NO_TIMESTAMP = std::numeric_limits<std::int64_t>::min();
+
+    /**
+     * @brief Creates a writer for the given file. No file is touched until the first flush.
+     * @param path Path of the file to append to.
+     * @param header Text written once when the file is created or empty, e.g. a CSV header line.
+     * @param options Flush thresholds.
+     */
+    explicit JournalWriter(const std::string& path, const std::string& header = std::string(),
+                           const JournalOptions& options = JournalOptions());
+
+    /**
+     * @brief Flushes any buffered rows and closes the file.
+     */
+    ~JournalWriter();
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    /**
+     * @brief Buffers a row, flushing if a threshold has been reached.
+     * @param data Pointer to the bytes to append.
+     * @param length Number of bytes to append.
+     * @param timestamp Unix seconds the row describes, recorded in the segment index, or NO_TIMESTAMP.
+     */
+    void append(const char* data, std::size_t length, std::int64_t timestamp = NO_TIMESTAMP);
+
+    /**
+     * @brief Buffers a row, flushing if a threshold has been reached.
+     * @param text The text to append.
+     */
+    void append(const std::string& text) { append(text.data(), text.size()); }
+
+    /**
+     * @brief Flushes buffered rows if the age threshold has passed. Cheap to call often.
+     */
+    void flushIfDue();
+
+    /**
+     * @brief Returns when flushIfDue() will next flush, or time_point::max() if nothing is buffered.
+     */
+    std::chrono::steady_clock::time_point flushDeadline() const;
+
+    /**
+     * @brief Writes all buffered rows to the file.
+     * @return False if the file could not be opened or written.
+     */
+    bool flush();
+
+    /**
+     * @brief Flushes and closes the file. A later append reopens it.
+     */
+    void close();
+
+    /**
+     * @brief Replaces the flush thresholds.
+     * @param newOptions The new thresholds.
+     */
+    void setOptions(const JournalOptions& newOptions) { options = newOptions; }
+
+    /**
+     * @brief Declares that the file holds fixed-size records after its header.
+     *
+     * When the file is opened, a torn record left at its end by a crash is cut off, so new records
+     * start on a record boundary instead of after the fragment.
+     *
+     * @param bytes Size of one record; 0 (the default) for variable-length rows.
+     */
+    void setRecordSize(std::size_t bytes) { recordSize = bytes; }
+
+    /**
+     * @brief Returns the path this writer appends to.
+     */
+    const std::string& getPath() const { return path; }
+
+    /**
+     * @brief Returns the number of bytes waiting in the buffer.
+     */
+    std::size_t getBufferedBytes() const { return buffer.size(); }
+
+    /**
+     * @brief Returns the number of data syncs issued so far.
+     */
+    std::size_t getSyncCount() const { return syncs; }
+
+    /**
+     * @brief Returns the I/O counts so far. Safe to call from any thread while another writes.
+     */
+    IoStats getIoStats() const;
+
+private:
+    /**
+     * @brief Adds to an I/O counter. Only the thread writing the journal calls this.
+     */
+    static void count(std::atomic<std::uint64_t>& counter, std::uint64_t amount = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Adds the calls and bytes of segment index I/O to the counters.
+     */
+    void countIndexIo(const IoStats& io) {
+        count(bytesWritten, io.bytesWritten);
+        count(filesOpened, io.filesOpened);
+        count(syscalls, io.syscalls);
+    }
+
+    /**
+     * @brief Returns true if the buffered rows should be flushed at the given time.
+     */
+    bool flushDue(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief Opens the file for appending and writes the header if the file is empty.
+     * @return True if the file is open.
+     */
+    bool openFile();
+
+    /**
+     * @brief Writes the bytes to the file, retrying on short writes.
+     * @return The number of bytes written: all of them unless a write failed part way.
+     */
+    std::size_t writeAll(const char* data, std::size_t length);
+
+    /**
+     * @brief Returns true if the active file has reached the segment size or age.
+     */
+    bool segmentDue() const;
+
+    /**
+     * @brief Closes the active file, renames it to the next numbered segment and indexes it.
+     */
+    void rotate();
+
+    std::string path;
+    std::string header;
+    JournalOptions options;
+    std::string buffer;
+    std::chrono::steady_clock::time_point oldestBuffered;
+    std::size_t bufferedRecords = 0;
+    std::size_t syncs = 0;
+    int fd = -1;
+    std::size_t fileBytes = 0;
+    std::size_t recordSize = 0;
+    std::int64_t segmentStart = -1;
+    std::int64_t firstRecord = std::numeric_limits<std::int64_t>::max();
+    std::int64_t lastRecord = NO_TIMESTAMP;
+    std::atomic<std::uint64_t> recordCount{0};
+    std::atomic<std::uint64_t> bytesWritten{0};
+    std::atomic<std::uint64_t> filesOpened{0};
+    std::atomic<std::uint64_t> syscalls{0};
+};
+
+/**
+ * @class JournalStreamBuf
+ * @brief Adapts a JournalWriter to std::ostream, so stream-based logs get the writer's buffering and rotation.
+ */
+class JournalStreamBuf : public std::streambuf {
+public:
+    /**
+     * @brief Wraps a journal; the journal must outlive the stream buffer.
+     */
+    explicit JournalStreamBuf(JournalWriter& journal) : journal(journal) {}
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+    int sync() override;
+
+private:
+    JournalWriter& journal;
+};
@@ -0,0 +1,94 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+constexpr std::uint64_t LatencyHistogram::MAX_VALUE;
+
+namespace {
+
+/**
+ * @brief Values below 2^LINEAR_BITS get one bucket each; each power of two above is split into
+ *        2^(LINEAR_BITS - 1) buckets.
+ */
+constexpr unsigned LINEAR_BITS = 6;
+constexpr std::size_t HALF = std::size_t(1) << (LINEAR_BITS - 1);
+
+unsigned highestBit(std::uint64_t value) {
+#ifdef __GNUC__
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned bit = 0;
+    while (value >>= 1) ++bit;
+    return bit;
+#endif
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : counts(indexOf(MAX_VALUE) + 1, 0) {}
+
+/**
+ * @brief Maps a value to its bucket: itself below 64, otherwise an exponent step of 32 buckets
+ *        plus the value's top six bits.
+ */
+std::size_t LatencyHistogram::indexOf(const std::uint64_t value) {
+    if (value < 2 * HALF) return static_cast<std::size_t>(value);
+    const unsigned shift = highestBit(value) - (LINEAR_BITS - 1);
+    return shift * HALF + static_cast<std::size_t>(value >> shift);
+}
+
+std::uint64_t LatencyHistogram::upperBound(const std::size_t index) {
+    if (index < 2 * HALF) return index;
+    const unsigned shift = static_cast<unsigned>(index / HALF - 1);
+    const std::uint64_t mantissa = index % HALF + HALF;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(const std::uint64_t nanos) {
+    const std::uint64_t value = std::min(nanos, MAX_VALUE);
+    ++counts[indexOf(value)];
+    ++total;
+    sum += nanos;
+    maxValue = std::max(maxValue, nanos);
+}
+
+std::uint64_t LatencyHistogram::percentile(const double quantile) const {
+    if (total == 0) return 0;
+    const double q = std::min(1.0, std::max(0.0, quantile));
+    const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(upperBound(i), maxValue);
+    }
+    return maxValue;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (std::size_t i = 0; i < counts.size(); ++i) counts[i] += other.counts[i];
+    total += other.total;
+    sum += other.sum;
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = sum = maxValue = 0;
+}
+
+std::string formatLatencyReport(const char* const* names, const LatencyHistogram* histograms, const std::size_t count) {
+    std::string report;
+    char line[192];
+    std::snprintf(line, sizeof(line), "%-10s %10s %10s %10s %10s %10s %10s\n",
+                  "operation", "count", "p50_us", "p99_us", "p99.9_us", "max_us", "mean_us");
+    report += line;
+    for (std::size_t i = 0; i < count; ++i) {
+        const LatencyHistogram& h = histograms[i];
+        std::snprintf(line, sizeof(line), "%-10s %10llu %10.3f %10.3f %10.3f %10.3f %10.3f\n", names[i],
+                      static_cast<unsigned long long>(h.count()), h.percentile(0.50) / 1000.0,
+                      h.percentile(0.99) / 1000.0, h.percentile(0.999) / 1000.0, h.max() / 1000.0, h.mean() / 1000.0);
+        report += line;
+    }
+    return report;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class LatencyHistogram
+ * @brief Records durations in nanoseconds into log-linear buckets, HDR histogram style.
+ *
+ * Values below 64 ns get a bucket each; above that, every power of two is split into 32 equal
+ * buckets, so any recorded value is reported within about 3% while the whole range up to
+ * MAX_VALUE (about 18 minutes) fits in under 1200 counters. Recording is an index computation
+ * and an increment; percentiles walk the counters. Not thread-safe, like the lot it measures.
+ */
+class LatencyHistogram {
+public:
+    /**
+     * @brief Largest value tracked exactly by bucket; larger values are counted in the last bucket.
+     */
+    static constexpr std::uint64_t MAX_VALUE = (1ULL << 40) - 1;
+
+    LatencyHistogram();
+
+    /**
+     * @brief Records one duration.
+     * @param nanos The duration in nanoseconds.
+     */
+    void record(std::uint64_t nanos);
+
+    /**
+     * @brief Returns the number of durations recorded.
+     */
+    std::uint64_t count() const { return total; }
+
+    /**
+     * @brief Returns the largest duration recorded, in nanoseconds; 0 if none.
+     */
+    std::uint64_t max() const { return maxValue; }
+
+    /**
+     * @brief Returns the mean duration in nanoseconds; 0 if none.
+     */
+    double mean() const { return total ? static_cast<double>(sum) / static_cast<double>(total) : 0.0; }
+
+    /**
+     * @brief Returns the duration at or below which the given fraction of recordings fall.
+     *
+     * The answer is the upper bound of the bucket holding that recording, capped at max().
+     *
+     * @param quantile Fraction in [0,1], e.g. 0.99 for p99.
+     * @return The duration in nanoseconds; 0 if nothing was recorded.
+     */
+    std::uint64_t percentile(double quantile) const;
+
+    /**
+     * @brief Adds every recording of another histogram to this one.
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Discards every recording.
+     */
+    void reset();
+
+private:
+    static std::size_t indexOf(std::uint64_t value);
+    static std::uint64_t upperBound(std::size_t index);
+
+    std::vector<std::uint64_t> counts;
+    std::uint64_t total = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t maxValue = 0;
+};
+
+/**
+ * @class ScopedLatency
+ * @brief Records the time from construction to destruction into a histogram, if one is given.
+ *
+ * With a null histogram nothing is timed, so an instrumented function costs one branch while
+ * timing is switched off.
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram* histogram) : histogram(histogram) {
+        if (histogram) start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedLatency() {
+        if (histogram)
+            histogram->record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram* histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Formats a latency table, one line per histogram, with count, p50, p99, p99.9, max and mean
+ *        in microseconds.
+ * @param names Row labels, parallel to histograms.
+ * @param histograms The histograms to report.
+ * @param count Number of rows.
+ */
+std::string formatLatencyReport(const char* const* names, const LatencyHistogram* histograms, std::size_t count);
@@ -0,0 +1,198 @@
+#include "logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <new>
+
+constexpr std::size_t Logger::MAX_ARGS;
+constexpr std::size_t Logger::TEXT_BYTES;
+constexpr std::size_t Logger::TEXT_ARG_BYTES;
+constexpr std::size_t Logger::CACHE_LINE;
+
+namespace {
+
+/**
+ * @brief Longest the drain thread sleeps with an empty ring before checking the journal's age threshold.
+ */
+constexpr std::chrono::milliseconds IDLE_WAIT(50);
+
+const char* levelName(const LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO ";
+        case LogLevel::Warn: return "WARN ";
+        case LogLevel::Error: return "ERROR";
+    }
+    return "?    ";
+}
+
+std::size_t roundUpPowerOfTwo(const std::size_t n) {
+    std::size_t size = 2;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+}  // namespace
+
+Logger::Logger(JournalWriter& journal, const std::size_t capacity)
+    : journal(journal), mask(roundUpPowerOfTwo(capacity) - 1) {
+    const std::size_t bytes = (mask + 1) * sizeof(Slot);
+    std::size_t space = bytes + CACHE_LINE;
+    slotStorage.reset(new unsigned char[space]);
+    void* start = slotStorage.get();
+    slots = static_cast<Slot*>(std::align(CACHE_LINE, bytes, start, space));
+    for (std::size_t i = 0; i <= mask; ++i) new (&slots[i]) Slot{{i}, Record()};
+    worker = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+/**
+ * @brief Claims the next free slot, or counts a drop if the drain thread has not yet freed it.
+ *
+ * A slot is free for position pos when its sequence equals pos; the producer that wins the
+ * compare-and-swap on enqueuePos owns it until publish().
+ */
+Logger::Slot* Logger::claim() {
+    std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots[pos & mask];
+        const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &slot;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Hands a filled slot to the drain thread.
+ *
+ * The drain thread is not woken for every message: it wakes by itself at least every IDLE_WAIT,
+ * and a producer wakes it early only when its message fills a half of the ring, so a burst
+ * is drained before the ring fills without a system call on the hot path.
+ */
+void Logger::publish(Slot* slot) {
+    const std::size_t pos = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    if (((pos + 1) & (mask >> 1)) == 0 && sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake.notify_one();
+    }
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    const std::size_t request = ++flushRequests;
+    wake.notify_one();
+    flushed.wait(lock, [this, request] { return flushesDone >= request; });
+}
+
+LoggerStats Logger::getStats() const {
+    LoggerStats stats;
+    stats.dropped = dropped.load(std::memory_order_relaxed);
+    stats.logged = enqueuePos.load(std::memory_order_relaxed);
+    stats.written = written.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief Formats and appends published messages in order; when the ring is empty, serves flush
+ *        requests, flushes the journal when its age threshold passes, and otherwise sleeps until a
+ *        producer or flush() wakes it or the journal's flush deadline arrives, at most IDLE_WAIT.
+ *        On shutdown the remaining messages are written before the thread exits.
+ */
+void Logger::run() {
+    for (;;) {
+        Slot& slot = slots[dequeuePos & mask];
+        if (slot.sequence.load(std::memory_order_acquire) == dequeuePos + 1) {
+            format(slot.record);
+            slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            ++dequeuePos;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (flushesDone != flushRequests) {
+            const std::size_t target = flushRequests;
+            lock.unlock();
+            journal.flush();
+            lock.lock();
+            flushesDone = target;
+            flushed.notify_all();
+            continue;
+        }
+        if (stopping) {
+            lock.unlock();
+            journal.flush();
+            return;
+        }
+        sleeping.store(true, std::memory_order_relaxed);
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+            wake.wait_until(lock, std::min(journal.flushDeadline(), std::chrono::steady_clock::now() + IDLE_WAIT));
+        sleeping.store(false, std::memory_order_relaxed);
+        lock.unlock();
+        journal.flushIfDue();
+    }
+}
+
+/**
+ * @brief Renders one message as "YYYY-MM-DD HH:MM:SS.mmm LEVEL text" and appends it to the journal.
+ *
+ * The date and time of day are formatted once per second and reused for every message in it.
+ */
+void Logger::format(const Record& record) {
+    const auto sinceEpoch = record.time.time_since_epoch();
+    const std::time_t second = static_cast<std::time_t>(std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch).count());
+    if (second != stampSecond) {
+        std::tm local;
+        localtime_r(&second, &local);
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+        stampSecond = second;
+    }
+    const long long millis = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count() % 1000;
+
+    char number[32];
+    line.assign(stamp);
+    line.append(number, static_cast<std::size_t>(std::snprintf(number, sizeof(number), ".%03lld ", millis)));
+    line.append(levelName(record.level));
+    line += ' ';
+
+    std::size_t next = 0;
+    for (const char* p = record.format; *p; ++p) {
+        if (p[0] != '{' || p[1] != '}' || next == record.argCount) {
+            line += *p;
+            continue;
+        }
+        const Arg& arg = record.args[next];
+        switch (record.types[next++]) {
+            case Int:
+                line.append(number, static_cast<std::size_t>(std::snprintf(number, sizeof(number), "%lld", arg.i)));
+                break;
+            case Uint:
+                line.append(number, static_cast<std::size_t>(std::snprintf(number, sizeof(number), "%llu", arg.u)));
+                break;
+            case Double:
+                line.append(number, static_cast<std::size_t>(std::snprintf(number, sizeof(number), "%g", arg.d)));
+                break;
+            case Text:
+                line.append(record.text + arg.text.offset, arg.text.length);
+                break;
+        }
+        ++p;
+    }
+    line += '\n';
+    journal.append(line);
+    written.store(written.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
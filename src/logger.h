@@ -0,0 +1,277 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <time.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "journal_writer.h"
+
+/**
+ * @enum LogLevel
+ * @brief Severity of a log message; messages below the logger's level are discarded at the call site.
+ */
+enum class LogLevel : std::uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error
+};
+
+/**
+ * @struct LoggerStats
+ * @brief Counters describing the traffic through a Logger.
+ */
+struct LoggerStats {
+    std::size_t logged = 0;   ///< Messages accepted into the ring.
+    std::size_t dropped = 0;  ///< Messages discarded because the ring was full.
+    std::size_t written = 0;  ///< Messages formatted and appended to the journal.
+};
+
+/**
+ * @class Logger
+ * @brief Leveled logger whose callers only copy arguments into a lock-free ring; formatting and
+ *        disk writes happen on a background drain thread.
+ *
+ * A call to log() claims a slot with one compare-and-swap, stores the timestamp, the format
+ * pointer and up to MAX_ARGS raw arguments, and publishes the slot; it never takes a lock, never
+ * allocates and never waits. Each slot is two cache lines, aligned, so a message touches no more. If the ring is full the message is dropped and counted. The drain
+ * thread takes slots in order, expands the "{}" placeholders of the format, prefixes the time and
+ * level, and appends the line to a JournalWriter, so the log gets the writer's buffering and
+ * rotation. It sleeps while the ring is empty, waking every IDLE_WAIT, when a message fills a half
+ * of the ring, or on flush(), so a message reaches the journal within IDLE_WAIT; while idle it
+ * flushes the journal when its age threshold passes.
+ *
+ * The format string is read only when the message is drained, so it must be a string literal or
+ * otherwise outlive the logger. String arguments are copied, each truncated to TEXT_ARG_BYTES and
+ * all of them to TEXT_BYTES in total.
+ */
+class Logger {
+public:
+    /**
+     * @brief Maximum number of arguments per message.
+     */
+    static constexpr std::size_t MAX_ARGS = 6;
+
+    /**
+     * @brief Bytes of string argument text stored per message: what is left of a two-cache-line slot.
+     */
+    static constexpr std::size_t TEXT_BYTES = 47;
+
+    /**
+     * @brief Bytes kept of any one string argument, so a long value cannot crowd out the others.
+     */
+    static constexpr std::size_t TEXT_ARG_BYTES = 24;
+
+    /**
+     * @brief Starts the drain thread.
+     * @param journal The journal receiving formatted lines; must outlive the logger.
+     * @param capacity Number of messages the ring holds; rounded up to a power of two.
+     */
+    explicit Logger(JournalWriter& journal, std::size_t capacity = 4096);
+
+    /**
+     * @brief Writes out every queued message, flushes the journal and stops the drain thread.
+     */
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief Sets the lowest level that is recorded.
+     */
+    void setLevel(LogLevel level) { minLevel.store(static_cast<std::uint8_t>(level), std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns true if messages of the given level are recorded.
+     */
+    bool enabled(LogLevel level) const {
+        return static_cast<std::uint8_t>(level) >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Queues a message; each "{}" in the format is replaced by the next argument when drained.
+     *
+     * Arguments may be integers, doubles, C strings and std::strings.
+     *
+     * @param level Severity of the message.
+     * @param format Format string; must outlive the logger (a string literal).
+     * @param args The values substituted for the placeholders.
+     * @return False if the message was filtered out by level or dropped because the ring was full.
+     */
+    template<typename... Args>
+    bool log(LogLevel level, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+        if (!enabled(level)) return false;
+        Slot* slot = claim();
+        if (!slot) return false;
+        Record& record = slot->record;
+        record.time = timestamp();
+        record.format = format;
+        record.level = level;
+        record.argCount = 0;
+        record.textUsed = 0;
+        pack(record, args...);
+        publish(slot);
+        return true;
+    }
+
+    /**
+     * @brief Blocks until every message queued so far has been written, then flushes the journal.
+     */
+    void flush();
+
+    /**
+     * @brief Gets the logger's traffic counters.
+     */
+    LoggerStats getStats() const;
+
+    /**
+     * @brief Gets the journal the drain thread writes to, e.g. to read its I/O counts.
+     */
+    const JournalWriter& getJournal() const { return journal; }
+
+private:
+    /**
+     * @brief Size of a cache line; slots are aligned to it.
+     */
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    /**
+     * @brief How a captured argument is stored.
+     */
+    enum ArgType : std::uint8_t { Int, Uint, Double, Text };
+
+    /**
+     * @brief One captured argument: an integer, a double, or a span of the record's text buffer.
+     */
+    union Arg {
+        long long i;
+        unsigned long long u;
+        double d;
+        struct { std::uint8_t offset, length; } text;
+    };
+
+    /**
+     * @brief A message as captured by log(), before formatting. The argument types are kept apart
+     *        from their values so no padding is spent on them.
+     */
+    struct Record {
+        std::chrono::system_clock::time_point time;
+        const char* format;
+        Arg args[MAX_ARGS];
+        LogLevel level;
+        std::uint8_t argCount;
+        std::uint8_t textUsed;
+        ArgType types[MAX_ARGS];
+        char text[TEXT_BYTES];
+    };
+
+    /**
+     * @brief A ring slot. Its sequence number says whose turn it is: equal to the slot's position
+     *        when free for that producer, position + 1 once published for the drain thread.
+     */
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        Record record;
+    };
+    static_assert(TEXT_BYTES <= 255, "text offsets are one byte");
+    static_assert(sizeof(Slot) == 2 * CACHE_LINE, "a slot should fill exactly two cache lines");
+
+    /**
+     * @brief Reads the wall clock for a message. On Linux this is the coarse clock: a few
+     *        nanoseconds instead of a few dozen, at the kernel tick's resolution of a few
+     *        milliseconds, which is plenty for an operational log.
+     */
+    static std::chrono::system_clock::time_point timestamp() {
+#ifdef CLOCK_REALTIME_COARSE
+        timespec now;
+        clock_gettime(CLOCK_REALTIME_COARSE, &now);
+        return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec)));
+#else
+        return std::chrono::system_clock::now();
+#endif
+    }
+
+    Slot* claim();
+    void publish(Slot* slot);
+    void run();
+    void format(const Record& record);
+
+    static void pack(Record&) {}
+    template<typename T, typename... Rest>
+    static void pack(Record& record, const T& value, const Rest&... rest) {
+        add(record, value);
+        pack(record, rest...);
+    }
+
+    static void addInt(Record& record, long long value) {
+        record.types[record.argCount] = Int;
+        record.args[record.argCount++].i = value;
+    }
+    static void addUint(Record& record, unsigned long long value) {
+        record.types[record.argCount] = Uint;
+        record.args[record.argCount++].u = value;
+    }
+    static void addText(Record& record, const char* data, std::size_t length) {
+        record.types[record.argCount] = Text;
+        Arg& arg = record.args[record.argCount++];
+        if (length > TEXT_ARG_BYTES) length = TEXT_ARG_BYTES;
+        if (length > TEXT_BYTES - record.textUsed) length = TEXT_BYTES - record.textUsed;
+        std::memcpy(record.text + record.textUsed, data, length);
+        arg.text.offset = record.textUsed;
+        arg.text.length = static_cast<std::uint8_t>(length);
+        record.textUsed = static_cast<std::uint8_t>(record.textUsed + length);
+    }
+    static void add(Record& record, int value) { addInt(record, value); }
+    static void add(Record& record, long value) { addInt(record, value); }
+    static void add(Record& record, long long value) { addInt(record, value); }
+    static void add(Record& record, unsigned value) { addUint(record, value); }
+    static void add(Record& record, unsigned long value) { addUint(record, value); }
+    static void add(Record& record, unsigned long long value) { addUint(record, value); }
+    static void add(Record& record, double value) {
+        record.types[record.argCount] = Double;
+        record.args[record.argCount++].d = value;
+    }
+    static void add(Record& record, const char* value) { addText(record, value, value ? std::strlen(value) : 0); }
+    static void add(Record& record, const std::string& value) { addText(record, value.data(), value.size()); }
+
+    JournalWriter& journal;
+
+    /**
+     * @brief Backs the ring, with room to start it on a cache line boundary.
+     */
+    std::unique_ptr<unsigned char[]> slotStorage;
+    Slot* slots = nullptr;
+    std::size_t mask;
+    std::atomic<std::uint8_t> minLevel{static_cast<std::uint8_t>(LogLevel::Info)};
+    std::atomic<std::size_t> enqueuePos{0};
+    std::atomic<std::size_t> dropped{0};
+    std::atomic<std::size_t> written{0};
+
+    /**
+     * @brief Set by the drain thread while it sleeps, so a producer filling half of the ring wakes it.
+     */
+    std::atomic<bool> sleeping{false};
+    std::size_t dequeuePos = 0;
+    std::string line;
+    std::time_t stampSecond = -1;
+    char stamp[24] = {};
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable flushed;
+    std::size_t flushRequests = 0;
+    std::size_t flushesDone = 0;
+    bool stopping = false;
+    std::thread worker;
+};
@@ -0,0 +1,94 @@
+#include "lot_loader.h"
+#include "car_csv.h"
+#include "csv_reader.h"
+#include "parking_lot.h"
+#include "segment_index.h"
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief The latest admission row seen for a car ID, as a view of the mapped cars file.
+ */
+struct LatestAdmission {
+    FieldView row;
+    std::size_t count = 0;
+};
+
+}  // namespace
+
+/**
+ * @brief Scans the departures file, then the admissions file, and restores the cars still parked.
+ *
+ * Rotated files are read segment by segment, oldest first, as listed in their segment index.
+ * The departures pass only counts rows per ID. The admissions pass keeps, per ID, an admission
+ * count and a view of the latest row, so the cost is one hash update per row however long
+ * the history is. Surviving rows are parsed into cars at the end and restored in ID order.
+ */
+LoadStats loadLotFromCsv(ParkingLot& lot, const std::string& carsPath, const std::string& departuresPath) {
+    LoadStats stats;
+    int maxId = 0;
+
+    std::unordered_map<int, std::size_t> departed;
+    for (const std::string& path : segment_index::allFiles(departuresPath)) {
+        CsvReader departures(path);
+        if (!departures.isOpen()) continue;
+        departures.setFieldLimit(car_csv::COL_ID + 1);
+        stats.bytes += departures.size();
+        while (departures.next()) {
+            int id;
+            if (car_csv::isHeader(departures.field(car_csv::COL_ID))) continue;
+            if (!car_csv::parseInt(departures.field(car_csv::COL_ID), id)) { ++stats.skipped; continue; }
+            ++departed[id];
+            ++stats.departures;
+            maxId = std::max(maxId, id);
+        }
+    }
+
+    // Admission rows are referenced in place, so every segment stays mapped until the cars are built.
+    std::vector<std::unique_ptr<CsvReader>> admissions;
+    std::unordered_map<int, LatestAdmission> latest;
+    for (const std::string& path : segment_index::allFiles(carsPath)) {
+        std::unique_ptr<CsvReader> reader(new CsvReader(path));
+        if (!reader->isOpen()) continue;
+        reader->setFieldLimit(car_csv::COL_ID + 1);
+        stats.bytes += reader->size();
+        latest.reserve(latest.size() + reader->size() / 128 + 1);
+        while (reader->next()) {
+            int id;
+            if (car_csv::isHeader(reader->field(car_csv::COL_ID))) continue;
+            if (!car_csv::parseInt(reader->field(car_csv::COL_ID), id)) { ++stats.skipped; continue; }
+            LatestAdmission& entry = latest[id];
+            entry.row = reader->raw();
+            ++entry.count;
+            ++stats.admissions;
+            maxId = std::max(maxId, id);
+        }
+        admissions.push_back(std::move(reader));
+    }
+
+    std::vector<Car> parked;
+    std::vector<FieldView> fields;
+    std::string scratch;
+    for (const auto& entry : latest) {
+        const auto gone = departed.find(entry.first);
+        if (gone != departed.end() && gone->second >= entry.second.count) continue;
+        const FieldView& row = entry.second.row;
+        CsvReader::parseRecord(row.data, row.data + row.size, ',', fields, scratch);
+        Car car;
+        if (!car_csv::carFromRow(fields, car)) {
+            ++stats.skipped;
+            continue;
+        }
+        parked.push_back(std::move(car));
+    }
+    std::sort(parked.begin(), parked.end(), [](const Car& a, const Car& b) { return a.id < b.id; });
+
+    for (Car& car : parked) lot.restoreCar(std::move(car));
+    lot.advanceNextCarID(maxId);
+    stats.restored = parked.size();
+    return stats;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+class ParkingLot;
+
+/**
+ * @struct LoadStats
+ * @brief Outcome of rebuilding a lot from its CSV history.
+ */
+struct LoadStats {
+    std::size_t admissions = 0;  ///< Admission rows read from the cars file.
+    std::size_t departures = 0;  ///< Departure rows read from the departures file.
+    std::size_t restored = 0;    ///< Cars still parked and put back into the lot.
+    std::size_t skipped = 0;     ///< Rows that could not be parsed.
+    std::size_t bytes = 0;       ///< Total size of the files scanned.
+};
+
+/**
+ * @brief Rebuilds the parked cars of a lot from cars_data.csv and Customer_details.csv.
+ *
+ * Both files, including any rotated segments of them, are streamed once with CsvReader, so no
+ * per-row or per-field strings are allocated while reading history; only the cars that are still
+ * parked are materialised. A car is considered parked if its ID has more admission rows than
+ * departure rows, and its latest admission row supplies its details and entry time.
+ * Repeated header rows and malformed rows are skipped. The lot's next car ID is moved past every
+ * ID seen in either file so old tickets are never reissued.
+ *
+ * The CSV files do not record the reserved flag or the exit gate, so restored cars get the
+ * defaults for those.
+ *
+ * @param lot The lot to restore into; cars are added with ParkingLot::restoreCar.
+ * @param carsPath Path of the admissions file ("cars_data.csv"). A missing file restores nothing.
+ * @param departuresPath Path of the departures file ("Customer_details.csv"). May be missing.
+ * @return Counts of rows read and cars restored.
+ */
+LoadStats loadLotFromCsv(ParkingLot& lot, const std::string& carsPath, const std::string& departuresPath);
@@ -0,0 +1,166 @@
+#include "lot_metrics.h"
+#include <cctype>
+#include <cstdio>
+#include "logger.h"
+
+namespace {
+
+std::uint64_t read(const std::atomic<std::uint64_t>& value) {
+    return value.load(std::memory_order_relaxed);
+}
+
+double perSecond(const std::uint64_t now, const std::uint64_t before, const double seconds) {
+    return seconds > 0.0 && now >= before ? static_cast<double>(now - before) / seconds : 0.0;
+}
+
+/**
+ * @brief Appends one metric with its HELP and TYPE lines and a single unlabelled sample.
+ */
+void appendMetric(std::string& out, const char* name, const char* type, const char* help, const double value) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s %.17g\n", name, help, name, type, name, value);
+    out += line;
+}
+
+/**
+ * @brief Appends one metric with a sample per slot class, labelled size="small" etc.
+ */
+void appendPerSize(std::string& out, const char* name, const char* help, const std::uint64_t* values) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+    out += line;
+    for (std::size_t i = 0; i < SLOT_CLASS_COUNT; ++i) {
+        std::string size = slotClassName(static_cast<SlotClass>(i));
+        for (char& c : size) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        std::snprintf(line, sizeof(line), "%s{size=\"%s\"} %llu\n", name, size.c_str(),
+                      static_cast<unsigned long long>(values[i]));
+        out += line;
+    }
+}
+
+}  // namespace
+
+MetricsSnapshot takeSnapshot(const LotMetrics& metrics, const Logger* logger, const MetricsSnapshot* previous) {
+    MetricsSnapshot snapshot;
+    snapshot.takenAt = std::chrono::steady_clock::now();
+    snapshot.admissions = read(metrics.admissions);
+    snapshot.departures = read(metrics.departures);
+    snapshot.refusals = read(metrics.refusals);
+    snapshot.bills = read(metrics.bills);
+    snapshot.revenueCents = read(metrics.revenueCents);
+    for (std::size_t i = 0; i < SLOT_CLASS_COUNT; ++i) {
+        snapshot.occupancy[i] = read(metrics.occupancy[i]);
+        snapshot.slotCapacity[i] = read(metrics.slotCapacity[i]);
+    }
+    snapshot.persistenceQueueDepth = read(metrics.persistenceQueueDepth);
+    if (logger) {
+        const LoggerStats stats = logger->getStats();
+        snapshot.logQueueDepth = stats.logged > stats.written ? stats.logged - stats.written : 0;
+        snapshot.logDropped = stats.dropped;
+    }
+    if (previous) {
+        const double seconds = std::chrono::duration<double>(snapshot.takenAt - previous->takenAt).count();
+        snapshot.admissionsPerSecond = perSecond(snapshot.admissions, previous->admissions, seconds);
+        snapshot.departuresPerSecond = perSecond(snapshot.departures, previous->departures, seconds);
+    }
+    return snapshot;
+}
+
+std::string formatPrometheus(const MetricsSnapshot& s) {
+    std::string out;
+    appendPerSize(out, "parking_occupancy", "Cars currently parked, by slot size.", s.occupancy);
+    appendPerSize(out, "parking_slots", "Slots available, by slot size.", s.slotCapacity);
+    appendMetric(out, "parking_admissions_total", "counter", "Cars admitted since startup.", static_cast<double>(s.admissions));
+    appendMetric(out, "parking_departures_total", "counter", "Cars removed since startup.", static_cast<double>(s.departures));
+    appendMetric(out, "parking_refusals_total", "counter", "Admissions refused for lack of a free slot.", static_cast<double>(s.refusals));
+    appendMetric(out, "parking_admissions_per_second", "gauge", "Admission rate over the last export interval.", s.admissionsPerSecond);
+    appendMetric(out, "parking_departures_per_second", "gauge", "Departure rate over the last export interval.", s.departuresPerSecond);
+    appendMetric(out, "parking_bills_total", "counter", "Bills issued since startup.", static_cast<double>(s.bills));
+    appendMetric(out, "parking_revenue_rupees_total", "counter", "Sum of bill totals since startup.", static_cast<double>(s.revenueCents) / 100.0);
+    appendMetric(out, "parking_persistence_queue_depth", "gauge", "Rows waiting for the persistence I/O thread.", static_cast<double>(s.persistenceQueueDepth));
+    appendMetric(out, "parking_log_queue_depth", "gauge", "Log messages waiting for the logger thread.", static_cast<double>(s.logQueueDepth));
+    appendMetric(out, "parking_log_dropped_total", "counter", "Log messages dropped because the ring was full.", static_cast<double>(s.logDropped));
+    return out;
+}
+
+std::string formatStatsTable(const MetricsSnapshot& s) {
+    std::string out;
+    char line[160];
+    out += "Slot size   Occupied      Slots\n";
+    for (std::size_t i = 0; i < SLOT_CLASS_COUNT; ++i) {
+        std::snprintf(line, sizeof(line), "%-9s %10llu %10llu\n", slotClassName(static_cast<SlotClass>(i)),
+                      static_cast<unsigned long long>(s.occupancy[i]), static_cast<unsigned long long>(s.slotCapacity[i]));
+        out += line;
+    }
+    std::snprintf(line, sizeof(line),
+                  "Admissions: %llu (%.2f/s)   Departures: %llu (%.2f/s)   Refused: %llu\n"
+                  "Bills: %llu   Revenue: Rs. %.2f\n"
+                  "Queue depth: persistence %llu, log %llu (dropped %llu)\n",
+                  static_cast<unsigned long long>(s.admissions), s.admissionsPerSecond,
+                  static_cast<unsigned long long>(s.departures), s.departuresPerSecond,
+                  static_cast<unsigned long long>(s.refusals), static_cast<unsigned long long>(s.bills),
+                  static_cast<double>(s.revenueCents) / 100.0, static_cast<unsigned long long>(s.persistenceQueueDepth),
+                  static_cast<unsigned long long>(s.logQueueDepth), static_cast<unsigned long long>(s.logDropped));
+    out += line;
+    return out;
+}
+
+MetricsExporter::MetricsExporter(const LotMetrics& metrics, const std::string& path,
+                                 const std::chrono::milliseconds interval, const Logger* logger)
+    : metrics(metrics), logger(logger), path(path), interval(interval) {
+    previous = takeSnapshot(metrics, logger, nullptr);
+    exportNow();
+    worker = std::thread(&MetricsExporter::run, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+    exportNow();
+}
+
+MetricsSnapshot MetricsExporter::current() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return takeSnapshot(metrics, logger, &previous);
+}
+
+std::size_t MetricsExporter::getExportCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return exports;
+}
+
+void MetricsExporter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+        lock.unlock();
+        exportNow();
+        lock.lock();
+    }
+}
+
+/**
+ * @brief Snapshots the metrics, writes them to "<path>.tmp" and renames that over the export file.
+ */
+bool MetricsExporter::exportNow() {
+    MetricsSnapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = takeSnapshot(metrics, logger, &previous);
+        previous = snapshot;
+        ++exports;
+    }
+    const std::string text = formatPrometheus(snapshot);
+    const std::string tmpPath = path + ".tmp";
+    std::FILE* file = std::fopen(tmpPath.c_str(), "w");
+    if (!file) return false;
+    const bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (std::fclose(file) != 0 || !written || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "pricing.h"
+
+class Logger;
+
+/**
+ * @struct LotMetrics
+ * @brief Live counters and gauges of a parking lot, updated inline by the lot and readable from any thread.
+ *
+ * Every field is a relaxed atomic. The lot is their only writer, so it updates them with a plain
+ * load and store rather than a locked read-modify-write; readers on other threads see each value
+ * whole, though not necessarily all fields from the same instant.
+ */
+struct LotMetrics {
+    std::atomic<std::uint64_t> admissions{0};    ///< Cars admitted since startup.
+    std::atomic<std::uint64_t> departures{0};    ///< Cars removed since startup.
+    std::atomic<std::uint64_t> refusals{0};      ///< Admissions refused for lack of a slot.
+    std::atomic<std::uint64_t> bills{0};         ///< Bills issued.
+    std::atomic<std::uint64_t> revenueCents{0};  ///< Sum of bill totals, in paise.
+    std::atomic<std::uint64_t> occupancy[SLOT_CLASS_COUNT] = {};      ///< Parked cars per slot class.
+    std::atomic<std::uint64_t> slotCapacity[SLOT_CLASS_COUNT] = {};   ///< Slots per slot class.
+    std::atomic<std::uint64_t> persistenceQueueDepth{0};               ///< Rows waiting for the I/O thread.
+
+    /**
+     * @brief Adds to a counter; only valid from the single thread that writes the metrics.
+     */
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t amount = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets a gauge.
+     */
+    static void set(std::atomic<std::uint64_t>& gauge, std::uint64_t value) {
+        gauge.store(value, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @struct MetricsSnapshot
+ * @brief The values of a LotMetrics at one instant, with rates over the window since an earlier snapshot.
+ */
+struct MetricsSnapshot {
+    std::chrono::steady_clock::time_point takenAt;
+    std::uint64_t admissions = 0;
+    std::uint64_t departures = 0;
+    std::uint64_t refusals = 0;
+    std::uint64_t bills = 0;
+    std::uint64_t revenueCents = 0;
+    std::uint64_t occupancy[SLOT_CLASS_COUNT] = {};
+    std::uint64_t slotCapacity[SLOT_CLASS_COUNT] = {};
+    std::uint64_t persistenceQueueDepth = 0;
+    std::uint64_t logQueueDepth = 0;   ///< Messages waiting for the logger's drain thread.
+    std::uint64_t logDropped = 0;      ///< Messages the logger dropped because its ring was full.
+    double admissionsPerSecond = 0.0;  ///< Over the window since the previous snapshot.
+    double departuresPerSecond = 0.0;  ///< Over the window since the previous snapshot.
+};
+
+/**
+ * @brief Reads every metric once.
+ * @param metrics The lot's metrics.
+ * @param logger The session logger whose backlog is reported, or null.
+ * @param previous An earlier snapshot to compute rates against, or null for zero rates.
+ */
+MetricsSnapshot takeSnapshot(const LotMetrics& metrics, const Logger* logger, const MetricsSnapshot* previous);
+
+/**
+ * @brief Formats a snapshot in the Prometheus text exposition format.
+ */
+std::string formatPrometheus(const MetricsSnapshot& snapshot);
+
+/**
+ * @brief Formats a snapshot as a table for the console.
+ */
+std::string formatStatsTable(const MetricsSnapshot& snapshot);
+
+/**
+ * @class MetricsExporter
+ * @brief Rewrites a Prometheus text file from a lot's metrics at a fixed interval on a background thread.
+ *
+ * Each export is written to "<path>.tmp" and renamed into place, so a scraper never reads a
+ * partial file. Rates in the file are over the interval since the previous export.
+ */
+class MetricsExporter {
+public:
+    /**
+     * @brief Writes the first export and starts the thread.
+     * @param metrics The metrics to export; must outlive the exporter.
+     * @param path The file to rewrite, e.g. "parking_metrics.prom".
+     * @param interval Time between exports.
+     * @param logger The session logger whose backlog is exported, or null; must outlive the exporter.
+     */
+    MetricsExporter(const LotMetrics& metrics, const std::string& path,
+                    std::chrono::milliseconds interval = std::chrono::milliseconds(5000), const Logger* logger = nullptr);
+
+    /**
+     * @brief Writes a final export and stops the thread.
+     */
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * @brief Takes a snapshot now, with rates over the window since the last export.
+     */
+    MetricsSnapshot current() const;
+
+    /**
+     * @brief Returns the number of exports taken, including the first one made by the constructor.
+     */
+    std::size_t getExportCount() const;
+
+private:
+    void run();
+    bool exportNow();
+
+    const LotMetrics& metrics;
+    const Logger* logger;
+    std::string path;
+    std::chrono::milliseconds interval;
+    MetricsSnapshot previous;
+    std::size_t exports = 0;
+    bool stopping = false;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+};
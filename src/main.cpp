@@ -1,7 +1,18 @@
 #include "parking_lot.h"
+#include "lot_loader.h"
+#include "logger.h"
+#include "lot_metrics.h"
+#include "event_replay.h"
+#include "gate_server.h"
+#include "output_sink.h"
+#include "trace.h"
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
-#include <ctime>
+#include <memory>
 
 // ANSI Colors
 #define RESET   "\033[0m"
@@ -11,8 +22,20 @@
 #define RED     "\033[31m"
 #define BOLD    "\033[1m"
 
-// Global session log
-std::ofstream logFile;
+/**
+ * @brief Journal settings shared by the session log and the lot's data files: a new segment is
+ *        started every day or every 16 MiB, whichever comes first.
+ */
+JournalOptions rotatingJournalOptions() {
+    JournalOptions options;
+    options.segmentBytes = 16 * 1024 * 1024;
+    options.segmentAge = std::chrono::hours(24);
+    return options;
+}
+
+// Global session log: messages are queued in a ring and written through a rotating journal by a background thread
+JournalWriter sessionJournal("session_log.txt", "", rotatingJournalOptions());
+Logger sessionLog(sessionJournal);
 
 // Startup banner without delays
 /**
@@ -37,27 +60,95 @@ void startupBanner() {
 /**
  * @brief Opens the session log file and writes a session start header.
  *
- * This function opens the "session_log.txt" file in append mode and writes a header
- * indicating the start of a new session, including the current date and time.
- * The header is formatted for easy identification of session boundaries in the log file.
+ * The session log is appended to "session_log.txt" by the session logger's drain thread; this logs
+ * a marker indicating the start of a new session. Every log line carries its date and time, so the
+ * marker is easy to find at session boundaries in the log file.
  */
 void openLogFiles() {
-    logFile.open("session_log.txt", std::ios::app);
-    const std::time_t now = std::time(nullptr);
-    logFile << "\n===== New Session Started: " << std::ctime(&now) << "=====\n";
+    sessionLog.log(LogLevel::Info, "===== New Session Started =====");
 }
 
 // Close log file
 /**
  * @brief Closes the log file after writing a session end marker.
  *
- * Appends "===== Session Ended =====" to the log file to indicate the end of the current session,
- * then closes the file stream to ensure all data is flushed and resources are released.
+ * Logs "===== Session Ended =====" to indicate the end of the current session, then waits for the
+ * logger to drain and flush so everything logged reaches the file.
  */
 void closeLogFiles() {
-    logFile << "===== Session Ended =====\n";
-    logFile.close();
+    sessionLog.log(LogLevel::Info, "===== Session Ended =====");
+    sessionLog.flush();
+}
+/**
+ * @brief Feeds gate events from a file or stdin through the lot and prints the throughput.
+ *
+ * @param lot The lot to drive, with persistence already set up.
+ * @param path The event file, or "-" for stdin; see replayGateEvents() for the format.
+ * @param outputPath File to collect the lot's output (bills, tables), or null to discard it.
+ * @return 0 once the events are replayed, 1 if the event file cannot be opened.
+ */
+int runReplay(ParkingLot& lot, const char* path, const char* outputPath) {
+    std::ifstream file;
+    if (std::strcmp(path, "-") != 0) {
+        file.open(path);
+        if (!file) {
+            std::cerr << RED << "Cannot open replay file " << path << "\n" << RESET;
+            return 1;
+        }
+    }
+    std::istream& events = file.is_open() ? static_cast<std::istream&>(file) : std::cin;
+    std::unique_ptr<BufferedFileSink> output;
+    if (outputPath) output.reset(new BufferedFileSink(outputPath));
+    lot.setOutput(output.get());
+
+    sessionLog.log(LogLevel::Info, "Replaying gate events from {}", path);
+    const GateReplayStats stats = replayGateEvents(lot, events);
+    lot.flushJournals();
+    lot.setOutput(nullptr);
+    sessionLog.log(LogLevel::Info, "Replayed {} events in {} s, {} malformed line(s) rejected",
+                   stats.events, stats.seconds, stats.rejected);
+    std::cout << formatReplayReport(stats);
+    return 0;
+}
+
+// The daemon's server, for the signal handler
+GateServer* activeGateServer = nullptr;
+
+/**
+ * @brief Stops the daemon on SIGINT or SIGTERM so it shuts down like the menu's exit.
+ */
+extern "C" void stopGateServer(int) {
+    if (activeGateServer) activeGateServer->stop();
+}
+
+/**
+ * @brief Serves gate clients on a Unix socket until SIGINT or SIGTERM.
+ *
+ * @param lot The lot to serve, already restored.
+ * @param socketPath Where to create the socket; see GateServer for the protocol.
+ * @return 0 after a clean stop, 1 if the socket cannot be set up.
+ */
+int runDaemon(ParkingLot& lot, const char* socketPath) {
+    GateServer server(lot, socketPath);
+    if (!server.listen()) {
+        std::cerr << RED << server.getError() << "\n" << RESET;
+        sessionLog.log(LogLevel::Error, "Daemon could not start: {}", server.getError());
+        return 1;
+    }
+    lot.setOutput(nullptr);
+    activeGateServer = &server;
+    std::signal(SIGINT, stopGateServer);
+    std::signal(SIGTERM, stopGateServer);
+    std::cout << GREEN << "Serving gate clients on " << socketPath << "\n" << RESET;
+    sessionLog.log(LogLevel::Info, "Serving gate clients on {}", socketPath);
+    server.run();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    activeGateServer = nullptr;
+    sessionLog.log(LogLevel::Info, "Daemon stopped after {} request(s)", server.getRequestCount());
+    return 0;
 }
+
 /**
  * @brief The entry point for the Deva Parking System application.
  *
@@ -65,37 +156,139 @@ void closeLogFiles() {
  * for parking, removing, and displaying cars in the parking lot. Handles user input validation
  * and logs all major actions and menu selections.
  *
+ * With --replay, events are read from a file or stdin instead (see runReplay), and
+ * --replay-output names a file to collect the lot's output during the replay. With --daemon, the
+ * restored lot is served to gate clients over a Unix socket (see runDaemon) until a signal arrives.
+ *
  * @return int Returns 0 upon successful program termination.
  */
-int main() {
+int main(int argc, char** argv) {
+    // --replay <file|-> runs gate events non-interactively instead of the menu
+    const char* replayPath = nullptr;
+    const char* replayOutput = nullptr;
+    const char* daemonSocket = nullptr;
+    for (int i = 1; i < argc; i += 2) {
+        const bool hasValue = i + 1 < argc;
+        if (hasValue && std::strcmp(argv[i], "--replay") == 0) {
+            replayPath = argv[i + 1];
+        } else if (hasValue && std::strcmp(argv[i], "--replay-output") == 0) {
+            replayOutput = argv[i + 1];
+        } else if (hasValue && std::strcmp(argv[i], "--daemon") == 0) {
+            daemonSocket = argv[i + 1];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--replay <file|-> [--replay-output <file>] | --daemon <socket>]\n";
+            return 2;
+        }
+    }
+
     openLogFiles();
-    ParkingLot lot;
+#ifdef PARKING_TRACE
+    // Tracing builds record every gate span to parking_trace.json for chrome://tracing or Perfetto
+    trace::begin("parking_trace.json");
+#endif
+    // PARKING_STORAGE=binary records everything in parking_data.bin instead of the CSV and text files
+    const char* storageName = std::getenv("PARKING_STORAGE");
+    const bool binaryStorage = storageName && std::strcmp(storageName, "binary") == 0;
+    // A replay drives a fresh lot, so it records into replay_* files and never touches the live data or the event log
+    ParkingLot lot(makeStorageBackend(binaryStorage ? StorageKind::BinaryLog : StorageKind::Csv,
+                                      replayPath ? "replay_" : ""));
     int choice;
+    lot.setLogger(&sessionLog);
+    // PARKING_LATENCY=1 times park, remove, lookup and fee operations; percentiles go to latency_report.txt
+    // from the stats menu and on exit
+    const char* latencyFlag = std::getenv("PARKING_LATENCY");
+    const bool trackLatency = latencyFlag && *latencyFlag && std::strcmp(latencyFlag, "0") != 0;
+    lot.setLatencyTracking(trackLatency);
+
+    // Bills and CSV rows are written by a background I/O thread so the gate never waits on disk
+    JournalOptions dataOptions = rotatingJournalOptions();
+    dataOptions.durability = Durability::GroupCommit;  // car rows and bills synced within 10 ms
+    lot.setJournalOptions(dataOptions);
+    lot.enableAsyncPersistence();
+
+    if (replayPath) {
+        const int status = runReplay(lot, replayPath, replayOutput);
+        if (trackLatency) lot.dumpLatencies("latency_report.txt");
+        closeLogFiles();
+#ifdef PARKING_TRACE
+        trace::end();
+#endif
+        return status;
+    }
+
+    // Rebuild the lot from the event log, or from the CSV history when no log exists yet
+    const auto startupBegin = std::chrono::steady_clock::now();
+    const bool haveEventLog = std::ifstream("parking_events.wal").good() ||
+                              std::ifstream("parking_events.wal.snap").good() ||
+                              std::ifstream("parking_events.wal.old").good();
+    size_t restored = lot.openEventLog("parking_events.wal");
+    const char* restoredFrom = "event log";
+    std::size_t skippedRows = 0;
+    if (!haveEventLog) {
+        const LoadStats loaded = loadLotFromCsv(lot, "cars_data.csv", "Customer_details.csv");
+        restored = loaded.restored;
+        skippedRows = loaded.skipped;
+        restoredFrom = "CSV history";
+    }
+    const double startupMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startupBegin).count();
+
+    // Live counters are rewritten to parking_metrics.prom (Prometheus text format) every 5 seconds
+    MetricsExporter metricsExporter(lot.getMetrics(), "parking_metrics.prom", std::chrono::seconds(5), &sessionLog);
 
     // Show startup banner instantly
     startupBanner();
-    logFile << "🚗 Welcome to Deva Parking System — Your car is safe with us!\n";
+    std::cout << GREEN << "Restored " << restored << " parked car(s) from the " << restoredFrom
+              << " in " << startupMs << " ms.\n" << RESET;
+    sessionLog.log(LogLevel::Info, "Restored {} parked car(s) from the {} in {} ms", restored, restoredFrom, startupMs);
+    if (skippedRows > 0) {
+        // A skipped admission row may be a parked car that was not restored
+        std::cout << RED << "Skipped " << skippedRows << " unreadable row(s) in the CSV history; "
+                  << "check cars_data.csv and Customer_details.csv.\n" << RESET;
+        sessionLog.log(LogLevel::Warn, "Skipped {} unreadable row(s) while restoring from the CSV history", skippedRows);
+    }
+    sessionLog.log(LogLevel::Info, "🚗 Welcome to Deva Parking System — Your car is safe with us!");
+
+    if (daemonSocket) {
+        const int status = runDaemon(lot, daemonSocket);
+        lot.flushJournals();
+        lot.checkpoint();
+        lot.waitForCheckpoint();
+        if (trackLatency) lot.dumpLatencies("latency_report.txt");
+        closeLogFiles();
+#ifdef PARKING_TRACE
+        trace::end();
+#endif
+        return status;
+    }
 
     while (true) {
+        lot.flushDueJournals();
         std::cout << GREEN << "\n========= MAIN MENU =========\n" << RESET
                   << YELLOW << "1." << RESET << " Park Car\n"
                   << YELLOW << "2." << RESET << " Remove Car\n"
                   << YELLOW << "3." << RESET << " Display Parked Cars\n"
                   << YELLOW << "4." << RESET << " Exit\n"
+                  << YELLOW << "5." << RESET << " Show Stats\n"
                   << GREEN << "=============================\n" << RESET
                   << BOLD << "Enter choice: " << RESET;
 
-        logFile << "\n=== Deva Parking Menu ===\n"
-                << "1. Park Car\n2. Remove Car\n3. Display Parked Cars\n4. Exit\nEnter choice: ";
-
         if (!(std::cin >> choice)) {
-            std::cin.clear();
-            std::cin.ignore(10000, '\n');
-            std::cout << RED << "Invalid input! Please enter a number.\n" << RESET;
-            logFile << "Invalid input! Please enter a number.\n";
-            continue;
+            if (std::cin.eof()) {
+                // No more input will come; leave the way Exit does instead of prompting forever
+                sessionLog.log(LogLevel::Info, "End of input; exiting");
+                choice = 4;
+            } else {
+                std::cin.clear();
+                std::cin.ignore(10000, '\n');
+                std::cout << RED << "Invalid input! Please enter a number.\n" << RESET;
+                sessionLog.log(LogLevel::Warn, "Invalid menu input; expected a number");
+                continue;
+            }
+        } else {
+            std::cin.ignore();
+            sessionLog.log(LogLevel::Debug, "Menu choice {}", choice);
         }
-        std::cin.ignore();
 
         switch (choice) {
             case 1:
@@ -108,11 +301,24 @@ int main() {
                 lot.displayCars();
                 break;
             case 4:
+                lot.flushJournals();
+                lot.checkpoint();
+                lot.waitForCheckpoint();
+                if (trackLatency) lot.dumpLatencies("latency_report.txt");
                 closeLogFiles();
+#ifdef PARKING_TRACE
+                trace::end();
+#endif
                 return 0;
+            case 5:
+                std::cout << CYAN << "\n--- Live Stats ---\n" << RESET << formatStatsTable(metricsExporter.current())
+                          << "\n" << lot.ioReport();
+                if (trackLatency && lot.dumpLatencies("latency_report.txt"))
+                    std::cout << "Latency percentiles written to latency_report.txt\n";
+                break;
             default:
                 std::cout << RED << "Invalid choice! Try again.\n" << RESET;
-                logFile << "Invalid choice! Try again.\n";
+                sessionLog.log(LogLevel::Warn, "Invalid menu choice {}", choice);
         }
     }
 }
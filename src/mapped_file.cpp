@@ -0,0 +1,64 @@
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool FieldView::equals(const char* text) const {
+    const std::size_t n = std::strlen(text);
+    return n == size && (n == 0 || std::memcmp(data, text, n) == 0);
+}
+
+/**
+ * @brief Maps the whole file read-only and private.
+ *
+ * The descriptor is closed straight after mapping; the mapping keeps the file contents reachable.
+ *
+ * @param path Path of the file to map.
+ * @return True if the file is mapped (possibly with size 0).
+ */
+bool MappedFile::open(const std::string& path) {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length > 0) {
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        base = static_cast<const char*>(mapped);
+    }
+    ::close(fd);
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (base) ::munmap(const_cast<char*>(base), length);
+    base = nullptr;
+    length = 0;
+    opened = false;
+}
+
+void MappedFile::adviseSequential() const {
+    if (base) ::madvise(const_cast<char*>(base), length, MADV_SEQUENTIAL);
+}
+
+void MappedFile::release(const std::size_t offset, const std::size_t releaseLength) const {
+    if (!base || offset >= length) return;
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t start = offset / page * page;
+    const std::size_t end = std::min(length, offset + releaseLength);
+    if (end > start)
+        ::madvise(const_cast<char*>(base) + start, end - start, MADV_DONTNEED);
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * @struct FieldView
+ * @brief A non-owning view of a run of characters inside a larger buffer, such as one CSV field.
+ *
+ * Parsers hand out FieldViews into memory-mapped files instead of copying every field into a
+ * std::string; the view is valid as long as the underlying buffer is.
+ */
+struct FieldView {
+    const char* data = nullptr;
+    std::size_t size = 0;
+
+    FieldView() = default;
+    FieldView(const char* data, std::size_t size) : data(data), size(size) {}
+
+    bool empty() const { return size == 0; }
+    std::string str() const { return std::string(data, size); }
+
+    /**
+     * @brief Compares the viewed characters with a NUL-terminated string.
+     */
+    bool equals(const char* text) const;
+};
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Mapping lets loaders scan persisted files at memory speed without read() copies or per-line
+ * allocations; pages are brought in by the kernel on demand and can be dropped again under memory
+ * pressure. An existing empty file maps successfully with size() == 0.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Maps the given file; check isOpen() for success.
+     */
+    explicit MappedFile(const std::string& path) { open(path); }
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps a file, unmapping any file mapped before.
+     * @param path Path of the file to map.
+     * @return False if the file does not exist or cannot be mapped.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close();
+
+    /**
+     * @brief Tells the kernel the mapping will be read front to back, enabling aggressive read-ahead.
+     */
+    void adviseSequential() const;
+
+    /**
+     * @brief Tells the kernel the given byte range will not be needed again, releasing its pages.
+     * @param offset Start of the range; rounded down to a page boundary.
+     * @param length Length of the range.
+     */
+    void release(std::size_t offset, std::size_t length) const;
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return base; }
+    std::size_t size() const { return length; }
+
+private:
+    const char* base = nullptr;
+    std::size_t length = 0;
+    bool opened = false;
+};
@@ -0,0 +1,24 @@
+#include "output_sink.h"
+#include <iostream>
+
+ConsoleSink::ConsoleSink(std::ostream& out) : out(out) {}
+
+void ConsoleSink::write(const char* data, const std::size_t length) {
+    out.write(data, static_cast<std::streamsize>(length));
+}
+
+void ConsoleSink::flush() {
+    out.flush();
+}
+
+BufferedFileSink::BufferedFileSink(const std::string& path) : journal(path) {}
+
+OutputSink& consoleOutput() {
+    static ConsoleSink sink(std::cout);
+    return sink;
+}
+
+OutputSink& nullOutput() {
+    static NullSink sink;
+    return sink;
+}
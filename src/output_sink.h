@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <iosfwd>
+#include <string>
+#include "journal_writer.h"
+
+/**
+ * @class OutputSink
+ * @brief Where a ParkingLot sends its prompts, messages, tables and bills.
+ *
+ * The lot asks enabled() before formatting anything, so a sink that discards output also saves the
+ * work of building it. Each message reaches the sink as one write of ready-made bytes.
+ */
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+
+    /**
+     * @brief Writes bytes to the sink.
+     */
+    virtual void write(const char* data, std::size_t length) = 0;
+
+    /**
+     * @brief Writes a NUL-terminated string.
+     */
+    void write(const char* text) { write(text, std::strlen(text)); }
+
+    /**
+     * @brief Writes a string.
+     */
+    void write(const std::string& text) { write(text.data(), text.size()); }
+
+    /**
+     * @brief Returns false if the sink discards everything, so callers can skip formatting.
+     */
+    virtual bool enabled() const { return true; }
+
+    /**
+     * @brief Hands any buffered output on to its destination.
+     */
+    virtual void flush() {}
+};
+
+/**
+ * @class ConsoleSink
+ * @brief Writes to a std::ostream, by default std::cout.
+ *
+ * Every message is one write() into the stream's buffer, and nothing is flushed per message: the
+ * stream goes out when its buffer fills, when std::cin reads (std::cin is tied to std::cout), or on
+ * flush(). Interactive prompts therefore still appear before input is read.
+ */
+class ConsoleSink : public OutputSink {
+public:
+    /**
+     * @brief Wraps a stream, which must outlive the sink.
+     */
+    explicit ConsoleSink(std::ostream& out);
+
+    void write(const char* data, std::size_t length) override;
+    void flush() override;
+    using OutputSink::write;
+
+private:
+    std::ostream& out;
+};
+
+/**
+ * @class BufferedFileSink
+ * @brief Appends output to a file through a JournalWriter, which writes it in 64 KiB blocks.
+ *
+ * Buffered output is written when the buffer fills, when a write finds the oldest output a second
+ * old, on flush(), and when the sink is destroyed.
+ */
+class BufferedFileSink : public OutputSink {
+public:
+    /**
+     * @brief Creates the sink; the file is opened on the first flush.
+     * @param path The file to append to.
+     */
+    explicit BufferedFileSink(const std::string& path);
+
+    void write(const char* data, std::size_t length) override { journal.append(data, length); }
+    void flush() override { journal.flush(); }
+    using OutputSink::write;
+
+private:
+    JournalWriter journal;
+};
+
+/**
+ * @class NullSink
+ * @brief Discards everything and reports itself disabled, so headless lots format no output at all.
+ */
+class NullSink : public OutputSink {
+public:
+    void write(const char*, std::size_t) override {}
+    bool enabled() const override { return false; }
+    using OutputSink::write;
+};
+
+/**
+ * @brief Returns the process-wide sink writing to std::cout, the default for every lot.
+ */
+OutputSink& consoleOutput();
+
+/**
+ * @brief Returns the process-wide sink that discards output.
+ */
+OutputSink& nullOutput();
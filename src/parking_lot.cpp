@@ -1,11 +1,14 @@
 #include "parking_lot.h"
-#include <iomanip>
+#include "logger.h"
+#include "trace.h"
 #include <algorithm>
 #include <chrono>
-#include <fstream>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <sstream>
-#include <sys/stat.h>
+#include <unistd.h>
 
 // ANSI Colors
 #define RESET   "\033[0m"
@@ -16,75 +19,234 @@
 #define BOLD    "\033[1m"
 
 /**
- * @brief Logs a message to the standard output if not in silent mode.
- * 
- * This templated function prints the provided message to std::cout
- * only if the 'silent' parameter is false. It can be used to control
- * logging output in the ParkingLot system.
- * 
- * @tparam T The type of the message to be logged. Must be streamable to std::cout.
- * @param silent If true, suppresses the output; if false, outputs the message.
- * @param msg The message to be logged.
+ * @brief Writes a message to the lot's output sink.
+ *
+ * Messages are literals or already formatted, and the sink is asked first whether it wants output
+ * at all, so a null sink costs one virtual call.
+ *
+ * @param out The lot's output sink.
+ * @param msg The message to write.
  */
-template<typename T>
-void ParkingLot_logOut(const bool silent, const T& msg) {
-    if (!silent) {
-        std::cout << msg;
-    }
+void ParkingLot_logOut(OutputSink& out, const char* msg) {
+    if (out.enabled()) out.write(msg);
 }
+
 /**
  * @class ParkingLot
  * @brief Manages parking lot operations including billing and record keeping.
  */
-ParkingLot::ParkingLot() : nextCarID(1001) {}
+ParkingLot::ParkingLot(const size_t capacity)
+    : ParkingLot(makeStorageBackend(StorageKind::Csv), capacity) {}
+
+ParkingLot::ParkingLot(std::unique_ptr<StorageBackend> backend, const size_t capacity)
+    : nextCarID(1001), capacity(capacity), storage(std::move(backend)) {
+    occupancy.fill(0);
+    slotCapacity.fill(capacity);
+    for (auto& gauge : metrics.slotCapacity) LotMetrics::set(gauge, capacity);
+}
+
+ParkingLot::~ParkingLot() {
+    waitForCheckpoint();
+    persistence.reset();
+}
+
+/**
+ * @brief Checks whether a car of the given slot class can still be admitted.
+ *
+ * Both the overall lot capacity and the per-class capacity are checked against the live
+ * counters, so the check never scans the list of parked cars.
+ *
+ * @param cls The slot class of the arriving car.
+ * @return True if there is a free slot for the car.
+ */
+bool ParkingLot::hasRoomFor(const SlotClass cls) const {
+    const size_t idx = static_cast<size_t>(cls);
+    return cars.size() < capacity && occupancy[idx] < slotCapacity[idx];
+}
+
+void ParkingLot::trackAdmission(const Car& car) {
+    const size_t cls = static_cast<size_t>(slotClassOf(car.slotSize));
+    LotMetrics::set(metrics.occupancy[cls], ++occupancy[cls]);
+}
 
+void ParkingLot::trackDeparture(const Car& car) {
+    const size_t cls = static_cast<size_t>(slotClassOf(car.slotSize));
+    if (occupancy[cls] > 0) --occupancy[cls];
+    LotMetrics::set(metrics.occupancy[cls], occupancy[cls]);
+}
 
+double ParkingLot::getUtilization(const SlotClass cls) const {
+    const size_t idx = static_cast<size_t>(cls);
+    if (slotCapacity[idx] == 0) return 1.0;
+    return std::min(1.0, static_cast<double>(occupancy[idx]) / static_cast<double>(slotCapacity[idx]));
+}
 
 /**
- * @brief Saves the details of a car to a CSV file.
+ * @brief Returns the surge multiplier for a car arriving now into the given slot size.
  *
- * This function appends the provided car's information to a CSV file named "cars_data.csv".
- * If the file does not exist, it writes the header row before appending the car data.
- * The current entry time is also recorded for each car.
+ * The multiplier is read from the surge curve at the slot class's current utilization,
+ * which is taken from the occupancy counters in constant time.
  *
- * @param car The Car object containing all relevant details to be saved.
+ * @param slotSize The slot size of the arriving car.
+ * @return The multiplier applied to the car's hourly rate if it uses dynamic pricing.
  */
-void ParkingLot::saveCarToCSV(const Car& car) const {
-    constexpr const char* filename = "cars_data.csv";
-    bool write_header = false;
-    struct stat buffer;
-    if (stat(filename, &buffer) != 0) write_header = true;
-
-    std::ofstream csv(filename, std::ios::app);
-    if (write_header) {
-        csv << "CarID,OwnerName,LicensePlate,Model,Color,FuelType,Phone,Email,Membership,PaymentMethod,Slot,Size,Rate,DynamicPricing,EntryTime\n";
+double ParkingLot::currentSurgeMultiplier(const std::string& slotSize) const {
+    const size_t idx = static_cast<size_t>(slotClassOf(slotSize));
+    return surgeCurve.multiplierAt(occupancy[idx], slotCapacity[idx]);
+}
+
+
+
+void ParkingLot::enableAsyncPersistence(const PersistenceOptions& options) {
+    persistence.reset();
+    PersistenceOptions withGauge = options;
+    if (!withGauge.depthGauge) withGauge.depthGauge = &metrics.persistenceQueueDepth;
+    persistence.reset(new PersistenceQueue(withGauge));
+    storage->setPersistenceQueue(persistence.get());
+}
+
+void ParkingLot::disableAsyncPersistence() {
+    storage->setPersistenceQueue(nullptr);
+    persistence.reset();
+    LotMetrics::set(metrics.persistenceQueueDepth, 0);
+}
+
+PersistenceStats ParkingLot::getPersistenceStats() const {
+    return persistence ? persistence->getStats() : PersistenceStats();
+}
+
+void ParkingLot::resetLatencies() {
+    for (LatencyHistogram& histogram : latencies) histogram.reset();
+}
+
+/**
+ * @brief Writes the latency table to "<path>.tmp" and renames it into place, so a reader never sees a partial report.
+ */
+bool ParkingLot::dumpLatencies(const std::string& path) const {
+    static const char* const names[LOT_OPERATION_COUNT] = {"park", "remove", "lookup", "fee"};
+    const std::string report = formatLatencyReport(names, latencies.data(), latencies.size());
+    const std::string tmpPath = path + ".tmp";
+    std::FILE* file = std::fopen(tmpPath.c_str(), "w");
+    if (!file) return false;
+    const bool written = std::fwrite(report.data(), 1, report.size(), file) == report.size();
+    if (std::fclose(file) != 0 || !written || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+IoStats ParkingLot::getIoStats(const StorageStream stream) const {
+    const JournalWriter* journal = storage->journalFor(stream);
+    return journal ? journal->getIoStats() : IoStats();
+}
+
+IoStats ParkingLot::getTotalIoStats() const {
+    IoStats total;
+    for (const JournalWriter* journal : storage->journals()) total += journal->getIoStats();
+    if (logger) total += logger->getJournal().getIoStats();
+    return total;
+}
+
+std::string ParkingLot::ioReport() const {
+    const std::vector<JournalWriter*> owned = storage->journals();
+    std::vector<const JournalWriter*> journals(owned.begin(), owned.end());
+    if (logger) journals.push_back(&logger->getJournal());
+    std::vector<std::string> names;
+    std::vector<IoStats> stats;
+    IoStats total;
+    for (const JournalWriter* journal : journals) {
+        names.push_back(journal->getPath());
+        stats.push_back(journal->getIoStats());
+        total += stats.back();
+    }
+    names.push_back("total");
+    stats.push_back(total);
+    std::vector<const char*> namePointers;
+    for (const std::string& name : names) namePointers.push_back(name.c_str());
+    return formatIoReport(namePointers.data(), stats.data(), stats.size());
+}
+
+/**
+ * @brief Applies new flush thresholds to all journals, under the I/O lock when a queue owns them.
+ */
+void ParkingLot::setJournalOptions(const JournalOptions& options) {
+    auto apply = [this, &options] {
+        for (JournalWriter* journal : storage->journals()) journal->setOptions(options);
+    };
+    if (persistence) persistence->withIoLock(apply); else apply();
+}
+
+/**
+ * @brief Waits for queued rows to reach their journals, then writes every journal's buffer out.
+ */
+void ParkingLot::flushJournals() {
+    auto flushAll = [this] {
+        for (JournalWriter* journal : storage->journals()) journal->flush();
+    };
+    if (persistence) {
+        persistence->drain();
+        persistence->withIoLock(flushAll);
+    } else {
+        flushAll();
     }
+}
+
+/**
+ * @brief Flushes journals whose age threshold has passed; the I/O thread does this itself when enabled.
+ */
+void ParkingLot::flushDueJournals() {
+    if (persistence) return;
+    for (JournalWriter* journal : storage->journals()) journal->flushIfDue();
+}
 
-    std::time_t now = std::time(nullptr);
-    std::string timeStr = std::ctime(&now);
-    if (!timeStr.empty()) timeStr.pop_back();
+/**
+ * @brief Records the car's admission in the storage backend.
+ *
+ * With the CSV backend the car becomes a row of "cars_data.csv", stamped with its entry time and
+ * batched by a long-lived journal writer. With asynchronous persistence enabled the backend's
+ * write is queued for the I/O thread instead.
+ *
+ * @param car The Car object containing all relevant details to be saved.
+ */
+void ParkingLot::saveCarToCSV(const Car& car) const {
+    TRACE_SPAN("storage.saveAdmission");
+    storage->saveAdmission(car);
+}
 
-    csv << car.id << ',' << car.ownerName << ',' << car.licensePlate << ','
-        << car.model << ',' << car.color << ',' << car.fuelType << ','
-        << car.phone << ',' << car.email << ',' << car.membership << ','
-        << car.paymentMethod << ',' << car.slot << ',' << car.slotSize << ','
-        << car.hourlyRate << ',' << (car.dynamicPricing ? "Yes" : "No") << ','
-        << timeStr << '\n';
+void ParkingLot::saveDepartureToCSV(const Car& car, const std::chrono::system_clock::time_point removedAt) const {
+    TRACE_SPAN("storage.saveDeparture");
+    storage->saveDeparture(car, removedAt);
 }
 
 /**
- * @brief Saves the provided bill information to a text file.
+ * @brief Records the provided bill information in the storage backend.
  *
- * Appends the given bill string to the "bill_history.txt" file, ensuring
- * that each bill is written on a new line. This function is used to
- * maintain a persistent record of all generated bills.
+ * With the CSV backend the bill is appended to "bill_history.txt", followed by a blank line,
+ * to maintain a persistent record of all generated bills.
  *
  * @param bill The bill information to be saved as a string.
  */
-
 void ParkingLot::saveBillToText(const std::string& bill) const {
-    std::ofstream file("bill_history.txt", std::ios::app);
-    file << bill << '\n';
+    saveBillToText(bill.data(), bill.size());
+}
+
+void ParkingLot::saveBillToText(const char* bill, const size_t length) const {
+    TRACE_SPAN("storage.saveBill");
+    storage->saveBill(bill, length);
+}
+
+/**
+ * @brief Records the structured form of the bill in the storage backend.
+ *
+ * @param car The departing car.
+ * @param fee The itemised charge for its stay.
+ * @param exitTime The time the car left.
+ */
+void ParkingLot::saveBillRecord(const Car& car, const FeeBreakdown& fee,
+                                const std::chrono::system_clock::time_point exitTime) const {
+    TRACE_SPAN("storage.saveBillRecord");
+    storage->saveBillRecord(bill_records::makeRecord(car, fee, exitTime));
 }
 
 /**
@@ -92,6 +254,8 @@ void ParkingLot::saveBillToText(const std::string& bill) const {
  *
  * Prompts the user for car and owner details, slot information, and parking preferences.
  * Supports reserved slots, dynamic pricing, and custom parking durations.
+ * Dynamically priced cars have their hourly rate scaled by the surge multiplier for their
+ * slot class's occupancy at the moment of admission.
  * If the parking lot has available capacity, creates a Car object with the provided details,
  * optionally adjusts the parking time based on user input, and adds the car to the lot.
  * Saves the car information to CSV if not in silent mode.
@@ -109,95 +273,139 @@ void ParkingLot::parkCar() {
     bool dynamicPricing = false;
     double parkingHours = 0.0;
 
-    ParkingLot_logOut(silentMode, std::string(BOLD) + CYAN + "\n--- Car Parking Entry ---\n" + RESET);
+    ParkingLot_logOut(*output, BOLD CYAN "\n--- Car Parking Entry ---\n" RESET);
 
-    ParkingLot_logOut(silentMode, YELLOW "Owner Name: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Owner Name: " RESET); 
     std::getline(std::cin, ownerName);
 
-    ParkingLot_logOut(silentMode, YELLOW "License Plate: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "License Plate: " RESET); 
     std::getline(std::cin, licensePlate);
 
-    ParkingLot_logOut(silentMode, YELLOW "Car Model: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Car Model: " RESET); 
     std::getline(std::cin, model);
 
-    ParkingLot_logOut(silentMode, YELLOW "Color: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Color: " RESET); 
     std::getline(std::cin, color);
 
-    ParkingLot_logOut(silentMode, YELLOW "Fuel Type: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Fuel Type: " RESET); 
     std::getline(std::cin, fuelType);
 
     // PHONE VALIDATION - Only digits allowed
     while (true) {
-        ParkingLot_logOut(silentMode, YELLOW "Phone: " RESET);
+        ParkingLot_logOut(*output, YELLOW "Phone: " RESET);
         std::getline(std::cin, phone);
         bool valid = !phone.empty() && std::all_of(phone.begin(), phone.end(), ::isdigit);
         if (valid) break;
-        std::cout << RED << "Invalid input! Please enter a number.\n" << RESET;
+        ParkingLot_logOut(*output, RED "Invalid input! Please enter a number.\n" RESET);
     }
 
     // EMAIL VALIDATION - Must contain '@'
     while (true) {
-        ParkingLot_logOut(silentMode, YELLOW "Email: " RESET);
+        ParkingLot_logOut(*output, YELLOW "Email: " RESET);
         std::getline(std::cin, email);
         if (email.find('@') != std::string::npos) break;
-        std::cout << RED << "Invalid email! Please include '@'.\n" << RESET;
+        ParkingLot_logOut(*output, RED "Invalid email! Please include '@'.\n" RESET);
     }
 
-    ParkingLot_logOut(silentMode, YELLOW "Membership: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Membership: " RESET); 
     std::getline(std::cin, membership);
 
-    ParkingLot_logOut(silentMode, YELLOW "Payment Method: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Payment Method: " RESET); 
     std::getline(std::cin, paymentMethod);
 
-    ParkingLot_logOut(silentMode, YELLOW "Slot: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Slot: " RESET); 
     std::getline(std::cin, slot);
 
-    ParkingLot_logOut(silentMode, YELLOW "Slot Size: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Slot Size: " RESET); 
     std::getline(std::cin, slotSize);
 
     // RESERVED SLOT VALIDATION - Only y/n allowed
     while (true) {
-        ParkingLot_logOut(silentMode, YELLOW "Reserved Slot? (y/n): " RESET);
+        ParkingLot_logOut(*output, YELLOW "Reserved Slot? (y/n): " RESET);
         std::cin >> reservedChoice;
         if (reservedChoice == 'y' || reservedChoice == 'Y' || reservedChoice == 'n' || reservedChoice == 'N') {
             reservedSlot = (reservedChoice == 'y' || reservedChoice == 'Y');
             break;
         }
-        std::cout << RED << "Invalid choice! Enter only y or n.\n" << RESET;
+        ParkingLot_logOut(*output, RED "Invalid choice! Enter only y or n.\n" RESET);
     }
     std::cin.ignore();
 
-    ParkingLot_logOut(silentMode, YELLOW "Exit Gate: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Exit Gate: " RESET); 
     std::getline(std::cin, exitGate);
 
-    ParkingLot_logOut(silentMode, YELLOW "Hourly Rate: " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Hourly Rate: " RESET); 
     std::cin >> hourlyRate;
 
-    ParkingLot_logOut(silentMode, YELLOW "Dynamic Pricing? (y/n): " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Dynamic Pricing? (y/n): " RESET); 
     std::cin >> dynamicChoice;
     dynamicPricing = (dynamicChoice == 'y' || dynamicChoice == 'Y');
 
-    ParkingLot_logOut(silentMode, YELLOW "Parking Duration (hours, enter 0 for current time): " RESET); 
+    ParkingLot_logOut(*output, YELLOW "Parking Duration (hours, enter 0 for current time): " RESET); 
     std::cin >> parkingHours;
     std::cin.ignore();
 
-    Car car(nextCarID++, ownerName, licensePlate, model, color, fuelType,
-            phone, email, membership, paymentMethod, slot, slotSize,
-            reservedSlot, exitGate, hourlyRate, dynamicPricing);
+    AdmissionRequest request;
+    request.ownerName = ownerName;
+    request.licensePlate = licensePlate;
+    request.model = model;
+    request.color = color;
+    request.fuelType = fuelType;
+    request.phone = phone;
+    request.email = email;
+    request.membership = membership;
+    request.paymentMethod = paymentMethod;
+    request.slot = slot;
+    request.slotSize = slotSize;
+    request.reservedSlot = reservedSlot;
+    request.exitGate = exitGate;
+    request.hourlyRate = hourlyRate;
+    request.dynamicPricing = dynamicPricing;
+    request.parkingHours = parkingHours;
+    admit(request);
+}
+
+/**
+ * @brief Admits a car described by a complete request, without prompting.
+ *
+ * Refuses the car if no slot of its size is free. Dynamic pricing applies the current surge
+ * multiplier to the hourly rate, and a positive parking duration backdates the entry time.
+ */
+int ParkingLot::admit(const AdmissionRequest& request) {
+    ScopedLatency timer(latencyFor(LotOperation::Park));
+    TRACE_SPAN("gate.park");
+    const SlotClass slotClass = slotClassOf(request.slotSize);
+    if (!hasRoomFor(slotClass)) {
+        ParkingLot_logOut(*output, RED "❌ No free slot available for this slot size.\n" RESET);
+        LotMetrics::add(metrics.refusals);
+        if (logger) logger->log(LogLevel::Warn, "Admission refused: no free {} slot for {}", request.slotSize, request.licensePlate);
+        return 0;
+    }
+
+    double hourlyRate = request.hourlyRate;
+    if (request.dynamicPricing) {
+        hourlyRate *= currentSurgeMultiplier(request.slotSize);
+    }
+
+    Car car(nextCarID++, request.ownerName, request.licensePlate, request.model, request.color, request.fuelType,
+            request.phone, request.email, request.membership, request.paymentMethod, request.slot, request.slotSize,
+            request.reservedSlot, request.exitGate, hourlyRate, request.dynamicPricing);
 
-    if (parkingHours > 0.0) {
+    if (request.parkingHours > 0.0) {
         auto now = std::chrono::system_clock::now();
         car.parkingTime = now - std::chrono::duration_cast<std::chrono::system_clock::duration>(
-                                  std::chrono::duration<double>(parkingHours * 3600.0));
+                                  std::chrono::duration<double>(request.parkingHours * 3600.0));
     }
 
-    if (cars.size() < MAX_CAPACITY) {
-        cars.push_back(std::move(car));
-        if (!silentMode) {
-            saveCarToCSV(cars.back());
-        }
-        ParkingLot_logOut(silentMode, GREEN "✅ Car parked successfully! and Ticket is Generated\n" RESET);
+    insertCar(car);
+    LotMetrics::add(metrics.admissions);
+    if (persistenceEnabled) {
+        saveCarToCSV(cars.back());
     }
+    if (logger) logger->log(LogLevel::Info, "Car {} parked: owner {}, plate {}, slot {} ({}), rate {}",
+                            car.id, car.ownerName, car.licensePlate, car.slot, car.slotSize, cars.back().hourlyRate);
+    ParkingLot_logOut(*output, GREEN "✅ Car parked successfully! and Ticket is Generated\n" RESET);
+    return car.id;
 }
 
 
@@ -211,13 +419,15 @@ void ParkingLot::parkCar() {
 void ParkingLot::removeCar() {
     int carID;
     std::string ownerName;
-    ParkingLot_logOut(silentMode, CYAN "\n--- Car Removal ---\n" RESET);
-    ParkingLot_logOut(silentMode, "Enter Car ID: "); std::cin >> carID;
+    ParkingLot_logOut(*output, CYAN "\n--- Car Removal ---\n" RESET);
+    ParkingLot_logOut(*output, "Enter Car ID: "); std::cin >> carID;
     std::cin.ignore();
-    ParkingLot_logOut(silentMode, "Enter Owner Name: "); std::getline(std::cin, ownerName);
+    ParkingLot_logOut(*output, "Enter Owner Name: "); std::getline(std::cin, ownerName);
 
-    if (!removeCarByIdAndOwner(carID, ownerName))
-        ParkingLot_logOut(silentMode, RED "❌ Car not found or owner mismatch.\n" RESET);
+    if (!removeCarByIdAndOwner(carID, ownerName)) {
+        ParkingLot_logOut(*output, RED "❌ Car not found or owner mismatch.\n" RESET);
+        if (logger) logger->log(LogLevel::Warn, "Removal refused: no car {} owned by {}", carID, ownerName);
+    }
 }
 
 /**
@@ -228,30 +438,33 @@ void ParkingLot::removeCar() {
  * showing details such as ID, owner, license plate, model, color, fuel type,
  * slot, slot size, hourly rate, and whether dynamic pricing is enabled.
  *
- * @note Output is sent via ParkingLot_logOut, respecting the silentMode setting.
+ * @note The table is built and written in one piece, and not built at all when the output sink is disabled.
  */
 void ParkingLot::displayCars() const {
+    if (!output->enabled()) return;
     if (cars.empty()) {
-        ParkingLot_logOut(silentMode, YELLOW "No cars parked.\n" RESET);
+        ParkingLot_logOut(*output, YELLOW "No cars parked.\n" RESET);
         return;
     }
-    ParkingLot_logOut(silentMode, CYAN "ID\tOwner\tPlate\tModel\tColor\tFuel\tSlot\tSize\tRate\tDyn?\n" RESET);
+    std::ostringstream table;
+    table << CYAN "ID\tOwner\tPlate\tModel\tColor\tFuel\tSlot\tSize\tRate\tDyn?\n" RESET;
     for (const auto& car : cars) {
-        std::ostringstream row;
-        row << car.id << '\t' << car.ownerName << '\t' << car.licensePlate << '\t'
-            << car.model << '\t' << car.color << '\t' << car.fuelType << '\t'
-            << car.slot << '\t' << car.slotSize << '\t'
-            << car.hourlyRate << '\t' << (car.dynamicPricing ? "Yes" : "No") << '\n';
-        ParkingLot_logOut(silentMode, row.str());
+        table << car.id << '\t' << car.ownerName << '\t' << car.licensePlate << '\t'
+              << car.model << '\t' << car.color << '\t' << car.fuelType << '\t'
+              << car.slot << '\t' << car.slotSize << '\t'
+              << car.hourlyRate << '\t' << (car.dynamicPricing ? "Yes" : "No") << '\n';
     }
+    output->write(table.str());
 }
 
 /**
  * @brief Removes a car from the parking lot by its ID and owner name, and generates a detailed bill.
  *
  * Searches for a car in the parking lot matching the specified ID and owner name.
- * If found, calculates the total hours parked, applies dynamic pricing and discounts if applicable,
- * computes GST, and generates a formatted bill. The bill is logged and saved unless silent mode is enabled.
+ * If found, computes the itemised charge with calculateFeeBreakdown and, unless silent mode is enabled,
+ * renders the bill into the lot's reusable BillRenderer buffer and prints it. If persistence is
+ * enabled it records the text bill (if enabled), the structured bill record and the departure in
+ * the storage backend.
  * Finally, removes the car from the lot.
  *
  * @param id The unique identifier of the car to be removed.
@@ -259,46 +472,46 @@ void ParkingLot::displayCars() const {
  * @return true if the car was found, billed, and removed; false if no matching car was found.
  */
 bool ParkingLot::removeCarByIdAndOwner(const int id, const std::string& owner) {
-    auto it = std::find_if(cars.begin(), cars.end(),
-        [&](const Car& c) { return c.id == id && c.ownerName == owner; });
+    ScopedLatency timer(latencyFor(LotOperation::Remove));
+    TRACE_SPAN("gate.remove");
+    auto it = cars.end();
+    {
+        TRACE_SPAN("remove.lookup");
+        it = std::find_if(cars.begin(), cars.end(),
+            [&](const Car& c) { return c.id == id && c.ownerName == owner; });
+    }
 
     if (it == cars.end()) return false;
 
-    using namespace std::chrono;
-    const double hours = std::max(0.0, duration_cast<std::chrono::minutes>(
-        system_clock::now() - it->parkingTime).count() / 60.0);
+    const auto removedAt = std::chrono::system_clock::now();
+    const FeeBreakdown fee = calculateFeeBreakdown(*it, removedAt);
 
-    double gross = hours * it->hourlyRate;
-    double discount = 0.0, gst = 0.0;
-
-    if (it->dynamicPricing) {
-        if (hours > 5.0) {
-            discount = gross * 0.30;
-            gross -= discount;
-        }
-        gst = gross * 0.18;
+    if (output->enabled() || (persistenceEnabled && textBills)) {
+        TRACE_SPAN("bill.render");
+        billRenderer.render(*it, fee, billLayout);
     }
-    const double total = gross + gst;
-
-    std::ostringstream bill;
-    bill << "\n========= 🧾 PARKING BILL 🧾 =========\n"
-         << "Car ID            : " << it->id << "\n"
-         << "Owner Name        : " << it->ownerName << "\n"
-         << "License Plate     : " << it->licensePlate << "\n"
-         << "Hours Parked      : " << std::fixed << std::setprecision(2) << hours << "\n"
-         << "Rate per Hour (₹) : " << it->hourlyRate << "\n"
-         << "Gross (₹)         : " << (hours * it->hourlyRate) << "\n";
-    if (discount > 0) bill << "Discount (30%)    : -" << discount << "\n";
-    bill << "GST @ 18% (₹)     : " << gst << "\n"
-         << "TOTAL (₹)         : " << total << "\n"
-         << "======================================\n";
-
-    if (!silentMode) {
-        ParkingLot_logOut(silentMode, bill.str());
-        saveBillToText(bill.str());
+    if (output->enabled()) {
+        TRACE_SPAN("bill.print");
+        output->write(billRenderer.data(), billRenderer.size());
+    }
+    if (persistenceEnabled) {
+        if (textBills) saveBillToText(billRenderer.data(), billRenderer.size());
+        saveBillRecord(*it, fee, removedAt);
+        saveDepartureToCSV(*it, removedAt);
     }
 
+    LotMetrics::add(metrics.departures);
+    LotMetrics::add(metrics.bills);
+    LotMetrics::add(metrics.revenueCents, static_cast<std::uint64_t>(std::llround(std::max(0.0, fee.total) * 100.0)));
+    if (logger) logger->log(LogLevel::Info, "Car {} removed: owner {}, fee {}", it->id, it->ownerName, fee.total);
+    if (eventLog) {
+        TRACE_SPAN("eventlog.append");
+        eventLog->appendDeparture(it->id);
+    }
+    quoteCache.erase(it->id);
+    trackDeparture(*it);
     cars.erase(it);
+    noteLoggedEvent();
     return true;
 }
 
@@ -312,6 +525,8 @@ bool ParkingLot::removeCarByIdAndOwner(const int id, const std::string& owner) {
  * @return Car The car with the specified ID if found; otherwise, a default Car object.
  */
 Car ParkingLot::getCarByID(const int id) const {
+    ScopedLatency timer(latencyFor(LotOperation::Lookup));
+    TRACE_SPAN("gate.lookup");
     auto it = std::find_if(cars.begin(), cars.end(),
         [id](const Car& car) { return car.id == id; });
     return (it != cars.end()) ? *it : Car();
@@ -324,42 +539,227 @@ size_t ParkingLot::getCarCount() const {
 /**
  * @brief Calculates the total parking fee for a given car based on parking duration, hourly rate, dynamic pricing, and GST.
  * 
- * This method computes the parking fee by determining the number of hours the car has been parked,
- * applying the hourly rate, and then adjusting for dynamic pricing discounts and GST if applicable.
- * If dynamic pricing is enabled and the parking duration exceeds 5 hours, a 30% discount is applied before GST.
- * GST is calculated at 18% on the subtotal after any discount.
+ * This method computes the parking fee for a car leaving now; see calculateFeeBreakdown for the rules.
  * 
  * @param car Reference to a Car object containing parking time, hourly rate, and dynamic pricing flag.
  * @return The total fee to be charged for the car's parking session, including any discounts and GST.
  */
 double ParkingLot::calculateFee(const Car& car) const {
+    ScopedLatency timer(latencyFor(LotOperation::Fee));
+    return calculateFeeBreakdown(car, std::chrono::system_clock::now()).total;
+}
+
+double ParkingLot::calculateFee(const Car& car, const std::chrono::system_clock::time_point exitTime) const {
+    ScopedLatency timer(latencyFor(LotOperation::Fee));
+    return calculateFeeBreakdown(car, exitTime).total;
+}
+
+/**
+ * @brief Computes the itemised charge for a car's stay up to the given exit time.
+ * 
+ * The hours parked are counted in whole minutes. The gross charge is the hourly rate multiplied by
+ * the tariff calendar's weighted hours for the stay, which equal the hours parked when no bands are
+ * configured. If dynamic pricing is enabled and the stay exceeds 5 hours, a 30% discount is applied
+ * before GST, which is calculated at 18% on the subtotal after any discount.
+ * 
+ * @param car Reference to a Car object containing parking time, hourly rate, and dynamic pricing flag.
+ * @param exitTime The time the car leaves the lot.
+ * @return The hours, gross, discount, GST and total for the stay.
+ */
+FeeBreakdown ParkingLot::calculateFeeBreakdown(const Car& car,
+                                               const std::chrono::system_clock::time_point exitTime) const {
+    TRACE_SPAN("fee.calculate");
     using namespace std::chrono;
-    auto now = system_clock::now();
-    auto duration = now - car.parkingTime;
-    double hours = std::max(0.0, duration_cast<std::chrono::minutes>(duration).count() / 60.0);
+    FeeBreakdown fee;
+    fee.hours = std::max(0.0, duration_cast<std::chrono::minutes>(exitTime - car.parkingTime).count() / 60.0);
+    fee.rate = car.hourlyRate;
+    fee.gross = car.hourlyRate * tariff.weightedHours(car.parkingTime, exitTime);
 
-    double subtotal = hours * car.hourlyRate;
-    double discount = 0.0, gst = 0.0;
+    double subtotal = fee.gross;
     if (car.dynamicPricing) {
-        if (hours > 5.0) {
-            discount = subtotal * 0.30;
-            subtotal -= discount;
+        if (fee.hours > 5.0) {
+            fee.discount = subtotal * 0.30;
+            subtotal -= fee.discount;
         }
-        gst = subtotal * 0.18;
+        fee.gst = subtotal * 0.18;
+    }
+    fee.total = subtotal + fee.gst;
+    return fee;
+}
+
+double ParkingLot::quoteFee(const int id) {
+    return quoteFee(id, std::chrono::system_clock::now());
+}
+
+/**
+ * @brief Quotes a parked car's fee, reusing the previous quote while the billing minute is unchanged.
+ *
+ * The fee depends only on the car's entry time and the number of whole minutes elapsed, so a cached
+ * entry stays valid until the elapsed minute count moves on. A cache hit therefore costs one hash
+ * lookup; a miss looks the car up and runs calculateFeeBreakdown.
+ *
+ * @param id The unique identifier of the car.
+ * @param at The hypothetical exit time.
+ * @return The fee due, or -1 if no car with that ID is parked.
+ */
+double ParkingLot::quoteFee(const int id, const std::chrono::system_clock::time_point at) {
+    using namespace std::chrono;
+    auto cached = quoteCache.find(id);
+    if (cached != quoteCache.end() &&
+        duration_cast<minutes>(at - cached->second.parkingTime).count() == cached->second.minutesParked) {
+        ++quoteHits;
+        return cached->second.fee;
     }
-    return subtotal + gst;
+
+    auto it = std::find_if(cars.begin(), cars.end(),
+        [id](const Car& car) { return car.id == id; });
+    if (it == cars.end()) return -1.0;
+
+    ++quoteMisses;
+    CachedQuote quote;
+    quote.parkingTime = it->parkingTime;
+    quote.minutesParked = duration_cast<minutes>(at - it->parkingTime).count();
+    quote.fee = calculateFee(*it, at);
+    quoteCache[id] = quote;
+    return quote.fee;
 }
 
 /**
  * @brief Attempts to add a car to the parking lot if there is available capacity.
  * 
- * If the current number of cars is less than the maximum allowed capacity,
- * the provided car is added to the parking lot's collection.
+ * If the car has a valid (positive) ID and both the lot and the car's slot class have a free slot,
+ * the provided car is added to the parking lot's collection and the occupancy counters are updated.
+ * No surge pricing is applied; the car is stored exactly as given.
  * 
  * @param car The Car object to be added to the parking lot.
  */
 void ParkingLot::testAddCar(const Car& car) {
-    if (cars.size() < MAX_CAPACITY) {
-        cars.push_back(car);
+    if (car.id > 0 && hasRoomFor(slotClassOf(car.slotSize))) {
+        insertCar(car);
+        LotMetrics::add(metrics.admissions);
+    }
+}
+
+void ParkingLot::insertCar(Car car) {
+    advanceNextCarID(car.id);
+    trackAdmission(car);
+    cars.push_back(std::move(car));
+    if (eventLog) eventLog->appendAdmission(cars.back());
+    noteLoggedEvent();
+}
+
+void ParkingLot::restoreCar(Car car) {
+    insertCar(std::move(car));
+}
+
+/**
+ * @brief Loads the latest snapshot, replays the log tail into the lot and keeps the log open for further events.
+ *
+ * Snapshot cars, admissions and departures are folded into a map keyed by car ID, so the cost of
+ * recovery is linear in the size of the snapshot plus the records logged since it, however many
+ * cars have left over the lot's history. Records whose sequence number the snapshot already covers
+ * are skipped. The surviving cars are then restored in ID order, which is the order they were
+ * admitted in. A log or snapshot whose header or checksum is not recognised is moved aside to
+ * "<file>.corrupt" so it is never overwritten.
+ *
+ * @param path Path of the log file.
+ * @return The number of cars restored.
+ */
+size_t ParkingLot::openEventLog(const std::string& path) {
+    waitForCheckpoint();
+    eventLog.reset();
+    eventLogPath = path;
+    eventsSinceCheckpoint = 0;
+
+    const std::string snapshotPath = path + ".snap";
+    SnapshotState snapshot;
+    if (readSnapshot(snapshotPath, snapshot) == SnapshotStatus::Corrupt)
+        std::rename(snapshotPath.c_str(), (snapshotPath + ".corrupt").c_str());
+
+    std::unordered_map<int, Car> live;
+    int maxId = snapshot.nextCarID - 1;
+    for (Car& car : snapshot.cars) {
+        const int id = car.id;
+        live[id] = std::move(car);
+    }
+
+    const std::uint64_t snapshotLsn = snapshot.lsn;
+    std::uint64_t lastLsn = snapshotLsn;
+    const std::string logs[] = { path + ".old", path };
+    for (const std::string& log : logs) {
+        const ReplayStats stats = EventLog::replay(log, [&live, &maxId, snapshotLsn](const LogEvent& event) {
+            if (event.lsn <= snapshotLsn) return;
+            // Departed cars count too, so a restart never reissues their tickets
+            maxId = std::max(maxId, event.car.id);
+            if (event.type == LogEventType::Admission)
+                live[event.car.id] = event.car;
+            else
+                live.erase(event.car.id);
+        }, true);
+        if (stats.badHeader)
+            std::rename(log.c_str(), (log + ".corrupt").c_str());
+        lastLsn = std::max(lastLsn, stats.lastLsn);
+    }
+
+    std::vector<Car> restored;
+    restored.reserve(live.size());
+    for (auto& entry : live) restored.push_back(std::move(entry.second));
+    std::sort(restored.begin(), restored.end(),
+              [](const Car& a, const Car& b) { return a.id < b.id; });
+
+    cars.reserve(cars.size() + restored.size());
+    for (Car& car : restored) restoreCar(std::move(car));
+    advanceNextCarID(maxId);
+
+    eventLog.reset(new EventLog(path, lastLsn + 1));
+    return restored.size();
+}
+
+/**
+ * @brief Writes a snapshot and, once it is durable, deletes the log it supersedes. Runs on the checkpoint thread.
+ */
+static void writeCheckpoint(const std::string& snapshotPath, const std::string& retiredPath,
+                            const SnapshotState& state) {
+    if (writeSnapshot(snapshotPath, state))
+        std::remove(retiredPath.c_str());
+}
+
+/**
+ * @brief Rotates the event log and starts writing a snapshot of the current state in the background.
+ *
+ * The only work done on the caller's thread is copying the parked cars and renaming the log. If a
+ * retired log is still present because an earlier snapshot never completed, it is not rotated again:
+ * the new snapshot covers both logs, and the live log's already-covered records are skipped on replay.
+ *
+ * @return False if no event log is open.
+ */
+bool ParkingLot::checkpoint() {
+    if (!eventLog) return false;
+    waitForCheckpoint();
+    eventLog->flush();
+
+    SnapshotState state;
+    state.lsn = eventLog->getLastLsn();
+    state.nextCarID = nextCarID;
+    state.cars = cars;
+
+    const std::string retiredPath = eventLogPath + ".old";
+    if (::access(retiredPath.c_str(), F_OK) != 0) {
+        eventLog.reset();
+        std::rename(eventLogPath.c_str(), retiredPath.c_str());
+        eventLog.reset(new EventLog(eventLogPath, state.lsn + 1));
     }
+    eventsSinceCheckpoint = 0;
+    if (logger) logger->log(LogLevel::Info, "Checkpoint at LSN {}: {} parked car(s)", state.lsn, state.cars.size());
+    checkpointThread = std::thread(writeCheckpoint, eventLogPath + ".snap", retiredPath, std::move(state));
+    return true;
+}
+
+void ParkingLot::waitForCheckpoint() {
+    if (checkpointThread.joinable()) checkpointThread.join();
+}
+
+void ParkingLot::noteLoggedEvent() {
+    if (eventLog && checkpointInterval > 0 && ++eventsSinceCheckpoint >= checkpointInterval)
+        checkpoint();
 }
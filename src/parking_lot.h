@@ -3,7 +3,64 @@
 #include <string>
 #include <iostream>
 #include "car.h"
+#include "pricing.h"
+#include "bill_renderer.h"
+#include "bill_record.h"
+#include "journal_writer.h"
+#include "event_log.h"
+#include "snapshot.h"
+#include "persistence_queue.h"
+#include "latency_histogram.h"
+#include "lot_metrics.h"
+#include "storage_backend.h"
+#include "output_sink.h"
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+class Logger;
+
+/**
+ * @struct AdmissionRequest
+ * @brief Everything needed to admit a car, as entered at the gate.
+ */
+struct AdmissionRequest {
+    std::string ownerName;
+    std::string licensePlate;
+    std::string model;
+    std::string color;
+    std::string fuelType;
+    std::string phone;
+    std::string email;
+    std::string membership;
+    std::string paymentMethod;
+    std::string slot;
+    std::string slotSize;
+    bool reservedSlot = false;
+    std::string exitGate;
+    double hourlyRate = 50.0;     ///< Base rate per hour, before any surge multiplier.
+    bool dynamicPricing = false;
+    double parkingHours = 0.0;    ///< Hours the car has already been parked; 0 for now.
+};
+
+/**
+ * @brief Lot operations whose latency can be tracked.
+ */
+enum class LotOperation {
+    Park,    ///< parkCar, from the end of input to the car being admitted.
+    Remove,  ///< removeCarByIdAndOwner, including billing and persistence.
+    Lookup,  ///< getCarByID.
+    Fee      ///< calculateFee.
+};
+
+/**
+ * @brief Number of LotOperation values.
+ */
+constexpr std::size_t LOT_OPERATION_COUNT = 4;
 
 /**
  * @class ParkingLot
@@ -26,26 +83,444 @@ private:
     int nextCarID;
 
     /**
-     * @brief The maximum number of cars that can be parked in the lot.
+     * @brief The default number of cars that can be parked in the lot.
      */
     static constexpr int MAX_CAPACITY = 100;
 
     /**
-     * @brief If true, suppresses output and notifications for silent operation.
+     * @brief The number of cars this lot can hold in total.
+     */
+    size_t capacity;
+
+    /**
+     * @brief Live count of parked cars per slot class, kept in step with every admission and departure.
+     */
+    std::array<size_t, SLOT_CLASS_COUNT> occupancy;
+
+    /**
+     * @brief Number of slots available per slot class; defaults to the whole lot capacity.
      */
-    bool silentMode = false;
+    std::array<size_t, SLOT_CLASS_COUNT> slotCapacity;
+
+    /**
+     * @brief Maps slot-class utilization to the multiplier applied to dynamically priced cars at admission.
+     */
+    SurgeCurve surgeCurve;
+
+    /**
+     * @brief Weekly rate bands applied to every stay when computing fees.
+     */
+    TariffCalendar tariff;
+
+    /**
+     * @brief Reusable formatter for departure bills, so billing does not allocate per car.
+     */
+    BillRenderer billRenderer;
+
+    /**
+     * @brief Layout used for bills shown at the gate and saved to the bill history.
+     */
+    BillRenderer::Layout billLayout = BillRenderer::Layout::Human;
+
+    /**
+     * @brief If true, the rendered text bill is appended to bill_history.txt as well as the structured record.
+     */
+    bool textBills = true;
+
+    /**
+     * @struct CachedQuote
+     * @brief A fee quote remembered for one parked car.
+     */
+    struct CachedQuote {
+        std::chrono::system_clock::time_point parkingTime;  ///< Entry time of the quoted car.
+        long long minutesParked;                            ///< Billing-minute bucket the fee was computed for.
+        double fee;                                         ///< The quoted total.
+    };
+
+    /**
+     * @brief Fee quotes keyed by car ID. An entry is reused while the car's elapsed whole minutes
+     *        are unchanged, and dropped on departure or tariff change.
+     */
+    std::unordered_map<int, CachedQuote> quoteCache;
+
+    /**
+     * @brief Number of quotes answered from the cache and number computed from scratch.
+     */
+    size_t quoteHits = 0, quoteMisses = 0;
+
+    /**
+     * @brief Receives prompts, messages, tables and bills; never null.
+     */
+    OutputSink* output = &consoleOutput();
+
+    /**
+     * @brief If true, admissions, departures and bills are recorded in the storage backend.
+     */
+    bool persistenceEnabled = true;
+
+    /**
+     * @brief Leveled logger receiving admissions, departures and refusals; null to log nothing.
+     */
+    Logger* logger = nullptr;
+
+    /**
+     * @brief Occupancy, throughput, revenue and queue-depth counters, updated inline and readable from other threads.
+     */
+    LotMetrics metrics;
+
+    /**
+     * @brief Latency of each LotOperation, recorded while latency tracking is on.
+     */
+    mutable std::array<LatencyHistogram, LOT_OPERATION_COUNT> latencies;
+
+    /**
+     * @brief If true, park, remove, lookup and fee operations record their latency.
+     */
+    bool latencyTracking = false;
+
+    /**
+     * @brief Returns the histogram an operation records into, or null while tracking is off.
+     */
+    LatencyHistogram* latencyFor(LotOperation op) const {
+        return latencyTracking ? &latencies[static_cast<size_t>(op)] : nullptr;
+    }
+
+    /**
+     * @brief Where admissions, departures and bills are recorded.
+     */
+    std::unique_ptr<StorageBackend> storage;
+
+    /**
+     * @brief Background I/O thread that performs journal appends when asynchronous persistence is
+     *        enabled. Declared after the storage backend so it is drained before its journals are closed.
+     */
+    std::unique_ptr<PersistenceQueue> persistence;
+
+    /**
+     * @brief Write-ahead log of admissions and departures, if one has been opened.
+     */
+    std::unique_ptr<EventLog> eventLog;
+
+    /**
+     * @brief Path of the open event log; its snapshot lives at "<path>.snap" and its retired log at "<path>.old".
+     */
+    std::string eventLogPath;
+
+    /**
+     * @brief Number of logged events after which a checkpoint is taken automatically; 0 disables it.
+     */
+    size_t checkpointInterval = 10000;
+
+    /**
+     * @brief Number of events logged since the last checkpoint.
+     */
+    size_t eventsSinceCheckpoint = 0;
+
+    /**
+     * @brief Background thread writing the most recent snapshot, if one is in progress.
+     */
+    std::thread checkpointThread;
+
+    /**
+     * @brief Counts a logged event and takes a checkpoint when the interval is reached.
+     */
+    void noteLoggedEvent();
+
+    /**
+     * @brief Adds a car to the list of parked cars, updating counters, the next car ID and the event log.
+     * @param car The car entering the lot.
+     */
+    void insertCar(Car car);
+
+    /**
+     * @brief Checks whether one more car of the given slot class fits in the lot.
+     * @param cls The slot class of the arriving car.
+     * @return True if both the lot and the slot class have a free slot.
+     */
+    bool hasRoomFor(SlotClass cls) const;
+
+    /**
+     * @brief Updates the occupancy counters for a car entering the lot.
+     * @param car The car being admitted.
+     */
+    void trackAdmission(const Car& car);
+
+    /**
+     * @brief Updates the occupancy counters for a car leaving the lot.
+     * @param car The car departing.
+     */
+    void trackDeparture(const Car& car);
 
 public:
     /**
      * @brief Constructs a new ParkingLot object, initializing internal state.
+     * @param capacity The total number of cars the lot can hold.
+     */
+    explicit ParkingLot(size_t capacity = MAX_CAPACITY);
+
+    /**
+     * @brief Constructs a ParkingLot that records admissions, departures and bills in the given backend
+     *        instead of the CSV and text files.
+     * @param backend The storage backend, e.g. from makeStorageBackend; the lot takes ownership.
+     * @param capacity The total number of cars the lot can hold.
+     */
+    explicit ParkingLot(std::unique_ptr<StorageBackend> backend, size_t capacity = MAX_CAPACITY);
+
+    /**
+     * @brief Waits for any background checkpoint to finish.
+     */
+    ~ParkingLot();
+
+    /**
+     * @brief Sets how many slots exist for a slot class.
+     *
+     * Admission into a full slot class is refused, and the class's utilization drives surge pricing.
+     *
+     * @param cls The slot class to configure.
+     * @param slots The number of slots of that class.
+     */
+    void setSlotCapacity(SlotClass cls, size_t slots) {
+        slotCapacity[static_cast<size_t>(cls)] = slots;
+        LotMetrics::set(metrics.slotCapacity[static_cast<size_t>(cls)], slots);
+    }
+
+    /**
+     * @brief Replaces the surge pricing curve used at admission.
+     * @param curve The new utilization-to-multiplier curve.
+     */
+    void setSurgeCurve(const SurgeCurve& curve) { surgeCurve = curve; }
+
+    /**
+     * @brief Gets the number of cars currently parked in a slot class. O(1).
+     * @param cls The slot class to query.
+     * @return The number of occupied slots of that class.
+     */
+    size_t getOccupancy(SlotClass cls) const { return occupancy[static_cast<size_t>(cls)]; }
+
+    /**
+     * @brief Gets the live utilization of a slot class. O(1).
+     * @param cls The slot class to query.
+     * @return Occupied slots divided by available slots, in [0,1]; 1 if the class has no slots.
+     */
+    double getUtilization(SlotClass cls) const;
+
+    /**
+     * @brief Gets the surge multiplier an arriving dynamically priced car would receive right now. O(1).
+     * @param slotSize The slot size of the arriving car.
+     * @return The multiplier applied to its hourly rate.
+     */
+    double currentSurgeMultiplier(const std::string& slotSize) const;
+
+    /**
+     * @brief Replaces the weekly tariff calendar used for all fee calculations.
+     * @param calendar The new calendar of time-of-day and day-of-week bands.
+     */
+    void setTariffCalendar(const TariffCalendar& calendar) { tariff = calendar; quoteCache.clear(); }
+
+    /**
+     * @brief Chooses between the decorated human bill and the compact one-line machine bill.
+     * @param layout The bill layout to use for subsequent departures.
+     */
+    void setBillLayout(BillRenderer::Layout layout) { billLayout = layout; }
+
+    /**
+     * @brief Chooses whether departures also append the text bill to bill_history.txt.
+     *
+     * The structured record in bill_records.bin is always written; the text bill is for people.
+     *
+     * @param enabled False to keep only the structured bill records.
      */
-    ParkingLot();
+    void setTextBills(bool enabled) { textBills = enabled; }
 
     /**
      * @brief Enables or disables silent mode for the parking lot.
+     *
+     * Silent mode sends output to the null sink and turns persistence off; leaving it sends output
+     * to the console again and turns persistence back on.
+     *
      * @param mode Set to true to suppress output, false to enable normal operation.
      */
-    void setSilentMode(bool mode) { silentMode = mode; }
+    void setSilentMode(bool mode) {
+        output = mode ? &nullOutput() : &consoleOutput();
+        persistenceEnabled = !mode;
+    }
+
+    /**
+     * @brief Sends the lot's prompts, messages, tables and bills to a sink.
+     * @param sink The sink, which must outlive the lot, or null to discard all output.
+     */
+    void setOutput(OutputSink* sink) { output = sink ? sink : &nullOutput(); }
+
+    /**
+     * @brief Gets the sink the lot writes its output to.
+     */
+    OutputSink& getOutput() const { return *output; }
+
+    /**
+     * @brief Chooses whether admissions, departures and bills are recorded in the storage backend.
+     *
+     * Silent mode turns persistence off, as it always has; call this afterwards to run a silent lot
+     * that still records, e.g. against a MemoryStorage backend.
+     *
+     * @param enabled False to record nothing.
+     */
+    void setPersistenceEnabled(bool enabled) { persistenceEnabled = enabled; }
+
+    /**
+     * @brief Routes the lot's operational messages through a logger.
+     * @param log The logger, which must outlive the lot, or null to log nothing.
+     */
+    void setLogger(Logger* log) { logger = log; }
+
+    /**
+     * @brief Gets the lot's live counters, e.g. for a MetricsExporter. Safe to read from any thread.
+     */
+    const LotMetrics& getMetrics() const { return metrics; }
+
+    /**
+     * @brief Switches latency tracking of park, remove, lookup and fee operations on or off.
+     *
+     * While off, each instrumented operation costs one branch. Recordings are kept when tracking
+     * is switched off and on again; see resetLatencies().
+     *
+     * @param enabled True to time every operation.
+     */
+    void setLatencyTracking(bool enabled) { latencyTracking = enabled; }
+
+    /**
+     * @brief Gets the latency histogram of an operation.
+     */
+    const LatencyHistogram& getLatency(LotOperation op) const { return latencies[static_cast<size_t>(op)]; }
+
+    /**
+     * @brief Discards every latency recording.
+     */
+    void resetLatencies();
+
+    /**
+     * @brief Writes count, p50, p99, p99.9, max and mean latency of each operation to a text file.
+     * @param path The file to write; replaced if it exists.
+     * @return False if the file could not be written.
+     */
+    bool dumpLatencies(const std::string& path) const;
+
+    /**
+     * @brief Gets the bytes, file opens and syscalls spent persisting one kind of record.
+     *
+     * With a backend that writes every kind to one file, each kind reports that file's counts.
+     */
+    IoStats getIoStats(StorageStream stream) const;
+
+    /**
+     * @brief Gets the I/O counts of every storage journal and the logger's journal, added together.
+     */
+    IoStats getTotalIoStats() const;
+
+    /**
+     * @brief Formats the I/O counts of each storage journal, the logger's journal and their total as a table.
+     */
+    std::string ioReport() const;
+
+    /**
+     * @brief Gets the backend that records admissions, departures and bills.
+     */
+    StorageBackend& getStorage() { return *storage; }
+
+    /**
+     * @brief Moves CSV and bill writes onto a background I/O thread so gate operations never wait on disk.
+     *
+     * Admissions and departures return as soon as the in-memory state is updated and the row is
+     * queued. The write-ahead log, if open, is still written synchronously since it is what makes
+     * the in-memory state recoverable. Calling again replaces the queue after draining the old one.
+     *
+     * @param options Queue capacity and the policy applied when it is full.
+     */
+    void enableAsyncPersistence(const PersistenceOptions& options = PersistenceOptions());
+
+    /**
+     * @brief Drains the persistence queue and returns to writing rows on the caller's thread.
+     */
+    void disableAsyncPersistence();
+
+    /**
+     * @brief Gets the traffic counters of the persistence queue; all zero when persistence is synchronous.
+     */
+    PersistenceStats getPersistenceStats() const;
+
+    /**
+     * @brief Sets the size and age thresholds at which buffered car, bill and departure rows are written out.
+     * @param options The flush thresholds for the storage backend's journals.
+     */
+    void setJournalOptions(const JournalOptions& options);
+
+    /**
+     * @brief Writes all queued and buffered car, bill and departure rows to disk now.
+     */
+    void flushJournals();
+
+    /**
+     * @brief Writes buffered car, bill and departure rows whose age threshold has passed. Cheap to call often.
+     */
+    void flushDueJournals();
+
+    /**
+     * @brief Rebuilds the lot from its latest snapshot and write-ahead log, and records all further
+     *        admissions and departures in the log.
+     *
+     * The snapshot at "<path>.snap" is loaded if present, then the retired log "<path>.old" and the
+     * live log are replayed, skipping records the snapshot already reflects; a record torn by a crash
+     * is cut off. Afterwards each admission and departure is appended to the log before the call that
+     * caused it returns. Intended to be called once, on an empty lot, at startup.
+     *
+     * @param path Path of the log file; created if it does not exist.
+     * @return The number of parked cars restored.
+     */
+    size_t openEventLog(const std::string& path);
+
+    /**
+     * @brief Snapshots the lot and compacts the event log without blocking the caller on disk.
+     *
+     * The live log is renamed to "<path>.old" and a fresh log continues the sequence numbers. A
+     * copy of the cars and ID counter is handed to a background thread, which durably writes the
+     * snapshot and then deletes the retired log. If the process dies first, recovery still finds
+     * the previous snapshot and the retired log. A checkpoint still running is waited for first.
+     *
+     * @return False if no event log is open.
+     */
+    bool checkpoint();
+
+    /**
+     * @brief Blocks until the background snapshot of the last checkpoint, if any, has been written.
+     */
+    void waitForCheckpoint();
+
+    /**
+     * @brief Sets how many logged events trigger an automatic checkpoint.
+     * @param events Number of admissions and departures between checkpoints; 0 disables automatic checkpoints.
+     */
+    void setCheckpointInterval(size_t events) { checkpointInterval = events; }
+
+    /**
+     * @brief Puts back a car recovered from persisted state.
+     *
+     * Unlike parkCar, no surge pricing or capacity limit is applied and nothing is written to the
+     * CSV or bill files, since the car is already physically in the lot. The occupancy counters and
+     * the next car ID are updated, and the car is recorded in the event log if one is open.
+     *
+     * @param car The recovered car, with its original ID and parking time.
+     */
+    void restoreCar(Car car);
+
+    /**
+     * @brief Gets the ID that will be assigned to the next car parked.
+     */
+    int getNextCarID() const { return nextCarID; }
+
+    /**
+     * @brief Ensures IDs up to and including usedId are never assigned to newly parked cars.
+     * @param usedId The highest car ID known to have been issued.
+     */
+    void advanceNextCarID(int usedId) { nextCarID = std::max(nextCarID, usedId + 1); }
 
     /**
      * @brief Parks a new car in the lot, assigning it a unique ID and storing its information.
@@ -55,6 +530,13 @@ public:
      */
     void parkCar();
 
+    /**
+     * @brief Admits a car without prompting, e.g. from a replayed or remote gate event.
+     * @param request The car's details.
+     * @return The ID assigned to the car, or 0 if no slot of its size was free.
+     */
+    int admit(const AdmissionRequest& request);
+
     /**
      * @brief Removes a car from the lot based on user input.
      *
@@ -71,17 +553,40 @@ public:
     void displayCars() const;
 
     /**
-     * @brief Saves the details of a car to a CSV file for record-keeping.
+     * @brief Records a car's admission in the storage backend (cars_data.csv with the CSV backend).
      * @param car The car whose information is to be saved.
      */
     void saveCarToCSV(const Car& car) const;
 
     /**
-     * @brief Saves a billing statement to a text file.
+     * @brief Records a departing car in the storage backend (Customer_details.csv with the CSV backend),
+     *        which startup uses to tell parked cars from departed ones.
+     * @param car The car leaving the lot.
+     * @param removedAt The time the car left.
+     */
+    void saveDepartureToCSV(const Car& car, std::chrono::system_clock::time_point removedAt) const;
+
+    /**
+     * @brief Records a billing statement in the storage backend (bill_history.txt with the CSV backend).
      * @param bill The billing information to be saved.
      */
     void saveBillToText(const std::string& bill) const;
 
+    /**
+     * @brief Records a billing statement held in a caller-owned buffer in the storage backend.
+     * @param bill Pointer to the bill text.
+     * @param length Length of the bill text in bytes.
+     */
+    void saveBillToText(const char* bill, size_t length) const;
+
+    /**
+     * @brief Records the structured form of a bill in the storage backend (bill_records.bin with the CSV backend).
+     * @param car The departing car.
+     * @param fee The itemised charge for its stay.
+     * @param exitTime The time the car left.
+     */
+    void saveBillRecord(const Car& car, const FeeBreakdown& fee, std::chrono::system_clock::time_point exitTime) const;
+
     /**
      * @brief Removes a car from the lot by its ID and owner's name.
      * @param id The unique identifier of the car to remove.
@@ -110,8 +615,62 @@ public:
      */
     double calculateFee(const Car& car) const;
 
+    /**
+     * @brief Calculates the parking fee for a car leaving at the given time.
+     * @param car The car for which to calculate the fee.
+     * @param exitTime The time the car leaves the lot.
+     * @return The calculated parking fee.
+     */
+    double calculateFee(const Car& car, std::chrono::system_clock::time_point exitTime) const;
+
+    /**
+     * @brief Calculates the itemised charge for a car leaving at the given time.
+     *
+     * The gross charge is the hourly rate times the tariff-weighted duration, computed in O(1)
+     * from the calendar's prefix sums; the long-stay discount and GST then apply to dynamically
+     * priced cars.
+     *
+     * @param car The car for which to calculate the fee.
+     * @param exitTime The time the car leaves the lot.
+     * @return Hours, gross, discount, GST and total for the stay.
+     */
+    FeeBreakdown calculateFeeBreakdown(const Car& car, std::chrono::system_clock::time_point exitTime) const;
+
+    /**
+     * @brief Quotes the fee a parked car would pay if it left now, for pay-at-kiosk screens.
+     * @param id The unique identifier of the car.
+     * @return The fee due, or -1 if no car with that ID is parked.
+     */
+    double quoteFee(int id);
+
+    /**
+     * @brief Quotes the fee a parked car would pay if it left at the given time.
+     *
+     * The fee only changes when another whole billing minute has elapsed, so quotes are cached per
+     * car and billing-minute bucket; repeated quotes within the same minute are a single hash lookup.
+     * The cache is invalidated when the car departs or the tariff calendar changes.
+     *
+     * @param id The unique identifier of the car.
+     * @param at The hypothetical exit time.
+     * @return The fee due, or -1 if no car with that ID is parked.
+     */
+    double quoteFee(int id, std::chrono::system_clock::time_point at);
+
+    /**
+     * @brief Gets the number of fee quotes served from the quote cache.
+     */
+    size_t getQuoteCacheHits() const { return quoteHits; }
+
+    /**
+     * @brief Gets the number of fee quotes that had to be computed.
+     */
+    size_t getQuoteCacheMisses() const { return quoteMisses; }
+
     /**
      * @brief Adds a car to the lot for testing purposes, bypassing user input.
+     *
+     * Cars with a non-positive ID, or that do not fit in the lot or their slot class, are ignored.
+     *
      * @param car The car object to add to the lot.
      */
     void testAddCar(const Car& car);
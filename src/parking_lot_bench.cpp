@@ -0,0 +1,612 @@
+#include "parking_lot.h"
+#include "bill_renderer.h"
+#include "bill_record.h"
+#include "gate_protocol.h"
+#include "logger.h"
+#include "lot_loader.h"
+#include "session_archive.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// =============================
+// 📌 Allocation counting
+// =============================
+/**
+ * @brief Number of calls to the global operator new since program start.
+ *
+ * The benchmark replaces the global allocation functions so that each scenario can report how
+ * many heap allocations it performed per operation.
+ */
+static std::atomic<unsigned long long> g_allocations(0);
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+/**
+ * @brief Receives a value derived from each benchmark's output so the work is not optimised away.
+ */
+static volatile std::size_t g_sink = 0;
+
+// =============================
+// 📌 Helpers
+// =============================
+/**
+ * @brief Creates a representative departing car for the billing benchmarks.
+ */
+static Car benchCar() {
+    Car car(1001, "Benchmark Owner", "MH12AB1234", "Model X", "Color",
+            "Petrol", "0000000000", "email@example.com", "None", "Cash",
+            "S1", "Medium", false, "Exit A", 60.0, true);
+    car.parkingTime = std::chrono::system_clock::now() - std::chrono::hours(6);
+    return car;
+}
+
+/**
+ * @brief Prints one result line: time per operation and heap allocations per operation.
+ */
+static void report(const char* name, const unsigned long long ops,
+                   const std::chrono::steady_clock::duration elapsed, const unsigned long long allocations) {
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(ops);
+    std::cout << std::left << std::setw(34) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1) << ns << " ns/op"
+              << std::setw(10) << std::setprecision(2)
+              << static_cast<double>(allocations) / static_cast<double>(ops) << " allocs/op\n";
+}
+
+// =============================
+// 📌 Benchmarks
+// =============================
+/**
+ * @brief Formats bills with std::ostringstream, the way removeCarByIdAndOwner used to.
+ */
+static void benchOstringstreamBill(const unsigned long long ops) {
+    ParkingLot lot;
+    const Car car = benchCar();
+    const FeeBreakdown fee = lot.calculateFeeBreakdown(car, std::chrono::system_clock::now());
+    std::size_t sink = 0;
+    const unsigned long long before = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < ops; ++i) {
+        std::ostringstream bill;
+        bill << "\n========= 🧾 PARKING BILL 🧾 =========\n"
+             << "Car ID            : " << car.id << "\n"
+             << "Owner Name        : " << car.ownerName << "\n"
+             << "License Plate     : " << car.licensePlate << "\n"
+             << "Hours Parked      : " << std::fixed << std::setprecision(2) << fee.hours << "\n"
+             << "Rate per Hour (₹) : " << fee.rate << "\n"
+             << "Gross (₹)         : " << fee.gross << "\n";
+        if (fee.discount > 0) bill << "Discount (30%)    : -" << fee.discount << "\n";
+        bill << "GST @ 18% (₹)     : " << fee.gst << "\n"
+             << "TOTAL (₹)         : " << fee.total << "\n"
+             << "======================================\n";
+        sink += bill.str().size();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    report("bill/ostringstream", ops, elapsed, g_allocations.load() - before);
+    g_sink = sink;
+}
+
+/**
+ * @brief Formats bills with the reusable BillRenderer in the given layout.
+ */
+static void benchRendererBill(const unsigned long long ops, const BillRenderer::Layout layout, const char* name) {
+    ParkingLot lot;
+    const Car car = benchCar();
+    const FeeBreakdown fee = lot.calculateFeeBreakdown(car, std::chrono::system_clock::now());
+    BillRenderer renderer;
+    std::size_t sink = 0;
+    const unsigned long long before = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < ops; ++i) {
+        renderer.render(car, fee, layout);
+        sink += renderer.size();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    report(name, ops, elapsed, g_allocations.load() - before);
+    g_sink = sink;
+}
+
+/**
+ * @brief Quotes the same parked car repeatedly, as a pay-at-kiosk screen does.
+ *
+ * With the cache, every quote after the first within the same billing minute is a hash lookup;
+ * the uncached variant recomputes the fee from scratch each time.
+ */
+static void benchKioskQuotes(const unsigned long long ops) {
+    ParkingLot lot;
+    lot.setSilentMode(true);
+    for (int i = 0; i < 100; ++i) {
+        Car car = benchCar();
+        car.id = 1001 + i;
+        lot.testAddCar(car);
+    }
+    const Car target = lot.getCarByID(1100);
+    const auto at = std::chrono::system_clock::now();
+    double sink = 0;
+
+    unsigned long long before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < ops; ++i)
+        sink += lot.calculateFee(target, at);
+    report("quote/calculateFee", ops, std::chrono::steady_clock::now() - start, g_allocations.load() - before);
+
+    before = g_allocations.load();
+    start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < ops; ++i)
+        sink += lot.quoteFee(1100, at);
+    report("quote/cached", ops, std::chrono::steady_clock::now() - start, g_allocations.load() - before);
+    g_sink = static_cast<std::size_t>(sink);
+}
+
+/**
+ * @brief Writes an event log with the given number of live sessions and times a full recovery.
+ *
+ * Half as many extra cars are admitted and then depart, so replay also has to fold departures.
+ */
+static void benchEventLogReplay(const std::size_t liveSessions) {
+    const std::string path = "parking_bench_events.wal";
+    std::remove(path.c_str());
+    {
+        EventLog log(path, 1, JournalOptions());
+        Car car = benchCar();
+        for (std::size_t i = 0; i < liveSessions + liveSessions / 2; ++i) {
+            car.id = static_cast<int>(1001 + i);
+            log.appendAdmission(car);
+        }
+        for (std::size_t i = liveSessions; i < liveSessions + liveSessions / 2; ++i)
+            log.appendDeparture(static_cast<int>(1001 + i));
+    }
+
+    ParkingLot lot(liveSessions);
+    lot.setSilentMode(true);
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t restored = lot.openEventLog(path);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(34) << "wal/replay" << std::right << std::setw(10)
+              << std::fixed << std::setprecision(1) << ms << " ms for " << restored << " live sessions\n";
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Writes a CSV history of the given number of sessions, all but liveSessions of which have
+ *        departed, and times rebuilding the lot from it.
+ */
+static void benchCsvStartup(const std::size_t historySessions, const std::size_t liveSessions) {
+    const std::string carsPath = "parking_bench_cars.csv";
+    const std::string departuresPath = "parking_bench_departures.csv";
+    {
+        const std::time_t now = std::time(nullptr);
+        std::string stamp = std::ctime(&now);
+        stamp.pop_back();
+        const std::string row = ",Bench Owner,KA01AB1234,Sedan,Blue,Petrol,9999999999,bench@example.com,Gold,Card,B1,Medium,60,Yes," +
+                                stamp + "\n";
+        const char* header =
+            "CarID,OwnerName,LicensePlate,Model,Color,FuelType,Phone,Email,Membership,PaymentMethod,Slot,Size,Rate,DynamicPricing,EntryTime\n";
+        std::ofstream cars(carsPath), departures(departuresPath);
+        cars << header;
+        departures << header;
+        for (std::size_t i = 0; i < historySessions; ++i) {
+            cars << 1001 + i << row;
+            if (i >= liveSessions) departures << 1001 + i << row;
+        }
+    }
+
+    ParkingLot lot(liveSessions);
+    lot.setSilentMode(true);
+    const auto start = std::chrono::steady_clock::now();
+    const LoadStats stats = loadLotFromCsv(lot, carsPath, departuresPath);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(34) << "csv/startup" << std::right << std::setw(10)
+              << std::fixed << std::setprecision(1) << ms << " ms for " << stats.restored << " live of "
+              << stats.admissions << " sessions (" << stats.bytes / (1024 * 1024) << " MiB)\n";
+    std::remove(carsPath.c_str());
+    std::remove(departuresPath.c_str());
+}
+
+/**
+ * @brief Writes the given number of structured bill records and times one reconciliation pass over them.
+ */
+static void benchBillReconcile(const std::size_t bills) {
+    const std::string path = "parking_bench_bills.bin";
+    const auto exit = std::chrono::system_clock::now();
+    Car car = benchCar();
+    car.parkingTime = exit - std::chrono::hours(3);
+    FeeBreakdown fee;
+    fee.hours = 3;
+    fee.gross = fee.total = 150;
+    {
+        std::string data(bill_records::FILE_MAGIC, sizeof(bill_records::FILE_MAGIC));
+        data.reserve(data.size() + bills * bill_records::RECORD_SIZE);
+        for (std::size_t i = 0; i < bills; ++i) {
+            car.id = static_cast<int>(1001 + i);
+            bill_records::encode(data, bill_records::makeRecord(car, fee, exit));
+        }
+        std::ofstream out(path, std::ios::binary);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const BillTotals totals = bill_records::reconcile(path, 0, INT64_MAX);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(34) << "bills/reconcile" << std::right << std::setw(10)
+              << std::fixed << std::setprecision(1) << ms << " ms for " << totals.bills << " bills\n";
+    g_sink = static_cast<std::size_t>(totals.totalCents);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Archives a CSV history of repeat customers, then times a one-column scan and a full decode.
+ */
+static void benchSessionArchive(const std::size_t sessions, const std::size_t customers) {
+    const std::string carsPath = "parking_bench_archive_cars.csv";
+    const std::string departuresPath = "parking_bench_archive_departures.csv";
+    const std::string archivePath = "parking_bench_sessions.parc";
+    {
+        const char* columns =
+            "CarID,OwnerName,LicensePlate,Model,Color,FuelType,Phone,Email,Membership,PaymentMethod,Slot,Size,Rate,DynamicPricing,";
+        const char* fuels[] = { "Petrol", "Diesel", "Electric", "CNG" };
+        const char* payments[] = { "Cash", "Card", "UPI" };
+        const char* sizes[] = { "Small", "Medium", "Large" };
+        std::ofstream cars(carsPath), departures(departuresPath);
+        cars << columns << "EntryTime\n";
+        departures << columns << "RemovedTime\n";
+        char row[256], entry[32], exit[32];
+        const std::time_t base = std::time(nullptr) - static_cast<std::time_t>(sessions) * 60;
+        for (std::size_t i = 0; i < sessions; ++i) {
+            const std::size_t c = (i * 7919) % customers;
+            const std::time_t entered = base + static_cast<std::time_t>(i) * 60;
+            const std::time_t left = entered + 900 + static_cast<std::time_t>((i * 131) % 14400);
+            std::strftime(entry, sizeof(entry), "%a %b %e %H:%M:%S %Y", std::localtime(&entered));
+            std::strftime(exit, sizeof(exit), "%a %b %e %H:%M:%S %Y", std::localtime(&left));
+            const int n = std::snprintf(row, sizeof(row),
+                "%zu,Customer %zu,KA%02zuAB%04zu,Model %zu,Silver,%s,98450%05zu,customer%zu@example.com,%s,%s,B%zu,%s,%d,%s,",
+                1001 + i, c, c % 50, c, c % 12, fuels[c % 4], c, c, c % 5 ? "None" : "Gold", payments[i % 3],
+                i % 200 + 1, sizes[c % 3], c % 2 ? 60 : 40, i % 4 ? "No" : "Yes");
+            cars.write(row, n) << entry << '\n';
+            departures.write(row, n) << exit << '\n';
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const ArchiveStats stats = archiveSessionsFromCsv(departuresPath, carsPath, archivePath);
+    const double archiveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<std::int64_t> exits;
+    std::int64_t latest = 0;
+    start = std::chrono::steady_clock::now();
+    {
+        SessionArchiveReader reader(archivePath);
+        while (reader.nextChunk() && reader.decodeIntegers(SessionColumn::ExitTime, exits))
+            for (const std::int64_t exitTime : exits) latest = std::max(latest, exitTime);
+    }
+    const double columnMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<Car> cars;
+    std::size_t decoded = 0;
+    start = std::chrono::steady_clock::now();
+    {
+        SessionArchiveReader reader(archivePath);
+        while (reader.nextChunk() && reader.decodeSessions(cars, exits)) decoded += cars.size();
+    }
+    const double fullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw(34) << "archive/write" << std::right << std::setw(10)
+              << std::fixed << std::setprecision(1) << archiveMs << " ms for " << stats.sessions << " sessions, "
+              << stats.csvBytes / 1024 << " KiB -> " << stats.archiveBytes / 1024 << " KiB ("
+              << static_cast<double>(stats.csvBytes) / static_cast<double>(stats.archiveBytes ? stats.archiveBytes : 1)
+              << "x)\n";
+    std::cout << std::left << std::setw(34) << "archive/scan-exit-column" << std::right << std::setw(10)
+              << columnMs << " ms\n";
+    std::cout << std::left << std::setw(34) << "archive/decode-all-columns" << std::right << std::setw(10)
+              << fullMs << " ms for " << decoded << " sessions\n";
+    g_sink = static_cast<std::size_t>(latest) + decoded;
+    std::remove(carsPath.c_str());
+    std::remove(departuresPath.c_str());
+    std::remove(archivePath.c_str());
+}
+
+/**
+ * @brief Appends bill-sized rows under one durability mode and reports throughput and append latency.
+ *
+ * Latency is measured per append() call, so it includes any write and sync that call triggers;
+ * the final flush is counted in the throughput.
+ */
+static void benchDurability(const char* name, const Durability durability, const std::size_t records) {
+    const std::string path = "parking_bench_durability.txt";
+    std::remove(path.c_str());
+    JournalOptions options;
+    options.durability = durability;
+    const std::string row =
+        "1001,Bench Owner,KA01AB1234,Sedan,Blue,Petrol,9999999999,bench@example.com,Gold,Card,B1,Medium,60,Yes,"
+        "Mon Jan  1 10:00:00 2024\n";
+    std::vector<double> latencies(records);
+    std::size_t syncs;
+    const auto start = std::chrono::steady_clock::now();
+    {
+        JournalWriter journal(path, "", options);
+        for (std::size_t i = 0; i < records; ++i) {
+            const auto before = std::chrono::steady_clock::now();
+            journal.append(row);
+            latencies[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - before).count();
+        }
+        journal.flush();
+        syncs = journal.getSyncCount();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::left << std::setw(34) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(0) << static_cast<double>(records) / seconds << " rows/s"
+              << std::setprecision(1) << "  p50 " << latencies[records / 2] << " us  p99 "
+              << latencies[records * 99 / 100] << " us  max " << latencies.back() << " us  " << syncs << " syncs\n";
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Logs a parking event through std::ostream over the session journal, the way main used to.
+ */
+static void benchOstreamLog(const unsigned long long ops) {
+    const std::string path = "parking_bench_log.txt";
+    std::remove(path.c_str());
+    const Car car = benchCar();
+    unsigned long long allocations;
+    std::chrono::steady_clock::duration elapsed;
+    {
+        JournalWriter journal(path);
+        JournalStreamBuf buffer(journal);
+        std::ostream log(&buffer);
+        const unsigned long long before = g_allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned long long i = 0; i < ops; ++i)
+            log << "Car " << car.id << " parked: owner " << car.ownerName << ", plate " << car.licensePlate
+                << ", slot " << car.slot << " (" << car.slotSize << "), rate " << car.hourlyRate << '\n';
+        elapsed = std::chrono::steady_clock::now() - start;
+        allocations = g_allocations.load() - before;
+    }
+    report("log/ostream", ops, elapsed, allocations);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Logs the same event through the ring logger, timing only the calls on the logging thread.
+ *
+ * Messages are logged in bursts of half the ring, with the drain thread emptying it between
+ * bursts, so the figure is the hot-path cost rather than the formatting and disk write.
+ */
+static void benchRingLog(const unsigned long long ops) {
+    const std::string path = "parking_bench_log.txt";
+    std::remove(path.c_str());
+    const Car car = benchCar();
+    const std::size_t burst = 512;
+    unsigned long long allocations = 0;
+    std::chrono::steady_clock::duration elapsed(0);
+    LoggerStats stats;
+    {
+        JournalWriter journal(path);
+        Logger logger(journal, 2 * burst);
+        for (unsigned long long done = 0; done < ops; done += burst) {
+            const unsigned long long count = std::min<unsigned long long>(burst, ops - done);
+            const unsigned long long before = g_allocations.load();
+            const auto start = std::chrono::steady_clock::now();
+            for (unsigned long long i = 0; i < count; ++i)
+                logger.log(LogLevel::Info, "Car {} parked: owner {}, plate {}, slot {} ({}), rate {}",
+                           car.id, car.ownerName, car.licensePlate, car.slot, car.slotSize, car.hourlyRate);
+            elapsed += std::chrono::steady_clock::now() - start;
+            allocations += g_allocations.load() - before;
+            logger.flush();
+        }
+        stats = logger.getStats();
+    }
+    report("log/ring-logger", ops, elapsed, allocations);
+    g_sink = stats.written + stats.dropped;
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Times ParkingLot::admit, the gate path, without a logger and with the ring logger attached.
+ *
+ * Cars are admitted in bursts that fit the lot and removed again between bursts, untimed, with
+ * the logger flushed there too, so the difference between the two figures is the logging call.
+ */
+static void benchAdmitLogging(const unsigned long long ops, const bool logging, const char* name) {
+    const std::string path = "parking_bench_admit_log.txt";
+    std::remove(path.c_str());
+    const Car car = benchCar();
+    AdmissionRequest request;
+    request.ownerName = car.ownerName;
+    request.licensePlate = car.licensePlate;
+    request.model = car.model;
+    request.color = car.color;
+    request.fuelType = car.fuelType;
+    request.phone = car.phone;
+    request.email = car.email;
+    request.membership = car.membership;
+    request.paymentMethod = car.paymentMethod;
+    request.slot = car.slot;
+    request.slotSize = car.slotSize;
+    request.exitGate = car.exitGate;
+    request.hourlyRate = car.hourlyRate;
+    const unsigned long long burst = 50;
+    std::vector<int> ids;
+    unsigned long long allocations = 0;
+    std::chrono::steady_clock::duration elapsed(0);
+    {
+        JournalWriter journal(path);
+        Logger logger(journal);
+        ParkingLot lot;
+        lot.setSilentMode(true);
+        if (logging) lot.setLogger(&logger);
+        for (unsigned long long done = 0; done < ops; done += burst) {
+            const unsigned long long count = std::min<unsigned long long>(burst, ops - done);
+            ids.clear();
+            const unsigned long long before = g_allocations.load();
+            const auto start = std::chrono::steady_clock::now();
+            for (unsigned long long i = 0; i < count; ++i) ids.push_back(lot.admit(request));
+            elapsed += std::chrono::steady_clock::now() - start;
+            allocations += g_allocations.load() - before;
+            for (const int id : ids) lot.removeCarByIdAndOwner(id, request.ownerName);
+            logger.flush();
+        }
+    }
+    report(name, ops, elapsed, allocations);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Times fee calculations with latency tracking off or on, to show what the timing costs.
+ */
+static void benchFeeTracking(const unsigned long long ops, const bool tracking, const char* name) {
+    ParkingLot lot;
+    lot.setLatencyTracking(tracking);
+    const Car car = benchCar();
+    const auto exitTime = std::chrono::system_clock::now();
+    double sink = 0.0;
+    const unsigned long long before = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < ops; ++i) sink += lot.calculateFee(car, exitTime);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    report(name, ops, elapsed, g_allocations.load() - before);
+    if (tracking) {
+        const LatencyHistogram& fee = lot.getLatency(LotOperation::Fee);
+        std::cout << std::left << std::setw(34) << "  recorded fee latency" << std::right << std::setprecision(0)
+                  << "p50 " << fee.percentile(0.5) << " ns  p99 " << fee.percentile(0.99) << " ns  p99.9 "
+                  << fee.percentile(0.999) << " ns\n";
+    }
+    g_sink = static_cast<std::size_t>(sink);
+}
+
+/**
+ * @brief Displays a lot of 100 cars repeatedly into an output sink.
+ *
+ * A null sink skips building the table; a buffered file sink builds it once per display and
+ * writes it in 64 KiB blocks.
+ */
+static void benchDisplayOutput(const unsigned long long ops, OutputSink& sink, const char* name) {
+    ParkingLot lot;
+    lot.setSilentMode(true);
+    for (int i = 0; i < 100; ++i) {
+        Car car = benchCar();
+        car.id = 1001 + i;
+        lot.testAddCar(car);
+    }
+    lot.setOutput(&sink);
+    const unsigned long long before = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < ops; ++i) lot.displayCars();
+    sink.flush();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    report(name, ops, elapsed, g_allocations.load() - before);
+}
+
+/**
+ * @brief Reads one admission the way parkCar's prompts do, a field at a time from a stream,
+ *        against parsing the same admission as a single gate record.
+ */
+static void benchGateParse(const unsigned long long ops) {
+    const std::string fields = "Bench Owner\nKA01AB1234\nSwift\nRed\nPetrol\n9876543210\nbench@x.com\nGold\nUPI\n"
+                               "A7\nMedium\nn\nG2\n72.5\nn\n1.25\n";
+    AdmissionRequest request;
+    std::istringstream in;
+    char reserved = 'n', dynamic = 'n';
+    unsigned long long before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < ops; ++i) {
+        in.clear();
+        in.str(fields);
+        std::getline(in, request.ownerName);
+        std::getline(in, request.licensePlate);
+        std::getline(in, request.model);
+        std::getline(in, request.color);
+        std::getline(in, request.fuelType);
+        std::getline(in, request.phone);
+        std::getline(in, request.email);
+        std::getline(in, request.membership);
+        std::getline(in, request.paymentMethod);
+        std::getline(in, request.slot);
+        std::getline(in, request.slotSize);
+        in >> reserved;
+        in.ignore();
+        std::getline(in, request.exitGate);
+        in >> request.hourlyRate >> dynamic >> request.parkingHours;
+        in.ignore();
+        g_sink += request.phone.size() + static_cast<std::size_t>(reserved == 'y');
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    report("gate/park-stream-fields", ops, elapsed, g_allocations.load() - before);
+
+    std::string record;
+    appendParkRecord(request, record);
+    GateCommand command;
+    before = g_allocations.load();
+    start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < ops; ++i) {
+        if (!parseGateCommand(record, command)) g_sink += command.admission.phone.size();
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    report("gate/park-record-parse", ops, elapsed, g_allocations.load() - before);
+}
+
+// =============================
+// 📌 MAIN FUNCTION
+// =============================
+/**
+ * @brief Entry point for the ParkingLot benchmark suite.
+ *
+ * Runs each benchmark scenario and prints its time and heap allocations per operation.
+ * An optional first argument overrides the number of iterations per scenario.
+ *
+ * @return int Returns 0 upon completion.
+ */
+int main(int argc, char** argv) {
+    const unsigned long long ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000ULL;
+    std::cout << "===== ParkingLot Benchmarks (" << ops << " ops) =====\n";
+
+    benchOstringstreamBill(ops);
+    benchRendererBill(ops, BillRenderer::Layout::Human, "bill/renderer-human");
+    benchRendererBill(ops, BillRenderer::Layout::Compact, "bill/renderer-compact");
+    benchKioskQuotes(ops);
+    benchEventLogReplay(100000);
+    benchCsvStartup(500000, 1000);
+    benchBillReconcile(1000000);
+    benchSessionArchive(500000, 2000);
+    benchDurability("durability/none", Durability::None, 20000);
+    benchDurability("durability/group-commit", Durability::GroupCommit, 20000);
+    benchDurability("durability/fsync-per-event", Durability::FsyncPerEvent, 20000);
+    benchOstreamLog(ops);
+    benchRingLog(ops);
+    benchAdmitLogging(ops, false, "admit/logger-off");
+    benchAdmitLogging(ops, true, "admit/logger-on");
+    benchFeeTracking(ops, false, "fee/latency-tracking-off");
+    benchFeeTracking(ops, true, "fee/latency-tracking-on");
+
+    benchGateParse(ops);
+    benchDisplayOutput(ops / 100, nullOutput(), "display100/null-sink");
+    {
+        const char* displayPath = "parking_bench_display.txt";
+        std::remove(displayPath);
+        BufferedFileSink fileSink(displayPath);
+        benchDisplayOutput(ops / 100, fileSink, "display100/buffered-file-sink");
+        fileSink.flush();
+        std::remove(displayPath);
+    }
+
+    std::cout << "=========== Benchmarks Completed ===========\n";
+    return 0;
+}
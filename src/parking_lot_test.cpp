@@ -1,9 +1,34 @@
 #include "parking_lot.h"
+#include "car_codec.h"
+#include "csv_reader.h"
+#include "event_replay.h"
+#include "gate_protocol.h"
+#include "gate_client.h"
+#include "gate_server.h"
+#include "logger.h"
+#include "lot_loader.h"
+#include "session_archive.h"
+#include "traffic_replay.h"
+#include "segment_index.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <chrono>
 #include <cassert>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <limits>
 #include <stdexcept>
+#include <thread>
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 // =============================
 // 📌 Helper for creating cars
@@ -36,6 +61,32 @@ Car createCar(
     return car;
 }
 
+/**
+ * @brief Returns a scratch file path for tests that exercise persistence, removing any stale copy.
+ * @param name A name unique to the test.
+ * @return The path, relative to the test's working directory.
+ */
+std::string testFilePath(const std::string& name) {
+    const std::string path = "parking_test_" + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+/**
+ * @brief Reads a whole file into a string; returns an empty string if it does not exist.
+ */
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Checks whether a file exists.
+ */
+bool fileExists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+
 // =============================
 // 📌 Test Functions
 // =============================
@@ -864,6 +915,1509 @@ void testAddRemoveAddSameLicensePlate() {
     assert(lot.getCarByID(2201).licensePlate == "PLATE1");
 }
 
+/**
+ * @brief Tests that the per-slot-size occupancy counters follow admissions and departures.
+ *
+ * This test adds two medium cars and one large car, checks the per-class counts and utilization,
+ * then removes a medium car and verifies that only its class counter drops.
+ */
+void testOccupancyCounters() {
+    ParkingLot lot(10); lot.setSilentMode(true);
+    lot.setSlotCapacity(SlotClass::Medium, 4);
+    lot.testAddCar(createCar(3000, "M1"));
+    lot.testAddCar(createCar(3001, "M2"));
+    Car large = createCar(3002, "L1");
+    large.slotSize = "large";
+    lot.testAddCar(large);
+    assert(lot.getOccupancy(SlotClass::Medium) == 2);
+    assert(lot.getOccupancy(SlotClass::Large) == 1);
+    assert(lot.getUtilization(SlotClass::Medium) == 0.5);
+    assert(lot.removeCarByIdAndOwner(3000, "M1"));
+    assert(lot.getOccupancy(SlotClass::Medium) == 1);
+    assert(lot.getOccupancy(SlotClass::Large) == 1);
+}
+
+/**
+ * @brief Tests that a full slot class refuses further cars even when the lot has room.
+ */
+void testSlotCapacityLimitsAdmission() {
+    ParkingLot lot; lot.setSilentMode(true);
+    lot.setSlotCapacity(SlotClass::Small, 1);
+    Car s1 = createCar(3100, "S1");
+    Car s2 = createCar(3101, "S2");
+    s1.slotSize = s2.slotSize = "Small";
+    lot.testAddCar(s1);
+    lot.testAddCar(s2);
+    assert(lot.getCarCount() == 1);
+    assert(lot.getOccupancy(SlotClass::Small) == 1);
+}
+
+/**
+ * @brief Tests the surge curve and the multiplier the lot quotes for arriving cars.
+ *
+ * The default curve is flat at low occupancy and reaches 2x when full; a custom curve is
+ * interpolated linearly between its breakpoints.
+ */
+void testSurgeMultiplierFollowsUtilization() {
+    const SurgeCurve curve({ {0.0, 1.0}, {1.0, 3.0} });
+    assert(curve.multiplierAt(0, 10) == 1.0);
+    assert(curve.multiplierAt(5, 10) == 2.0);
+    assert(curve.multiplierAt(10, 10) == 3.0);
+
+    ParkingLot lot(4); lot.setSilentMode(true);
+    assert(lot.currentSurgeMultiplier("Medium") == 1.0);
+    for (int i = 0; i < 4; ++i)
+        lot.testAddCar(createCar(3200 + i, "Peak"));
+    assert(lot.currentSurgeMultiplier("Medium") == 2.0);
+    assert(lot.currentSurgeMultiplier("Small") == 1.0);
+}
+
+/**
+ * @brief Tests that tariff bands are charged per minute of the week in O(1).
+ *
+ * Monday 09:00-17:00 UTC is charged at 2x. A stay from Monday 08:00 to 10:00 therefore costs
+ * 3 rate-hours, and the same stay shifted by exactly four weeks costs 4 * weekly total + 3.
+ */
+void testTariffCalendarBands() {
+    using namespace std::chrono;
+    TariffCalendar calendar;
+    calendar.setBand(0, 9 * 60, 17 * 60, 2.0);
+    const system_clock::time_point monday = system_clock::from_time_t(1704067200);  // Mon 2024-01-01 00:00 UTC
+    const system_clock::time_point entry = monday + hours(8);
+    assert(calendar.weightedHours(entry, entry + hours(2)) == 3.0);
+    assert(calendar.weightedHours(entry, entry + hours(24 * 28 + 2)) == 4 * (168.0 + 8.0) + 3.0);
+    assert(calendar.weightedHours(entry, entry - hours(1)) == 0.0);
+
+    ParkingLot lot; lot.setSilentMode(true);
+    lot.setTariffCalendar(calendar);
+    Car c = createCar(3300, "Banded", false, 10);
+    c.parkingTime = entry;
+    const FeeBreakdown fee = lot.calculateFeeBreakdown(c, entry + hours(2));
+    assert(fee.hours == 2.0);
+    assert(fee.gross == 30.0);
+    assert(lot.calculateFee(c, entry + hours(2)) == 30.0);
+}
+
+/**
+ * @brief Tests that a flat calendar reproduces plain hours-times-rate pricing for long stays.
+ */
+void testTariffCalendarFlatLongStay() {
+    using namespace std::chrono;
+    ParkingLot lot; lot.setSilentMode(true);
+    Car c = createCar(3301, "Flat", false, 10);
+    const system_clock::time_point exit = c.parkingTime + hours(24 * 30) + minutes(30);
+    const double fee = lot.calculateFee(c, exit);
+    assert(fee >= 7204.9 && fee <= 7205.1);
+}
+
+/**
+ * @brief Tests that the bill renderer reproduces the legacy ostringstream bill byte for byte.
+ *
+ * A dynamically priced car parked for 6 hours gets a discount line; the rendered human bill must
+ * match the text the stream-based formatter produced, and re-rendering reuses the same buffer.
+ */
+void testBillRendererHumanLayout() {
+    using namespace std::chrono;
+    ParkingLot lot; lot.setSilentMode(true);
+    Car c = createCar(3400, "Render", true, 60);
+    const system_clock::time_point exit = c.parkingTime + hours(6);
+    const FeeBreakdown fee = lot.calculateFeeBreakdown(c, exit);
+
+    std::ostringstream legacy;
+    legacy << "\n========= 🧾 PARKING BILL 🧾 =========\n"
+           << "Car ID            : " << c.id << "\n"
+           << "Owner Name        : " << c.ownerName << "\n"
+           << "License Plate     : " << c.licensePlate << "\n"
+           << "Hours Parked      : " << std::fixed << std::setprecision(2) << fee.hours << "\n"
+           << "Rate per Hour (₹) : " << fee.rate << "\n"
+           << "Gross (₹)         : " << fee.gross << "\n"
+           << "Discount (30%)    : -" << fee.discount << "\n"
+           << "GST @ 18% (₹)     : " << fee.gst << "\n"
+           << "TOTAL (₹)         : " << fee.total << "\n"
+           << "======================================\n";
+
+    BillRenderer renderer;
+    renderer.render(c, fee);
+    assert(renderer.str() == legacy.str());
+    const char* first = renderer.data();
+    renderer.render(c, fee);
+    assert(renderer.data() == first);
+}
+
+/**
+ * @brief Tests the compact one-line bill layout, including negative and large amounts.
+ */
+void testBillRendererCompactLayout() {
+    Car c = createCar(3401, "Compact", false, 50);
+    FeeBreakdown fee;
+    fee.hours = 1.5; fee.rate = 50; fee.gross = 75; fee.total = 1234567.125;
+    BillRenderer renderer;
+    renderer.render(c, fee, BillRenderer::Layout::Compact);
+    assert(renderer.str() == "BILL|3401|Compact|MH12AB1234|1.50|50.00|75.00|0.00|0.00|1234567.13\n");
+    fee.gst = -0.05;
+    renderer.render(c, fee, BillRenderer::Layout::Compact);
+    assert(renderer.str().find("|-0.05|") != std::string::npos);
+    c.ownerName = "Pipe|Owner\r\n";
+    c.licensePlate = "MH|12";
+    renderer.render(c, fee, BillRenderer::Layout::Compact);
+    const std::string sanitized = renderer.str();
+    assert(sanitized.find("BILL|3401|Pipe Owner  |MH 12|1.50|") == 0);
+    assert(std::count(sanitized.begin(), sanitized.end(), '|') == 9);
+}
+
+/**
+ * @brief Tests that kiosk fee quotes are cached per billing minute and invalidated correctly.
+ *
+ * Repeated quotes within the same minute hit the cache, a new minute recomputes, a tariff change
+ * drops cached quotes, and a departed car can no longer be quoted.
+ */
+void testQuoteFeeCache() {
+    using namespace std::chrono;
+    ParkingLot lot; lot.setSilentMode(true);
+    Car c = createCar(3500, "Kiosk", false, 60);
+    c.parkingTime -= hours(2);
+    lot.testAddCar(c);
+    const system_clock::time_point at = c.parkingTime + hours(2) + seconds(10);
+
+    const double first = lot.quoteFee(3500, at);
+    assert(first >= 119.9 && first <= 120.1);
+    assert(lot.quoteFee(3500, at + seconds(20)) == first);
+    assert(lot.getQuoteCacheHits() == 1 && lot.getQuoteCacheMisses() == 1);
+
+    assert(lot.quoteFee(3500, at + minutes(1)) > first);
+    assert(lot.getQuoteCacheMisses() == 2);
+
+    TariffCalendar doubled;
+    for (int day = 0; day < 7; ++day) doubled.setBand(day, 0, 24 * 60, 2.0);
+    lot.setTariffCalendar(doubled);
+    const double doubledFee = lot.quoteFee(3500, at);
+    assert(doubledFee >= 2 * first - 0.1 && doubledFee <= 2 * first + 0.1);
+
+    assert(lot.removeCarByIdAndOwner(3500, "Kiosk"));
+    assert(lot.quoteFee(3500, at) == -1.0);
+}
+
+/**
+ * @brief Tests that the journal writer buffers rows and only touches the file when flushing.
+ *
+ * Rows below the size threshold stay in memory (the file is not even created), a flush writes the
+ * header once followed by the rows, crossing the size threshold flushes automatically, and a new
+ * writer on an existing file does not repeat the header.
+ */
+void testJournalWriterBuffersRows() {
+    const std::string path = testFilePath("journal.csv");
+    JournalOptions options;
+    options.flushBytes = 64;
+    options.flushInterval = std::chrono::hours(1);
+    {
+        JournalWriter journal(path, "H\n", options);
+        journal.append("row1\n");
+        assert(!fileExists(path));
+        assert(journal.getBufferedBytes() == 5);
+        assert(journal.flush());
+        assert(readFile(path) == "H\nrow1\n");
+
+        journal.append(std::string(70, 'x') + "\n");
+        assert(journal.getBufferedBytes() == 0);
+        journal.append("tail\n");
+    }
+    assert(readFile(path) == "H\nrow1\n" + std::string(70, 'x') + "\ntail\n");
+
+    {
+        JournalWriter journal(path, "H\n", options);
+        journal.append("again\n");
+    }
+    assert(readFile(path).find("H\n", 1) == std::string::npos);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that a flush cut short part way through does not write its rows twice.
+ *
+ * A file size limit makes the kernel accept only part of the buffer and then fail the write; the
+ * retry after the limit is lifted must continue from where the file ends.
+ */
+void testJournalWriterResumesPartialWrite() {
+    const std::string path = testFilePath("partial.csv");
+    JournalOptions options;
+    options.flushBytes = 1 << 20;
+    options.flushInterval = std::chrono::hours(1);
+    rlimit original;
+    assert(::getrlimit(RLIMIT_FSIZE, &original) == 0);
+    void (*previous)(int) = std::signal(SIGXFSZ, SIG_IGN);
+    {
+        JournalWriter journal(path, "H\n", options);
+        std::string rows;
+        for (int i = 0; i < 10; ++i) rows += "row" + std::to_string(i) + "\n";
+        journal.append(rows);
+        rlimit limited = original;
+        limited.rlim_cur = 20;
+        assert(::setrlimit(RLIMIT_FSIZE, &limited) == 0);
+        assert(!journal.flush());
+        assert(journal.getBufferedBytes() == 2 + rows.size() - 20);
+        assert(::setrlimit(RLIMIT_FSIZE, &original) == 0);
+        assert(journal.flush() && journal.getBufferedBytes() == 0);
+        assert(readFile(path) == "H\n" + rows);
+    }
+    std::signal(SIGXFSZ, previous);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that a lot rebuilt from the write-ahead log has the same cars and ID counter.
+ *
+ * Four cars are admitted and two depart, including the one with the highest ID, while the log is
+ * open; a fresh lot replaying the log must hold the two remaining cars with their details and
+ * continue numbering after the highest ID ever issued, not just the highest still parked.
+ */
+void testEventLogRecoversParkedCars() {
+    const std::string path = testFilePath("events.wal");
+    {
+        ParkingLot lot; lot.setSilentMode(true);
+        assert(lot.openEventLog(path) == 0);
+        Car vip = createCar(1001, "Alice", true, 80);
+        vip.reservedSlot = true;
+        vip.slotSize = "Large";
+        lot.testAddCar(vip);
+        lot.testAddCar(createCar(1002, "Bob"));
+        lot.testAddCar(createCar(1003, "Carol"));
+        lot.testAddCar(createCar(1004, "Dave"));
+        assert(lot.removeCarByIdAndOwner(1002, "Bob"));
+        assert(lot.removeCarByIdAndOwner(1004, "Dave"));
+    }
+    ParkingLot recovered; recovered.setSilentMode(true);
+    assert(recovered.openEventLog(path) == 2);
+    assert(recovered.getCarCount() == 2);
+    assert(recovered.getCarByID(1002).id == 0 && recovered.getCarByID(1004).id == 0);
+    const Car alice = recovered.getCarByID(1001);
+    assert(alice.ownerName == "Alice" && alice.reservedSlot && alice.dynamicPricing);
+    assert(alice.hourlyRate == 80 && alice.slotSize == "Large");
+    assert(recovered.getOccupancy(SlotClass::Large) == 1);
+    assert(recovered.getNextCarID() == 1005);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that a record torn by a crash is discarded and later records still append cleanly.
+ */
+void testEventLogIgnoresTornTail() {
+    const std::string path = testFilePath("torn.wal");
+    {
+        ParkingLot lot; lot.setSilentMode(true);
+        lot.openEventLog(path);
+        lot.testAddCar(createCar(1001, "Kept"));
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << "\x40\x00\x00\x00garbage";
+    }
+    {
+        ParkingLot lot; lot.setSilentMode(true);
+        assert(lot.openEventLog(path) == 1);
+        lot.testAddCar(createCar(1002, "After"));
+    }
+    ParkingLot lot; lot.setSilentMode(true);
+    assert(lot.openEventLog(path) == 2);
+    assert(lot.getCarByID(1002).ownerName == "After");
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that the CSV startup loader restores exactly the cars that have not departed.
+ *
+ * The history repeats its header, re-admits one ID after it left, and contains a malformed row;
+ * the loader must keep the latest admission of each parked ID, recover its entry time to the
+ * second, and continue numbering after the highest ID found in either file.
+ */
+void testLotLoaderRestoresParkedCars() {
+    const std::string carsPath = testFilePath("loader_cars.csv");
+    const std::string departuresPath = testFilePath("loader_departures.csv");
+    const std::string header =
+        "CarID,OwnerName,LicensePlate,Model,Color,FuelType,Phone,Email,Membership,PaymentMethod,Slot,Size,Rate,DynamicPricing,EntryTime\n";
+    const std::time_t entry = 1704103200;  // Monday 2024-01-01 10:00 UTC
+    std::string stamp = std::ctime(&entry);
+    stamp.pop_back();
+    const std::string details = ",Model,Color,Fuel,123,a@b.c,None,Cash,S1,";
+    {
+        std::ofstream cars(carsPath);
+        cars << header
+             << "1001,Gone,P1" << details << "Medium,50,No," << stamp << "\n"
+             << header
+             << "1002,Stays,P2" << details << "Large,80,Yes," << stamp << "\r\n"
+             << "1003,First,P3" << details << "Small,40,No," << stamp << "\n"
+             << "oops,not a row\n"
+             << "1003,Second,P3" << details << "Small,45,No," << stamp << "\n";
+        std::ofstream departures(departuresPath);
+        departures << header
+                   << "1001,Gone,P1" << details << "Medium,50,No," << stamp << "\n"
+                   << header
+                   << "1003,First,P3" << details << "Small,40,No," << stamp << "\n"
+                   << "1010,Old,P9" << details << "Small,40,No," << stamp << "\n";
+    }
+
+    ParkingLot lot; lot.setSilentMode(true);
+    const LoadStats stats = loadLotFromCsv(lot, carsPath, departuresPath);
+    assert(stats.admissions == 4 && stats.departures == 3);
+    assert(stats.restored == 2 && stats.skipped == 1);
+    assert(lot.getCarCount() == 2);
+    assert(lot.getCarByID(1001).id == 0);
+    const Car stays = lot.getCarByID(1002);
+    assert(stays.ownerName == "Stays" && stays.licensePlate == "P2" && stays.slotSize == "Large");
+    assert(stays.hourlyRate == 80 && stays.dynamicPricing);
+    assert(std::chrono::system_clock::to_time_t(stays.parkingTime) == entry);
+    assert(lot.getCarByID(1003).ownerName == "Second" && lot.getCarByID(1003).hourlyRate == 45);
+    assert(lot.getOccupancy(SlotClass::Large) == 1 && lot.getOccupancy(SlotClass::Small) == 1);
+    assert(lot.getNextCarID() == 1011);
+
+    ParkingLot empty; empty.setSilentMode(true);
+    assert(loadLotFromCsv(empty, testFilePath("missing.csv"), departuresPath).restored == 0);
+
+    // Fields holding commas, quotes or line breaks are written quoted and restored intact
+    const std::string quotedCars = testFilePath("quoted_cars_data.csv");
+    const std::string quotedDepartures = testFilePath("quoted_Customer_details.csv");
+    Car awkward = createCar(1001, "Doe, Jane \"JD\"");
+    awkward.model = "Line\nBreak";
+    {
+        ParkingLot writer(makeStorageBackend(StorageKind::Csv, "parking_test_quoted_"));
+        writer.setSilentMode(true);
+        writer.setPersistenceEnabled(true);
+        writer.testAddCar(awkward);
+        writer.saveCarToCSV(awkward);
+        writer.flushJournals();
+    }
+    ParkingLot reloaded; reloaded.setSilentMode(true);
+    const LoadStats quoted = loadLotFromCsv(reloaded, quotedCars, quotedDepartures);
+    assert(quoted.restored == 1 && quoted.skipped == 0);
+    const Car restoredAwkward = reloaded.getCarByID(1001);
+    assert(restoredAwkward.ownerName == awkward.ownerName && restoredAwkward.model == awkward.model);
+    assert(restoredAwkward.licensePlate == awkward.licensePlate && restoredAwkward.slotSize == awkward.slotSize);
+
+    for (const std::string& path : {carsPath, departuresPath, quotedCars, quotedDepartures,
+                                     testFilePath("quoted_bill_history.txt"), testFilePath("quoted_bill_records.bin")})
+        std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that a checkpoint compacts the event log and recovery combines snapshot and log tail.
+ *
+ * After a checkpoint the retired log is gone and the live log only holds later records; a fresh lot
+ * must see the snapshot's cars, the tail's changes and an ID counter that skips departed IDs.
+ * Automatic checkpoints taken every two events must recover to the same state.
+ */
+void testCheckpointCompactsEventLog() {
+    const std::string path = testFilePath("checkpoint.wal");
+    const std::string snapshotPath = testFilePath("checkpoint.wal.snap");
+    const std::string retiredPath = testFilePath("checkpoint.wal.old");
+    {
+        ParkingLot lot; lot.setSilentMode(true);
+        lot.setCheckpointInterval(0);
+        lot.openEventLog(path);
+        lot.testAddCar(createCar(1001, "Alice"));
+        lot.testAddCar(createCar(1002, "Bob"));
+        lot.testAddCar(createCar(1003, "Carol"));
+        assert(lot.removeCarByIdAndOwner(1003, "Carol"));
+        assert(lot.checkpoint());
+        lot.waitForCheckpoint();
+        assert(fileExists(snapshotPath) && !fileExists(retiredPath));
+        assert(lot.removeCarByIdAndOwner(1001, "Alice"));
+        lot.testAddCar(createCar(1004, "Dave"));
+    }
+    assert(EventLog::replay(path, [](const LogEvent&) {}).events == 2);
+
+    ParkingLot recovered; recovered.setSilentMode(true);
+    assert(recovered.openEventLog(path) == 2);
+    assert(recovered.getCarByID(1002).ownerName == "Bob");
+    assert(recovered.getCarByID(1004).ownerName == "Dave");
+    assert(recovered.getCarByID(1001).id == 0);
+    assert(recovered.getNextCarID() == 1005);
+    recovered.waitForCheckpoint();
+
+    std::remove(path.c_str());
+    std::remove(snapshotPath.c_str());
+    {
+        ParkingLot lot; lot.setSilentMode(true);
+        lot.setCheckpointInterval(2);
+        lot.openEventLog(path);
+        for (int id = 1001; id <= 1005; ++id) lot.testAddCar(createCar(id, "Auto"));
+        assert(lot.removeCarByIdAndOwner(1005, "Auto"));
+    }
+    ParkingLot automatic; automatic.setSilentMode(true);
+    assert(automatic.openEventLog(path) == 4);
+    assert(automatic.getNextCarID() == 1006);
+    assert(EventLog::replay(path, [](const LogEvent&) {}).events == 0);
+    std::remove(path.c_str());
+    std::remove(snapshotPath.c_str());
+    std::remove(retiredPath.c_str());
+}
+
+/**
+ * @brief Tests the persistence queue's delivery order and its policies for a full queue.
+ *
+ * Under Block every record arrives in submission order. Under DropNewest, records submitted while
+ * the I/O thread is held up are dropped once the queue is full, and exactly the others arrive.
+ * Under WriteThrough nothing is lost however small the queue.
+ */
+void testPersistenceQueuePolicies() {
+    const std::string path = testFilePath("queue.txt");
+    JournalOptions buffered;
+    buffered.flushInterval = std::chrono::hours(1);
+    {
+        JournalWriter journal(path, "", buffered);
+        PersistenceOptions options;
+        options.capacity = 4;
+        PersistenceQueue queue(options);
+        for (int i = 0; i < 100; ++i) {
+            const std::string row = std::to_string(i) + "\n";
+            assert(queue.submit(journal, row.data(), row.size()));
+        }
+        queue.drain();
+        queue.withIoLock([&journal] { journal.flush(); });
+    }
+    std::string expected;
+    for (int i = 0; i < 100; ++i) expected += std::to_string(i) + "\n";
+    assert(readFile(path) == expected);
+    std::remove(path.c_str());
+
+    {
+        JournalWriter journal(path, "", buffered);
+        PersistenceOptions options;
+        options.capacity = 2;
+        options.policy = QueueFullPolicy::DropNewest;
+        PersistenceQueue queue(options);
+        size_t accepted = 0;
+        queue.withIoLock([&] {
+            for (int i = 0; i < 10; ++i)
+                if (queue.submit(journal, "x\n", 2)) ++accepted;
+        });
+        queue.drain();
+        const PersistenceStats stats = queue.getStats();
+        assert(stats.submitted == 10 && stats.dropped == 10 - accepted);
+        assert(accepted >= 2 && accepted <= 3 && stats.maxDepth == 2);
+        queue.withIoLock([&journal] { journal.flush(); });
+        assert(readFile(path).size() == 2 * accepted);
+    }
+    std::remove(path.c_str());
+
+    {
+        JournalWriter journal(path, "", buffered);
+        PersistenceOptions options;
+        options.capacity = 1;
+        options.policy = QueueFullPolicy::WriteThrough;
+        PersistenceQueue queue(options);
+        for (int i = 0; i < 200; ++i) assert(queue.submit(journal, "y\n", 2));
+        queue.drain();
+        assert(queue.getStats().dropped == 0);
+    }
+    assert(readFile(path).size() == 400);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that structured bill records round-trip and reconcile exactly in integer cents.
+ *
+ * Three bills are written, one outside the reconciliation window and one with a flipped byte;
+ * a half-written record at the end must be reported and ignored, and cut off before the next append.
+ */
+void testBillRecordsReconcile() {
+    const std::string path = testFilePath("bills.bin");
+    const auto entry = std::chrono::system_clock::from_time_t(1704103200);
+    Car car = createCar(1001, "Alice", true, 50);
+    car.licensePlate = "KA01AB1234-EXTRA-LONG-PLATE";
+    car.parkingTime = entry;
+
+    ParkingLot lot; lot.setSilentMode(true);
+    const auto exit = entry + std::chrono::hours(2);
+    const FeeBreakdown fee = lot.calculateFeeBreakdown(car, exit);
+    const BillRecord record = bill_records::makeRecord(car, fee, exit);
+    assert(record.minutesParked == 120 && record.grossCents == 10000);
+    assert(record.gstCents == 1800 && record.totalCents == 11800);
+    assert(std::string(record.plate) == "KA01AB1234-EXTRA-LON");
+
+    std::string data(bill_records::FILE_MAGIC, sizeof(bill_records::FILE_MAGIC));
+    bill_records::encode(data, record);
+    BillRecord later = record;
+    later.carId = 1002;
+    later.exitTime += 3600;
+    bill_records::encode(data, later);
+    BillRecord outside = record;
+    outside.exitTime += 86400;
+    bill_records::encode(data, outside);
+    bill_records::encode(data, record);
+    data[data.size() - 50] ^= 0x1;
+    data.append("partial");
+    assert(data.size() == 8 + 4 * bill_records::RECORD_SIZE + 7);
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << data;
+    }
+
+    BillRecord decoded;
+    assert(bill_records::decode(data.data() + 8 + bill_records::RECORD_SIZE, decoded));
+    assert(decoded.carId == 1002 && decoded.exitTime == later.exitTime && decoded.totalCents == 11800);
+
+    const BillTotals totals = bill_records::reconcile(path, 1704067200, 1704067200 + 86400);
+    assert(totals.bills == 2 && totals.corrupt == 1 && totals.truncatedTail);
+    assert(totals.grossCents == 20000 && totals.gstCents == 3600 && totals.totalCents == 23600);
+    assert(bill_records::reconcile(testFilePath("missing.bin"), 0, 1).bills == 0);
+
+    // Appending after the torn record first cuts it off, so the new record is read back intact
+    {
+        JournalWriter journal(path, std::string(bill_records::FILE_MAGIC, sizeof(bill_records::FILE_MAGIC)));
+        journal.setRecordSize(bill_records::RECORD_SIZE);
+        std::string appended;
+        bill_records::encode(appended, later);
+        journal.append(appended);
+    }
+    const BillTotals repaired = bill_records::reconcile(path, 1704067200, 1704067200 + 86400);
+    assert(!repaired.truncatedTail && repaired.corrupt == 1 && repaired.bills == 3);
+    assert(repaired.totalCents == 3 * 11800);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests size-based journal rotation, the segment index, range lookups and archiving.
+ *
+ * Each segment must start with the header and rows must never be split or reordered across
+ * segments, and the index I/O must be counted in the journal's stats. A range query ending before the segments were closed must return only closed
+ * segments, archived segments must stay reachable through the index, and the CSV loader must see
+ * rows from every segment.
+ */
+void testJournalSegmentRotation() {
+    const std::string path = testFilePath("segmented.csv");
+    const std::string departures = testFilePath("segmented_departures.csv");
+    const std::string archiveDir = testFilePath("archive");
+    std::remove(segment_index::indexPath(path).c_str());
+    for (int sequence = 1; sequence <= 3; ++sequence) {
+        std::remove(segment_index::segmentPath(path, sequence).c_str());
+        std::remove((archiveDir + "/" + segment_index::segmentPath(path, sequence)).c_str());
+    }
+    const std::string header =
+        "CarID,OwnerName,LicensePlate,Model,Color,FuelType,Phone,Email,Membership,PaymentMethod,Slot,Size,Rate,DynamicPricing,EntryTime\n";
+    const std::time_t entry = 1704103200;
+    std::string stamp = std::ctime(&entry);
+    stamp.pop_back();
+
+    const std::int64_t before = static_cast<std::int64_t>(std::time(nullptr));
+    JournalOptions options;
+    options.flushBytes = 0;
+    options.segmentBytes = header.size() + 150;
+    IoStats io;
+    {
+        JournalWriter journal(path, header, options);
+        for (int id = 1001; id <= 1006; ++id)
+            journal.append(std::to_string(id) + ",Owner,P,M,C,F,1,a@b.c,None,Cash,S1,Small,40,No," + stamp + "\n");
+        io = journal.getIoStats();
+    }
+
+    const std::vector<SegmentInfo> closed = segment_index::readClosed(path);
+    assert(closed.size() == 3);
+    std::string rows;
+    for (size_t i = 0; i < closed.size(); ++i) {
+        assert(closed[i].sequence == i + 1 && closed[i].file == segment_index::segmentPath(path, i + 1));
+        assert(closed[i].endTime >= before && closed[i].startTime <= closed[i].endTime);
+        const std::string segment = readFile(closed[i].file);
+        assert(segment.compare(0, header.size(), header) == 0 && segment.back() == '\n');
+        rows += segment.substr(header.size());
+    }
+    assert(rows.find("1001,") == 0 && rows.find("1006,") != std::string::npos);
+    // Index reads and appends are counted with the journal: 3 data files, 2 index reads, 3 index appends
+    std::uint64_t segmentBytes = 0;
+    for (const SegmentInfo& segment : closed) segmentBytes += segment.bytes;
+    assert(io.bytesWritten == segmentBytes + readFile(segment_index::indexPath(path)).size());
+    assert(io.filesOpened == 8);
+    assert(segment_index::filesInRange(path, 0, closed.front().startTime).empty());
+    assert(segment_index::allFiles(path).size() == 3);
+
+    {
+        std::ofstream out(departures);
+        out << header << "1002,Owner,P,M,C,F,1,a@b.c,None,Cash,S1,Small,40,No," << stamp << "\n";
+    }
+    ParkingLot lot; lot.setSilentMode(true);
+    assert(loadLotFromCsv(lot, path, departures).restored == 5);
+    assert(lot.getCarByID(1006).id == 1006 && lot.getCarByID(1002).id == 0);
+
+    assert(segment_index::archiveBefore(path, closed.back().endTime + 1, archiveDir) == 3);
+    for (const std::string& file : segment_index::allFiles(path)) {
+        assert(file.compare(0, archiveDir.size(), archiveDir) == 0);
+        assert(fileExists(file));
+        std::remove(file.c_str());
+    }
+    std::remove(segment_index::indexPath(path).c_str());
+    std::remove(departures.c_str());
+    ::rmdir(archiveDir.c_str());
+}
+
+/**
+ * @brief Tests that segments are selected by the timestamps of their records, not when they were rotated.
+ *
+ * Bills stamped long before their segment became active (as when they wait in the persistence
+ * queue across a rotation) must still be found by a reconciliation of their day, and index lines
+ * written without record times must still be read.
+ */
+void testSegmentIndexRecordTimes() {
+    const std::string path = testFilePath("segmented_bills.bin");
+    std::remove(segment_index::indexPath(path).c_str());
+    for (int sequence = 1; sequence <= 2; ++sequence) std::remove(segment_index::segmentPath(path, sequence).c_str());
+
+    const std::int64_t day = 1704067200;
+    Car car = createCar(1001, "Alice", true, 50);
+    car.parkingTime = std::chrono::system_clock::from_time_t(day);
+    ParkingLot lot; lot.setSilentMode(true);
+    const auto exit = car.parkingTime + std::chrono::hours(2);
+    const BillRecord record = bill_records::makeRecord(car, lot.calculateFeeBreakdown(car, exit), exit);
+
+    JournalOptions options;
+    options.flushBytes = 0;
+    options.segmentBytes = sizeof(bill_records::FILE_MAGIC) + 2 * bill_records::RECORD_SIZE;
+    {
+        JournalWriter journal(path, std::string(bill_records::FILE_MAGIC, sizeof(bill_records::FILE_MAGIC)), options);
+        for (int i = 0; i < 4; ++i) {
+            BillRecord bill = record;
+            bill.exitTime += i < 2 ? 0 : 86400;
+            std::string data;
+            bill_records::encode(data, bill);
+            journal.append(data.data(), data.size(), bill.exitTime);
+        }
+    }
+
+    const std::vector<SegmentInfo> closed = segment_index::readClosed(path);
+    assert(closed.size() == 2 && closed[0].startTime > day + 86400);
+    assert(closed[0].firstRecord == record.exitTime && closed[1].firstRecord == record.exitTime + 86400);
+    assert(closed[1].lastRecord == closed[1].endTime);
+    const std::vector<std::string> files = segment_index::filesInRange(path, day, day + 86400);
+    assert(files.size() == 1 && files[0] == closed[0].file);
+    const BillTotals totals = bill_records::reconcileSegments(path, day, day + 86400);
+    assert(totals.bills == 2 && totals.totalCents == 2 * record.totalCents);
+
+    {
+        std::ofstream index(segment_index::indexPath(path), std::ios::app);
+        index << "3\t100\t200\t50\t" << path << ".000003\n";
+    }
+    const std::vector<SegmentInfo> upgraded = segment_index::readClosed(path);
+    assert(upgraded.size() == 3 && upgraded[2].firstRecord == 100 && upgraded[2].lastRecord == 200);
+    assert(upgraded[2].file == path + ".000003");
+
+    std::remove(segment_index::indexPath(path).c_str());
+    for (const SegmentInfo& segment : closed) std::remove(segment.file.c_str());
+}
+
+/**
+ * @brief Tests that the CSV reader handles quoting, line endings and repeated headers in place.
+ *
+ * Quoted fields may hold delimiters, escaped quotes and line breaks; CRLF endings, empty lines and
+ * repeated header rows must not show up as records, and a field limit must split only the leading columns.
+ */
+void testCsvReaderStreamsQuotedFields() {
+    const std::string path = testFilePath("reader.csv");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "CarID,OwnerName,Note\r\n"
+            << "1001,Asha,plain\r\n"
+            << "\n"
+            << "1002,\"Rao, K\",\"said \"\"hi\"\"\"\n"
+            << "CarID,OwnerName,Note\r\n"
+            << "1003,\"Multi\nLine\",\n"
+            << "1004,Last,\"unterminated";
+    }
+
+    CsvReader reader(path);
+    assert(reader.isOpen());
+    assert(reader.header().size() == 3 && reader.column("Note") == 2 && reader.column("Rate") == -1);
+
+    assert(reader.next() && reader.fields().size() == 3);
+    assert(reader.field(0).equals("1001") && reader.field(2).equals("plain"));
+    assert(reader.raw().equals("1001,Asha,plain"));
+
+    assert(reader.next());
+    assert(reader.field(1).equals("Rao, K") && reader.field(2).equals("said \"hi\""));
+
+    assert(reader.next() && reader.getRepeatedHeaderCount() == 1);
+    assert(reader.field(0).equals("1003") && reader.field(1).equals("Multi\nLine"));
+    assert(reader.fields().size() == 3 && reader.field(2).empty() && reader.field(7).empty());
+
+    assert(reader.next() && reader.field(2).equals("unterminated"));
+    assert(!reader.next() && reader.getRecordCount() == 4);
+
+    CsvReader missing(testFilePath("reader_missing.csv"));
+    assert(!missing.isOpen() && !missing.next());
+
+    CsvReader firstColumns(path);
+    firstColumns.setFieldLimit(2);
+    assert(firstColumns.next() && firstColumns.fields().size() == 2 && firstColumns.field(1).equals("Asha"));
+    assert(firstColumns.next() && firstColumns.fields().size() == 2 && firstColumns.field(1).equals("Rao, K"));
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that the session archive round-trips the CSV history at a tenth of its size.
+ *
+ * Sessions archived from the CSV files must decode to the same cars and times. In a multi-chunk
+ * archive with one damaged column, every other column must still decode on its own.
+ */
+void testSessionArchiveRoundTrip() {
+    const std::string admissions = testFilePath("archive_cars.csv");
+    const std::string departures = testFilePath("archive_departures.csv");
+    const std::string archive = testFilePath("sessions.parc");
+    const std::string columns =
+        "CarID,OwnerName,LicensePlate,Model,Color,FuelType,Phone,Email,Membership,PaymentMethod,Slot,Size,Rate,DynamicPricing,";
+    const char* fuels[] = { "Petrol", "Diesel", "Electric", "CNG" };
+    const char* payments[] = { "Cash", "Card", "UPI" };
+    const char* sizes[] = { "Small", "Medium", "Large" };
+    const char* memberships[] = { "None", "Silver", "Gold" };
+    const auto stamp = [](std::time_t t) { std::string text = std::ctime(&t); text.pop_back(); return text; };
+    const std::time_t base = 1704103200;
+    {
+        std::ofstream cars(admissions), out(departures);
+        cars << columns << "EntryTime\n";
+        out << columns << "RemovedTime\n";
+        for (int i = 0; i < 3000; ++i) {
+            const int customer = i % 120;
+            const std::string row = std::to_string(1001 + i) + ",Owner " + std::to_string(customer) +
+                ",KA01AB" + std::to_string(1000 + customer) + ",Model " + std::to_string(customer % 7) +
+                ",Blue," + fuels[customer % 4] + ",98450" + std::to_string(10000 + customer) +
+                ",owner" + std::to_string(customer) + "@example.com," + memberships[customer % 3] + "," +
+                payments[i % 3] + ",S" + std::to_string(i % 40 + 1) + "," + sizes[customer % 3] + "," +
+                (customer % 2 ? "60" : "42.5") + "," + (i % 5 ? "No" : "Yes") + ",";
+            const std::time_t entry = base + i * 240;
+            cars << row << stamp(entry) << "\n";
+            out << row << stamp(entry + 1800 + (i * 37) % 7200) << "\n";
+        }
+    }
+
+    const ArchiveStats stats = archiveSessionsFromCsv(departures, admissions, archive);
+    assert(stats.sessions == 3000 && stats.unmatched == 0 && stats.skipped == 0);
+    assert(stats.archiveBytes > 0 && stats.archiveBytes * 10 <= stats.csvBytes);
+
+    std::vector<Car> cars;
+    std::vector<std::int64_t> exits;
+    {
+        SessionArchiveReader reader(archive);
+        assert(reader.isOpen() && reader.nextChunk() && reader.rows() == 3000);
+        assert(reader.decodeSessions(cars, exits));
+        assert(!reader.nextChunk() && !reader.isCorrupt());
+    }
+    const Car& last = cars.back();
+    assert(last.id == 4000 && last.ownerName == "Owner 119" && last.licensePlate == "KA01AB1119");
+    assert(last.fuelType == "CNG" && last.paymentMethod == "UPI" && last.slot == "S40" && last.slotSize == "Large");
+    assert(last.hourlyRate == 60 && !last.dynamicPricing && cars[0].dynamicPricing && cars[0].hourlyRate == 42.5);
+    assert(std::chrono::system_clock::to_time_t(last.parkingTime) == base + 2999 * 240);
+    assert(exits.back() == base + 2999 * 240 + 1800 + (2999 * 37) % 7200);
+
+    {
+        SessionArchiveWriter writer(archive, 4);
+        for (int i = 0; i < 10; ++i) assert(writer.append(cars[i], cars[i].parkingTime + std::chrono::hours(1)));
+        assert(writer.close() && writer.getSessionCount() == 10);
+    }
+    // Damage the first chunk's Owner column; the other columns still decode.
+    std::string bytes = readFile(archive);
+    const std::size_t ownerAt = 8 + 4 + 16 * 12 + 4 + car_codec::getU32(bytes.data() + 8 + 4 + 4);
+    bytes[ownerAt + 2] ^= 0x5a;
+    { std::ofstream out(archive, std::ios::binary | std::ios::trunc); out << bytes; }
+
+    SessionArchiveReader reader(archive);
+    std::vector<std::int64_t> ids;
+    std::vector<FieldView> values;
+    std::size_t chunks = 0, rows = 0;
+    while (reader.nextChunk()) {
+        assert(reader.decodeIntegers(SessionColumn::Id, ids) && ids.size() == reader.rows());
+        assert(ids.front() == 1001 + static_cast<std::int64_t>(rows));
+        assert(reader.decodeStrings(SessionColumn::Payment, values) && values[1].equals(payments[(rows + 1) % 3]));
+        assert(reader.decodeStrings(SessionColumn::Owner, values) == (chunks > 0));
+        assert(!reader.decodeStrings(SessionColumn::ExitTime, values));
+        rows += reader.rows();
+        ++chunks;
+    }
+    assert(chunks == 3 && rows == 10 && !reader.isCorrupt());
+
+    // ID 1001 was issued twice; each departure pairs with the admission of its own session.
+    {
+        std::ofstream cars(admissions, std::ios::trunc), out(departures, std::ios::trunc);
+        const std::string row = ",Owner,KA01,Swift,Red,Petrol,9876543210,o@x.com,Gold,UPI,A1,Small,50,No,";
+        cars << columns << "EntryTime\n" << "1001" << row << stamp(base) << "\n" << "1002" << row << stamp(base + 10) << "\n"
+             << "1001" << row << stamp(base + 100) << "\n";
+        out << columns << "RemovedTime\n" << "1001" << row << stamp(base + 50) << "\n" << "1001" << row << stamp(base + 200) << "\n"
+            << "1002" << row << stamp(base + 300) << "\n" << "1001" << row << stamp(base + 400) << "\n";
+    }
+    const ArchiveStats reused = archiveSessionsFromCsv(departures, admissions, archive);
+    assert(reused.sessions == 4 && reused.unmatched == 1);
+    SessionArchiveReader reusedReader(archive);
+    assert(reusedReader.nextChunk() && reusedReader.decodeSessions(cars, exits));
+    assert(std::chrono::system_clock::to_time_t(cars[0].parkingTime) == base);
+    assert(std::chrono::system_clock::to_time_t(cars[1].parkingTime) == base + 100);
+    assert(std::chrono::system_clock::to_time_t(cars[2].parkingTime) == base + 10);
+    assert(std::chrono::system_clock::to_time_t(cars[3].parkingTime) == base + 400);  // unmatched: entry = exit
+
+    std::remove(admissions.c_str());
+    std::remove(departures.c_str());
+    std::remove(archive.c_str());
+}
+
+/**
+ * @brief Tests when each durability mode writes and syncs rows.
+ *
+ * Per-event durability writes and syncs every row at once. Group commit holds rows until the
+ * record count or the interval is reached, then writes and syncs them together; behind the
+ * persistence queue the interval must still be honoured when no further rows arrive.
+ */
+void testJournalDurabilityModes() {
+    const std::string path = testFilePath("durable.txt");
+    JournalOptions options;
+    options.flushInterval = std::chrono::hours(1);
+    {
+        JournalWriter journal(path, "", options);
+        journal.append("a\n");
+        assert(journal.flush() && journal.getSyncCount() == 0);
+    }
+    std::remove(path.c_str());
+
+    options.durability = Durability::FsyncPerEvent;
+    {
+        JournalWriter journal(path, "", options);
+        for (int i = 0; i < 3; ++i) journal.append("b\n");
+        assert(readFile(path) == "b\nb\nb\n" && journal.getSyncCount() == 3);
+        assert(journal.flushDeadline() == std::chrono::steady_clock::time_point::max());
+    }
+    std::remove(path.c_str());
+
+    options.durability = Durability::GroupCommit;
+    options.groupCommitRecords = 4;
+    options.groupCommitInterval = std::chrono::milliseconds(20);
+    {
+        JournalWriter journal(path, "", options);
+        for (int i = 0; i < 3; ++i) journal.append("c\n");
+        assert(!fileExists(path) && journal.getSyncCount() == 0);
+        assert(journal.flushDeadline() <= std::chrono::steady_clock::now() + options.groupCommitInterval);
+        journal.append("c\n");
+        assert(readFile(path) == "c\nc\nc\nc\n" && journal.getSyncCount() == 1);
+
+        journal.append("d\n");
+        journal.flushIfDue();
+        assert(journal.getBufferedBytes() == 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        journal.flushIfDue();
+        assert(journal.getBufferedBytes() == 0 && journal.getSyncCount() == 2);
+    }
+    std::remove(path.c_str());
+
+    options.groupCommitRecords = 1000;
+    {
+        JournalWriter journal(path, "", options);
+        PersistenceQueue queue;
+        assert(queue.submit(journal, "e\n", 2));
+        std::this_thread::sleep_for(std::chrono::milliseconds(80));
+        queue.withIoLock([&journal] { assert(journal.getBufferedBytes() == 0 && journal.getSyncCount() == 1); });
+    }
+    assert(readFile(path) == "e\n");
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that the lot records through its storage backend: in memory, as a replayable binary
+ *        log, and as the CSV files under a path prefix.
+ */
+void testStorageBackends() {
+    MemoryStorage* memory = new MemoryStorage();
+    {
+        ParkingLot lot{std::unique_ptr<StorageBackend>(memory)};
+        lot.setSilentMode(true);
+        lot.setPersistenceEnabled(true);
+        const Car car = createCar(1, "Mem1");
+        lot.testAddCar(car);
+        lot.saveCarToCSV(car);
+        assert(lot.removeCarByIdAndOwner(1, "Mem1"));
+        assert(memory->getAdmissions().size() == 1 && memory->getAdmissions()[0].ownerName == "Mem1");
+        assert(memory->getDepartures().size() == 1 && memory->getDepartures()[0].car.id == 1);
+        assert(memory->getBills().size() == 1 && memory->getBills()[0].find("Mem1") != std::string::npos);
+        assert(memory->getBillRecords().size() == 1 && memory->getBillRecords()[0].carId == 1);
+
+        lot.setSilentMode(true);  // silent mode alone records nothing, as before
+        lot.testAddCar(createCar(2, "Mem2"));
+        assert(lot.removeCarByIdAndOwner(2, "Mem2") && memory->getDepartures().size() == 1);
+    }
+
+    const std::string logPath = testFilePath("parking_data.bin");
+    std::chrono::system_clock::time_point removedAt;
+    {
+        ParkingLot lot(makeStorageBackend(StorageKind::BinaryLog, "parking_test_"));
+        lot.setSilentMode(true);
+        lot.setPersistenceEnabled(true);
+        lot.enableAsyncPersistence();
+        const Car car = createCar(3, "Bin3", true, 80.0);
+        lot.testAddCar(car);
+        lot.saveCarToCSV(car);
+        assert(lot.removeCarByIdAndOwner(3, "Bin3"));
+        lot.flushJournals();
+    }
+    {
+        std::ofstream tail(logPath, std::ios::binary | std::ios::app);
+        tail << "torn";
+    }
+    MemoryStorage replayed;
+    assert(BinaryLogStorage::replay(logPath, replayed) == 4);
+    assert(replayed.getAdmissions().size() == 1 && replayed.getAdmissions()[0].ownerName == "Bin3");
+    assert(replayed.getAdmissions()[0].dynamicPricing && replayed.getAdmissions()[0].hourlyRate == 80.0);
+    assert(replayed.getDepartures().size() == 1 && replayed.getDepartures()[0].car.id == 3);
+    removedAt = replayed.getDepartures()[0].removedAt;
+    assert(replayed.getBillRecords().size() == 1 &&
+           replayed.getBillRecords()[0].exitTime == std::chrono::system_clock::to_time_t(removedAt));
+    assert(replayed.getBills().size() == 1 && replayed.getBills()[0].find("Bin3") != std::string::npos);
+    std::remove(logPath.c_str());
+
+    const std::string carsPath = testFilePath("cars_data.csv");
+    const std::string departuresPath = testFilePath("Customer_details.csv");
+    const std::string billsPath = testFilePath("bill_history.txt");
+    const std::string recordsPath = testFilePath("bill_records.bin");
+    {
+        ParkingLot lot(makeStorageBackend(StorageKind::Csv, "parking_test_"));
+        lot.setSilentMode(true);
+        lot.setPersistenceEnabled(true);
+        const Car car = createCar(4, "Csv4");
+        lot.testAddCar(car);
+        lot.saveCarToCSV(car);
+        assert(lot.removeCarByIdAndOwner(4, "Csv4"));
+        lot.flushJournals();
+    }
+    assert(readFile(carsPath).compare(0, 6, "CarID,") == 0 && readFile(carsPath).find("\n4,Csv4,") != std::string::npos);
+    assert(readFile(departuresPath).find("RemovedTime\n4,Csv4,") != std::string::npos);
+    assert(readFile(billsPath).find("Csv4") != std::string::npos);
+    assert(bill_records::reconcile(recordsPath, 0, std::numeric_limits<std::int64_t>::max()).bills == 1);
+    for (const std::string& path : {carsPath, departuresPath, billsPath, recordsPath}) std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that the ring logger formats deferred arguments, caps long strings per argument,
+ *        filters by level and writes every message from concurrent producers in per-thread order.
+ */
+void testRingLogger() {
+    const std::string path = testFilePath("logger.txt");
+    {
+        JournalWriter journal(path);
+        Logger logger(journal, 4096);
+        assert(!logger.log(LogLevel::Debug, "hidden {}", 1));
+        assert(logger.log(LogLevel::Warn, "car {} owner {} fee {} left {}", 1001, std::string("Asha"), 52.5));
+        logger.setLevel(LogLevel::Debug);
+        assert(logger.log(LogLevel::Debug, "long {} then {}", std::string(200, 'x'), "tail"));
+        logger.flush();
+        const std::string text = readFile(path);
+        assert(text.find("hidden") == std::string::npos);
+        assert(text.find(" WARN  car 1001 owner Asha fee 52.5 left {}\n") != std::string::npos);
+        assert(text.find(" DEBUG long " + std::string(Logger::TEXT_ARG_BYTES, 'x') + " then tail\n") != std::string::npos);
+        assert(text.size() > 4 && text[4] == '-' && text[10] == ' ' && text[19] == '.');
+
+        const int perThread = 2000;
+        auto produce = [&logger](int worker) {
+            for (int i = 0; i < perThread; ++i)
+                while (!logger.log(LogLevel::Info, "worker {} message {}", worker, i)) std::this_thread::yield();
+        };
+        std::thread a(produce, 1), b(produce, 2);
+        a.join();
+        b.join();
+        logger.flush();
+        const LoggerStats stats = logger.getStats();
+        assert(stats.written == stats.logged && stats.logged == 2 + 2 * perThread);
+    }
+
+    std::istringstream lines(readFile(path));
+    std::string line;
+    int next[3] = {0, 0, 0};
+    while (std::getline(lines, line)) {
+        const size_t at = line.find("worker ");
+        if (at == std::string::npos) continue;
+        int worker = 0, message = 0;
+        assert(std::sscanf(line.c_str() + at, "worker %d message %d", &worker, &message) == 2);
+        assert(message == next[worker]++);
+    }
+    assert(next[1] == 2000 && next[2] == 2000);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that latency histograms report percentiles within their bucket precision and that
+ *        the lot times its operations only while tracking is on.
+ */
+void testLatencyHistograms() {
+    LatencyHistogram histogram;
+    assert(histogram.percentile(0.5) == 0 && histogram.count() == 0);
+    for (std::uint64_t v = 1; v <= 100000; ++v) histogram.record(v);
+    assert(histogram.count() == 100000 && histogram.max() == 100000);
+    const std::uint64_t p50 = histogram.percentile(0.50), p99 = histogram.percentile(0.99);
+    assert(p50 >= 50000 && p50 <= 50000 * 103 / 100);
+    assert(p99 >= 99000 && p99 <= 100000);
+    assert(histogram.percentile(1.0) == 100000 && histogram.percentile(0.0) == 1);
+    assert(histogram.mean() > 50000.0 && histogram.mean() < 50001.0);
+
+    LatencyHistogram slow;
+    slow.record(5000000000ULL);
+    slow.record(10);
+    histogram.merge(slow);
+    assert(histogram.count() == 100002 && histogram.max() == 5000000000ULL);
+    assert(histogram.percentile(1.0) == 5000000000ULL);
+    histogram.reset();
+    assert(histogram.count() == 0 && histogram.percentile(0.99) == 0);
+
+    ParkingLot lot;
+    lot.setSilentMode(true);
+    lot.testAddCar(createCar(1, "Lat1"));
+    lot.testAddCar(createCar(2, "Lat2"));
+    lot.getCarByID(1);
+    assert(lot.getLatency(LotOperation::Lookup).count() == 0);
+
+    lot.setLatencyTracking(true);
+    for (int i = 0; i < 10; ++i) lot.getCarByID(2);
+    lot.calculateFee(lot.getCarByID(1));
+    assert(lot.removeCarByIdAndOwner(1, "Lat1"));
+    assert(lot.getLatency(LotOperation::Lookup).count() == 11);
+    assert(lot.getLatency(LotOperation::Fee).count() == 1);
+    assert(lot.getLatency(LotOperation::Remove).count() == 1);
+    assert(lot.getLatency(LotOperation::Park).count() == 0);
+
+    const std::string path = testFilePath("latency.txt");
+    assert(lot.dumpLatencies(path));
+    const std::string report = readFile(path);
+    assert(report.find("p99.9_us") != std::string::npos && report.find("\nlookup             11 ") != std::string::npos);
+    std::remove(path.c_str());
+    lot.resetLatencies();
+    assert(lot.getLatency(LotOperation::Lookup).count() == 0);
+}
+
+/**
+ * @brief Tests that the lot's live counters track admissions, departures, refusals and revenue,
+ *        and that the exporter writes them in Prometheus text format.
+ */
+void testLotMetrics() {
+    MemoryStorage* memory = new MemoryStorage();
+    ParkingLot lot(std::unique_ptr<StorageBackend>(memory), 10);
+    lot.setSilentMode(true);
+    lot.setPersistenceEnabled(true);
+    lot.setSlotCapacity(SlotClass::Medium, 2);
+    for (int id = 1; id <= 3; ++id) {
+        Car car = createCar(id, "Met" + std::to_string(id), false, 60.0);
+        car.parkingTime -= std::chrono::hours(3);
+        lot.testAddCar(car);
+    }
+    assert(lot.removeCarByIdAndOwner(1, "Met1"));
+
+    const LotMetrics& metrics = lot.getMetrics();
+    assert(metrics.admissions.load() == 2 && metrics.departures.load() == 1 && metrics.bills.load() == 1);
+    assert(metrics.occupancy[static_cast<size_t>(SlotClass::Medium)].load() == 1);
+    assert(metrics.slotCapacity[static_cast<size_t>(SlotClass::Medium)].load() == 2);
+    assert(metrics.slotCapacity[static_cast<size_t>(SlotClass::Small)].load() == 10);
+    assert(metrics.revenueCents.load() > 0 &&
+           static_cast<std::int64_t>(metrics.revenueCents.load()) == memory->getBillRecords()[0].totalCents);
+
+    MetricsSnapshot before = takeSnapshot(metrics, nullptr, nullptr);
+    before.takenAt -= std::chrono::seconds(2);
+    before.admissions -= 2;
+    const MetricsSnapshot now = takeSnapshot(metrics, nullptr, &before);
+    assert(now.admissionsPerSecond > 0.99 && now.admissionsPerSecond < 1.01);
+    assert(formatStatsTable(now).find("Medium             1          2") != std::string::npos);
+
+    const std::string path = testFilePath("metrics.prom");
+    {
+        MetricsExporter exporter(metrics, path, std::chrono::milliseconds(10));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        assert(exporter.getExportCount() >= 2);
+    }
+    const std::string text = readFile(path);
+    assert(text.find("# TYPE parking_admissions_total counter\nparking_admissions_total 2\n") != std::string::npos);
+    assert(text.find("parking_occupancy{size=\"medium\"} 1\n") != std::string::npos);
+    assert(text.find("parking_bills_total 1\n") != std::string::npos);
+    assert(text.find("parking_persistence_queue_depth 0\n") != std::string::npos);
+    assert(!fileExists(path + ".tmp"));
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that trace spans are written as Chrome trace "X" events only while a trace is active.
+ */
+void testTraceSpans() {
+    const std::string path = testFilePath("trace.json");
+    { trace::Span idle("before.begin"); }
+    assert(trace::begin(path));
+    assert(trace::active());
+    {
+        trace::Span outer("gate.remove");
+        trace::Span inner("fee.calculate");
+    }
+    assert(trace::spanCount() == 2);
+    trace::end();
+    assert(!trace::active());
+    { trace::Span idle("after.end"); }
+
+    const std::string json = readFile(path);
+    assert(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+    assert(json.find("\"name\":\"gate.remove\",\"cat\":\"parking\",\"ph\":\"X\"") != std::string::npos);
+    assert(json.find("\"name\":\"fee.calculate\"") != std::string::npos);
+    assert(json.find("before.begin") == std::string::npos && json.find("after.end") == std::string::npos);
+    assert(json.substr(json.size() - 4) == "\n]}\n");
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that each journal counts its rows, bytes, opens and syscalls, and that the lot
+ *        reports them per kind of record and in total with the session log.
+ */
+void testIoAccounting() {
+    const std::string carsPath = testFilePath("io_cars_data.csv");
+    const std::string departuresPath = testFilePath("io_Customer_details.csv");
+    const std::string billsPath = testFilePath("io_bill_history.txt");
+    const std::string recordsPath = testFilePath("io_bill_records.bin");
+    const std::string logPath = testFilePath("io_session_log.txt");
+    {
+        JournalWriter logJournal(logPath);
+        Logger log(logJournal);
+        ParkingLot lot(makeStorageBackend(StorageKind::Csv, "parking_test_io_"));
+        lot.setSilentMode(true);
+        lot.setPersistenceEnabled(true);
+        lot.setLogger(&log);
+        JournalOptions writeThrough;
+        writeThrough.flushBytes = 0;
+        lot.setJournalOptions(writeThrough);
+        for (int id = 1; id <= 3; ++id) {
+            const Car car = createCar(id, "Io" + std::to_string(id));
+            lot.testAddCar(car);
+            lot.saveCarToCSV(car);
+        }
+        assert(lot.removeCarByIdAndOwner(2, "Io2"));
+        log.flush();
+
+        // One open and fstat, then one write for the header and one per row: no reopen per record
+        const IoStats cars = lot.getIoStats(StorageStream::Admissions);
+        assert(cars.records == 3 && cars.filesOpened == 1 && cars.syscalls == 2 + 1 + 3);
+        assert(cars.bytesWritten == readFile(carsPath).size());
+        const IoStats bills = lot.getIoStats(StorageStream::Bills);
+        assert(bills.records == 1 && bills.filesOpened == 1 && bills.syscalls == 2 + 1);
+        assert(bills.bytesWritten == readFile(billsPath).size());
+
+        const IoStats logIo = log.getJournal().getIoStats();
+        assert(logIo.records >= 1 && logIo.bytesWritten == readFile(logPath).size());
+        const IoStats total = lot.getTotalIoStats();
+        assert(total.filesOpened == 5);
+        assert(total.bytesWritten == cars.bytesWritten + bills.bytesWritten + logIo.bytesWritten +
+                                     readFile(departuresPath).size() + readFile(recordsPath).size());
+
+        const std::string report = lot.ioReport();
+        assert(report.find(carsPath) != std::string::npos && report.find(logPath) != std::string::npos);
+        assert(report.find("\ntotal ") != std::string::npos);
+
+        MemoryStorage* memory = new MemoryStorage();
+        ParkingLot memoryLot{std::unique_ptr<StorageBackend>(memory)};
+        assert(memoryLot.getIoStats(StorageStream::Admissions).syscalls == 0);
+    }
+    for (const std::string& path : {carsPath, departuresPath, billsPath, recordsPath, logPath}) std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that the lot writes its table and bills to the injected sink, and nothing to a null sink.
+ */
+void testOutputSinks() {
+    std::ostringstream captured;
+    ConsoleSink console(captured);
+    ParkingLot lot{std::unique_ptr<StorageBackend>(new MemoryStorage())};
+    lot.setSilentMode(true);
+    lot.setOutput(&console);
+    lot.testAddCar(createCar(1, "Out1"));
+    lot.testAddCar(createCar(2, "Out2"));
+    lot.displayCars();
+    assert(captured.str().find("Dyn?") != std::string::npos);
+    assert(captured.str().find("1\tOut1\t") != std::string::npos && captured.str().find("2\tOut2\t") != std::string::npos);
+    assert(lot.removeCarByIdAndOwner(1, "Out1"));
+    assert(captured.str().find("Out1") != captured.str().rfind("Out1"));
+
+    const std::size_t before = captured.str().size();
+    lot.setOutput(nullptr);
+    assert(!lot.getOutput().enabled());
+    lot.displayCars();
+    assert(lot.removeCarByIdAndOwner(2, "Out2"));
+    assert(captured.str().size() == before);
+
+    const std::string path = testFilePath("output.txt");
+    {
+        BufferedFileSink file(path);
+        lot.setOutput(&file);
+        lot.displayCars();
+        assert(!fileExists(path));
+        file.flush();
+        assert(readFile(path).find("No cars parked.") != std::string::npos);
+        lot.setOutput(nullptr);
+    }
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that replayed gate events park, remove, quote and display cars, and that malformed
+ *        lines are counted and skipped.
+ */
+void testEventReplay() {
+    MemoryStorage* memory = new MemoryStorage();
+    ParkingLot lot(std::unique_ptr<StorageBackend>(memory), 10);
+    lot.setSilentMode(true);
+    lot.setPersistenceEnabled(true);
+    lot.setSlotCapacity(SlotClass::Large, 1);
+    std::ostringstream captured;
+    ConsoleSink console(captured);
+    lot.setOutput(&console);
+
+    std::istringstream events(
+        "# gate 1 feed\n"
+        "PARK|Rep1|KA01|Swift|Red|Petrol|9876543210|rep1@x.com|Gold|Card|A1|Small|n|G1|60|n|2\n"
+        "PARK|Rep2|KA02|XUV|Blue|Diesel|9876543211|rep2@x.com|None|Cash|B1|Large|y|G2|80|n|0\r\n"
+        "PARK|Rep3|KA03|XUV|Grey|Diesel|9876543212|rep3@x.com|None|Cash|B2|Large|n|G2|80|n|0\n"
+        "\n"
+        "QUOTE|1001\n"
+        "QUOTE|99\n"
+        "DISPLAY\n"
+        "REMOVE|1001|Rep1\n"
+        "REMOVE|1002|Nobody\n"
+        "PARK|Bad|KA04|Alto|White|Petrol|98x|bad@x.com|None|Cash|A2|Small|n|G1|50|n|0\n"
+        "PARK|Short|KA05\n"
+        "REMOVE|abc|Rep2\n"
+        "LEAVE|2\n");
+    const GateReplayStats stats = replayGateEvents(lot, events);
+    assert(stats.events == 8 && stats.rejected == 4);
+    assert(stats.parked == 2 && stats.refused == 1);
+    assert(stats.quotes == 1 && stats.displays == 1 && stats.removed == 1 && stats.unknownCars == 2);
+    assert(stats.firstError == "line 11: phone must be digits");
+    assert(lot.getCarCount() == 1 && lot.getCarByID(1002).ownerName == "Rep2");
+    assert(memory->getAdmissions().size() == 2 && memory->getDepartures().size() == 1);
+    assert(memory->getDepartures()[0].car.licensePlate == "KA01" && memory->getBillRecords()[0].totalCents > 0);
+    assert(captured.str().find("1002\tRep2\tKA02\t") != std::string::npos);
+
+    const std::string report = formatReplayReport(stats);
+    assert(report.find("Replayed 8 events") == 0);
+    assert(report.find("Rejected 4 malformed line(s); first at line 11") != std::string::npos);
+    lot.setOutput(nullptr);
+}
+
+/**
+ * @brief Tests that gate records round-trip through appendParkRecord and parseGateCommand, and that
+ *        every field is validated.
+ */
+void testGateProtocol() {
+    AdmissionRequest request;
+    request.ownerName = "Gate|One";
+    request.licensePlate = "KA01AB1234";
+    request.model = "Swift";
+    request.color = "Red";
+    request.fuelType = "Petrol";
+    request.phone = "9876543210";
+    request.email = "gate@x.com";
+    request.membership = "Gold";
+    request.paymentMethod = "UPI";
+    request.slot = "A7";
+    request.slotSize = "Medium";
+    request.reservedSlot = true;
+    request.exitGate = "G2";
+    request.hourlyRate = 72.5;
+    request.dynamicPricing = true;
+    request.parkingHours = 1.25;
+    std::string record;
+    appendParkRecord(request, record);
+    assert(record.back() == '\n' && std::count(record.begin(), record.end(), '|') == 16);
+
+    GateCommand command;
+    assert(parseGateCommand(record, command) == nullptr);
+    const AdmissionRequest& parsed = command.admission;
+    assert(command.type == GateCommandType::Park && parsed.ownerName == "Gate One");
+    assert(parsed.licensePlate == "KA01AB1234" && parsed.phone == "9876543210" && parsed.email == "gate@x.com");
+    assert(parsed.slot == "A7" && parsed.slotSize == "Medium" && parsed.exitGate == "G2");
+    assert(parsed.reservedSlot && parsed.dynamicPricing && parsed.hourlyRate == 72.5 && parsed.parkingHours == 1.25);
+
+    // Values %g would print with an exponent, or outside the accepted range, still parse
+    const double rates[] = {1e-7, 0.000001, 1e5, 123456.0, -3.0, 0.1 + 0.2};
+    const double hours[] = {1e-9, 2.5e-5, 8784.0, 1e20, -1.0, 1.0 / 3.0};
+    for (int i = 0; i < 6; ++i) {
+        request.hourlyRate = rates[i];
+        request.parkingHours = hours[i];
+        record.clear();
+        appendParkRecord(request, record);
+        assert(parseGateCommand(record, command) == nullptr);
+        assert(std::fabs(command.admission.hourlyRate - std::min(std::max(rates[i], 0.0), MAX_GATE_HOURLY_RATE)) < 1e-6);
+        assert(std::fabs(command.admission.parkingHours - std::min(std::max(hours[i], 0.0), MAX_GATE_PARKING_HOURS)) < 1e-6);
+    }
+    request.hourlyRate = 0.1 + 0.2;
+    record.clear();
+    appendParkRecord(request, record);
+    assert(record.find("|0.3|y|") != std::string::npos);
+
+    assert(parseGateCommand("REMOVE|1001|Gate One\r\n", command) == nullptr);
+    assert(command.type == GateCommandType::Remove && command.carId == 1001 && command.owner == "Gate One");
+    assert(parseGateCommand("QUOTE|42", command) == nullptr && command.type == GateCommandType::Quote && command.carId == 42);
+    assert(parseGateCommand("LOOKUP|7\n", command) == nullptr && command.type == GateCommandType::Lookup && command.carId == 7);
+    assert(parseGateCommand("DISPLAY", command) == nullptr && command.type == GateCommandType::Display);
+
+    const std::string good = "PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|50|n|0";
+    assert(parseGateCommand(good, command) == nullptr);
+    assert(std::string(parseGateCommand("PARK|O|P|M|C|F|12a|a@b|S|Cash|A1|Small|n|G1|50|n|0", command)) == "phone must be digits");
+    assert(std::string(parseGateCommand("PARK|O|P|M|C|F||a@b|S|Cash|A1|Small|n|G1|50|n|0", command)) == "phone must be digits");
+    assert(std::string(parseGateCommand("PARK|O|P|M|C|F|123|ab|S|Cash|A1|Small|n|G1|50|n|0", command)) == "email must contain '@'");
+    assert(std::string(parseGateCommand("PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|x|G1|50|n|0", command)) == "reserved slot must be y or n");
+    assert(std::string(parseGateCommand("PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|-5|n|0", command)) == "hourly rate must be a number from 0 to 100000");
+    const char* const badNumbers[] = {"inf", "nan", "1e300", "0x10", " 5", "5 ", "+5", "1.2.3", ".", "100001"};
+    for (const char* bad : badNumbers) {
+        const std::string rate = "PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|" + std::string(bad) + "|n|0";
+        assert(std::string(parseGateCommand(rate, command)) == "hourly rate must be a number from 0 to 100000");
+        const std::string hours = "PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|50|n|" + std::string(bad);
+        assert(std::string(parseGateCommand(hours, command)) == "hours must be a number from 0 to 8784");
+    }
+    assert(std::string(parseGateCommand("PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|50|n|8785", command)) ==
+           "hours must be a number from 0 to 8784");
+    assert(parseGateCommand("PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|100000|n|8784", command) == nullptr);
+    assert(parseGateCommand("PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|.5|n|2.", command) == nullptr);
+    assert(command.admission.hourlyRate == 0.5 && command.admission.parkingHours == 2.0);
+    assert(std::string(parseGateCommand("PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|50|yes|0", command)) == "dynamic pricing must be y or n");
+    assert(std::string(parseGateCommand("PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|50|n|1h", command)) == "hours must be a number from 0 to 8784");
+    assert(std::string(parseGateCommand("PARK|O|P|M|C|F|123|a@b|S|Cash|A1|Small|n|G1|50|n", command)) == "PARK needs 16 fields");
+    assert(std::string(parseGateCommand(good + "|extra", command)) == "PARK needs 16 fields");
+    assert(std::string(parseGateCommand("REMOVE|0|O", command)) == "REMOVE needs a car ID and an owner");
+    assert(std::string(parseGateCommand("REMOVE|12", command)) == "REMOVE needs a car ID and an owner");
+    assert(std::string(parseGateCommand("QUOTE|1|2", command)) == "QUOTE needs a car ID");
+    assert(std::string(parseGateCommand("DISPLAY|all", command)) == "DISPLAY takes no fields");
+    assert(std::string(parseGateCommand("park|O", command)) == "unknown command");
+    assert(std::string(parseGateCommand("", command)) == "unknown command");
+}
+
+/**
+ * @brief Tests that CSV history becomes a time-ordered admission/departure timeline, and that
+ *        replaying it reproduces the admissions and departures, as fast as possible or paced.
+ */
+void testTrafficReplay() {
+    const std::string carsPath = testFilePath("traffic_cars_data.csv");
+    const std::string departuresPath = testFilePath("traffic_Customer_details.csv");
+    const std::string billsPath = testFilePath("traffic_bill_history.txt");
+    const std::string recordsPath = testFilePath("traffic_bill_records.bin");
+    {
+        ParkingLot history(makeStorageBackend(StorageKind::Csv, "parking_test_traffic_"));
+        history.setSilentMode(true);
+        history.setPersistenceEnabled(true);
+        for (int i = 0; i < 3; ++i) {
+            Car car = createCar(1001 + i, "Traffic" + std::to_string(i));
+            car.parkingTime -= std::chrono::hours(3 - i);
+            history.testAddCar(car);
+            history.saveCarToCSV(car);
+        }
+        assert(history.removeCarByIdAndOwner(1002, "Traffic1"));
+        assert(history.removeCarByIdAndOwner(1001, "Traffic0"));
+        history.flushJournals();
+    }
+
+    TrafficLoadStats loaded;
+    const std::vector<TrafficEvent> events = loadTraffic(carsPath, departuresPath, &loaded);
+    assert(loaded.admissions == 3 && loaded.departures == 2 && loaded.skipped == 0);
+    assert(events.size() == 5);
+    for (std::size_t i = 1; i < events.size(); ++i) assert(events[i - 1].at <= events[i].at);
+    assert(!events[0].departure && events[0].car.ownerName == "Traffic0");
+    assert(events[3].departure && events[4].departure);
+
+    MemoryStorage* memory = new MemoryStorage();
+    ParkingLot lot(std::unique_ptr<StorageBackend>(memory), 10);
+    lot.setSilentMode(true);
+    lot.setPersistenceEnabled(true);
+    lot.testAddCar(createCar(1001, "Occupant"));
+    TrafficReplayOptions fastest;
+    fastest.speed = 0.0;
+    TrafficReplayStats stats = replayTraffic(lot, events, fastest);
+    assert(stats.admitted == 3 && stats.departed == 2 && stats.unmatched == 0 && stats.refused == 0);
+    assert(lot.getCarCount() == 2 && lot.getCarByID(1001).ownerName == "Occupant");
+    assert(memory->getDepartures().size() == 2 && memory->getDepartures()[0].car.ownerName == "Traffic1");
+    assert(formatTrafficReport(stats, events.size()).find("Admitted 3, refused 0, departed 2") != std::string::npos);
+
+    // Three historical hours at 200000x take 54 ms
+    ParkingLot paced{std::unique_ptr<StorageBackend>(new MemoryStorage())};
+    paced.setSilentMode(true);
+    TrafficReplayOptions scaled;
+    scaled.speed = 200000.0;
+    stats = replayTraffic(paced, events, scaled);
+    assert(stats.admitted == 3 && stats.departed == 2);
+    assert(stats.seconds >= 0.05 && stats.seconds < 1.0);
+
+    // Historical ID 7 was issued to three cars; each departure removes its own car
+    std::vector<TrafficEvent> reused(5);
+    const char* owners[] = {"Reuse A", "Reuse B", "Reuse A"};
+    for (int i = 0; i < 3; ++i) {
+        reused[i].car = createCar(7, owners[i]);
+        reused[i].at = events[0].at + std::chrono::seconds(i);
+    }
+    reused[3] = reused[1];
+    reused[3].departure = true;
+    reused[4] = reused[0];
+    reused[4].departure = true;
+    ParkingLot reusedLot{std::unique_ptr<StorageBackend>(new MemoryStorage())};
+    reusedLot.setSilentMode(true);
+    stats = replayTraffic(reusedLot, reused, fastest);
+    assert(stats.admitted == 3 && stats.departed == 2 && stats.unmatched == 0);
+    assert(reusedLot.getCarCount() == 1 && reusedLot.getCarByID(1003).ownerName == "Reuse A");
+
+    for (const std::string& path : {carsPath, departuresPath, billsPath, recordsPath}) std::remove(path.c_str());
+}
+
+/**
+ * @brief Tests that the gate daemon answers pipelined requests from several clients against one lot.
+ */
+void testGateServer() {
+    const std::string socketPath = testFilePath("gate.sock");
+    ParkingLot lot(std::unique_ptr<StorageBackend>(new MemoryStorage()), 1);
+    lot.setSilentMode(true);
+    GateServer server(lot, socketPath);
+    assert(server.listen());
+    std::thread loop([&server] { server.run(); });
+
+    // Reads until the expected number of reply lines has arrived, or the server closes the connection
+    auto readReplies = [](const int fd, const std::size_t lines) {
+        std::string replies;
+        char buffer[4096];
+        while (static_cast<std::size_t>(std::count(replies.begin(), replies.end(), '\n')) < lines) {
+            const ssize_t received = ::read(fd, buffer, sizeof(buffer));
+            if (received <= 0) break;
+            replies.append(buffer, static_cast<std::size_t>(received));
+        }
+        return replies;
+    };
+
+    AdmissionRequest request;
+    request.ownerName = "Gate A";
+    request.licensePlate = "KA01AB1234";
+    request.phone = "9876543210";
+    request.email = "a@x.com";
+    request.slot = "A1";
+    request.slotSize = "Medium";
+    request.hourlyRate = 40.0;
+    std::string first;
+    appendParkRecord(request, first);
+    request.ownerName = "Gate B";
+    appendParkRecord(request, first);  // the lot has one Medium slot
+    first += "QUOTE|1001\nLOOKUP|1001\nBOGUS\nREMOVE|1001|Gate B\n";
+
+    const int a = connectGateSocket(socketPath);
+    const int b = connectGateSocket(socketPath);
+    assert(a >= 0 && b >= 0);
+    assert(::write(a, first.data(), first.size()) == static_cast<ssize_t>(first.size()));
+    const std::string replies = readReplies(a, 6);
+    assert(replies.find("OK 1001\nREFUSED no free slot\nOK ") == 0);
+    assert(replies.find("\nOK 1001|Gate A|KA01AB1234|") != std::string::npos);
+    assert(replies.find("|Medium|40.00\nERR unknown command\nERR no such car for that owner\n") != std::string::npos);
+
+    // The second client shuts down its side with an unterminated last request and still gets every reply
+    const std::string second = "LOOKUP|1001\nREMOVE|1001|Gate A\nQUOTE|1001";
+    assert(::write(b, second.data(), second.size()) == static_cast<ssize_t>(second.size()));
+    ::shutdown(b, SHUT_WR);
+    const std::string last = readReplies(b, 3);
+    assert(last.find("OK 1001|Gate A|") == 0 && last.find("\nOK\nERR no such car\n") != std::string::npos);
+    char rest[16];
+    assert(::read(b, rest, sizeof(rest)) == 0);  // closed once everything was sent
+    ::close(a);
+    ::close(b);
+
+    server.stop();
+    loop.join();
+    assert(server.getRequestCount() == 9);
+    assert(lot.getCarCount() == 0);
+
+    GateServer tooLong(lot, std::string(200, 's'));
+    assert(!tooLong.listen() && tooLong.getError().find("too long") != std::string::npos);
+    std::remove(socketPath.c_str());
+}
+
 // 📌 ANSI Color Codes
 // =============================
 #define ANSI_RESET   "\033[0m"
@@ -974,6 +2528,39 @@ RUN_TEST(testChangeSlotAfterAdd);           // Verify slot updates correctly aft
 RUN_TEST(testAddMultipleCarsSameIDSequentially); // Adding same ID multiple times in sequence
 RUN_TEST(testAddCarThenMutateOriginalObject);// Ensure stored copy is independent from original
 
+RUN_TEST(testOccupancyCounters);            // Per-slot-size counters follow admissions/departures
+RUN_TEST(testSlotCapacityLimitsAdmission);  // Full slot class refuses further cars
+RUN_TEST(testSurgeMultiplierFollowsUtilization); // Surge curve driven by live utilization
+RUN_TEST(testTariffCalendarBands);          // Weekly rate bands priced from prefix sums
+RUN_TEST(testTariffCalendarFlatLongStay);   // Flat calendar matches hours x rate over 30 days
+RUN_TEST(testBillRendererHumanLayout);      // Renderer matches legacy bill text, reuses buffer
+RUN_TEST(testBillRendererCompactLayout);    // One-line machine bill layout
+RUN_TEST(testQuoteFeeCache);                // Kiosk quotes cached per billing minute
+RUN_TEST(testJournalWriterBuffersRows);     // Persistent writer batches rows, header once
+RUN_TEST(testJournalWriterResumesPartialWrite);// Short write then failure: no duplicate rows
+RUN_TEST(testEventLogRecoversParkedCars);   // WAL replay rebuilds cars and ID counter
+RUN_TEST(testEventLogIgnoresTornTail);      // Torn WAL record dropped, appends continue
+RUN_TEST(testLotLoaderRestoresParkedCars);  // CSV history reloaded into parked cars
+RUN_TEST(testCheckpointCompactsEventLog);   // Snapshot + log tail recovery, log compacted
+RUN_TEST(testPersistenceQueuePolicies);     // Async I/O queue order, drop and write-through
+RUN_TEST(testBillRecordsReconcile);         // Binary bill records summed in one pass
+RUN_TEST(testJournalSegmentRotation);       // Rotated segments indexed, archived and loaded
+RUN_TEST(testSegmentIndexRecordTimes);      // Segments found by the times of their records
+RUN_TEST(testCsvReaderStreamsQuotedFields); // Quoted fields, repeated headers, no copies
+RUN_TEST(testSessionArchiveRoundTrip);      // Columnar archive: 10x smaller, per-column reads
+RUN_TEST(testJournalDurabilityModes);       // None, group commit and fsync-per-event timing
+RUN_TEST(testStorageBackends);              // Memory, binary log and CSV backends
+RUN_TEST(testRingLogger);                   // Deferred formatting, levels, concurrent order
+RUN_TEST(testLatencyHistograms);            // Percentiles, runtime-switched op timing
+RUN_TEST(testLotMetrics);                   // Inline counters and Prometheus export
+RUN_TEST(testTraceSpans);                   // Chrome trace-event spans
+RUN_TEST(testIoAccounting);                 // Bytes, opens and syscalls per journal
+RUN_TEST(testOutputSinks);                  // Console, buffered file and null output
+RUN_TEST(testEventReplay);                  // Non-interactive gate event replay
+RUN_TEST(testGateProtocol);                 // One-line gate records and validation
+RUN_TEST(testTrafficReplay);                // Timed replay of CSV history
+RUN_TEST(testGateServer);                   // Pipelined clients over the gate socket
+
     std::cout << ANSI_BLUE << "=========== Test Suite Completed ===========" << ANSI_RESET <<std::endl;
     return 0;
 }
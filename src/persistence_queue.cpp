@@ -0,0 +1,141 @@
+#include "persistence_queue.h"
+#include <algorithm>
+#include "trace.h"
+
+constexpr std::chrono::milliseconds PersistenceQueue::IDLE_FLUSH_CHECK;
+
+PersistenceQueue::PersistenceQueue(const PersistenceOptions& options)
+    : options(options), slots(std::max<std::size_t>(1, options.capacity)) {
+    worker = std::thread(&PersistenceQueue::run, this);
+}
+
+PersistenceQueue::~PersistenceQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+    worker.join();
+}
+
+/**
+ * @brief Copies a record into the next free slot, applying the overflow policy if there is none.
+ *
+ * @param journal The journal to append to.
+ * @param data Pointer to the record bytes.
+ * @param length Number of bytes.
+ * @param timestamp Unix seconds the record describes, or JournalWriter::NO_TIMESTAMP.
+ * @return False if the record was dropped.
+ */
+bool PersistenceQueue::submit(JournalWriter& journal, const char* data, const std::size_t length,
+                              const std::int64_t timestamp) {
+    std::unique_lock<std::mutex> lock(mutex);
+    ++stats.submitted;
+    if (count == slots.size()) {
+        switch (options.policy) {
+            case QueueFullPolicy::DropNewest:
+                ++stats.dropped;
+                return false;
+            case QueueFullPolicy::WriteThrough: {
+                ++stats.writtenThrough;
+                lock.unlock();
+                std::lock_guard<std::mutex> io(ioMutex);
+                write(journal, data, length, timestamp);
+                return true;
+            }
+            case QueueFullPolicy::Block:
+                ++stats.blocked;
+                notFull.wait(lock, [this] { return count < slots.size(); });
+                break;
+        }
+    }
+
+    Slot& slot = slots[(head + count) % slots.size()];
+    slot.journal = &journal;
+    slot.data.assign(data, length);
+    slot.timestamp = timestamp;
+    ++count;
+    updateDepthGauge();
+    stats.maxDepth = std::max(stats.maxDepth, count);
+    notEmpty.notify_one();
+    return true;
+}
+
+void PersistenceQueue::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this] { return count == 0 && idle; });
+}
+
+void PersistenceQueue::withIoLock(const std::function<void()>& fn) {
+    std::lock_guard<std::mutex> io(ioMutex);
+    fn();
+}
+
+PersistenceStats PersistenceQueue::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Takes records off the ring one at a time and appends them outside the queue lock.
+ *
+ * A taken slot's buffer is swapped with the thread's own, so the slot is free for the next
+ * submit() before the disk is touched and no buffer is ever reallocated. When the ring is empty
+ * the thread reports itself idle and sleeps until the earliest journal flush deadline, at most
+ * IDLE_FLUSH_CHECK, then flushes the journals that are due; a group-commit journal is therefore
+ * synced within its interval even when no further records arrive.
+ * On shutdown the remaining records are written before the thread exits.
+ */
+void PersistenceQueue::run() {
+    std::string record;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        if (count == 0) {
+            if (stopping) return;
+            idle = true;
+            drained.notify_all();
+            lock.unlock();
+            auto wake = std::chrono::steady_clock::now() + IDLE_FLUSH_CHECK;
+            {
+                std::lock_guard<std::mutex> io(ioMutex);
+                for (JournalWriter* journal : journals) wake = std::min(wake, journal->flushDeadline());
+            }
+            lock.lock();
+            if (!notEmpty.wait_until(lock, wake, [this] { return count > 0 || stopping; })) {
+                lock.unlock();
+                {
+                    std::lock_guard<std::mutex> io(ioMutex);
+                    for (JournalWriter* journal : journals) journal->flushIfDue();
+                }
+                lock.lock();
+            }
+            continue;
+        }
+
+        idle = false;
+        Slot& slot = slots[head];
+        JournalWriter* journal = slot.journal;
+        const std::int64_t timestamp = slot.timestamp;
+        record.swap(slot.data);
+        head = (head + 1) % slots.size();
+        --count;
+        updateDepthGauge();
+        notFull.notify_one();
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> io(ioMutex);
+            write(*journal, record.data(), record.size(), timestamp);
+        }
+        record.clear();
+        lock.lock();
+    }
+}
+
+void PersistenceQueue::write(JournalWriter& journal, const char* data, const std::size_t length,
+                             const std::int64_t timestamp) {
+    TRACE_SPAN("queue.write");
+    journal.append(data, length, timestamp);
+    if (std::find(journals.begin(), journals.end(), &journal) == journals.end())
+        journals.push_back(&journal);
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "journal_writer.h"
+
+/**
+ * @enum QueueFullPolicy
+ * @brief What a gate operation does when the persistence queue has no free slot.
+ */
+enum class QueueFullPolicy {
+    Block,         ///< Wait for the I/O thread to free a slot. Nothing is lost; the gate may stall.
+    DropNewest,    ///< Discard the new record and count it. The gate never waits on disk.
+    WriteThrough   ///< Append the record on the caller's thread. Nothing is lost; it may land ahead of queued rows.
+};
+
+/**
+ * @struct PersistenceOptions
+ * @brief Size and overflow behaviour of a PersistenceQueue.
+ */
+struct PersistenceOptions {
+    std::size_t capacity = 1024;                      ///< Number of records that can wait for the I/O thread.
+    QueueFullPolicy policy = QueueFullPolicy::Block;  ///< Behaviour when all slots are taken.
+    std::atomic<std::uint64_t>* depthGauge = nullptr; ///< If set, kept equal to the number of waiting records.
+};
+
+/**
+ * @struct PersistenceStats
+ * @brief Counters describing the traffic through a PersistenceQueue.
+ */
+struct PersistenceStats {
+    std::size_t submitted = 0;       ///< Records handed to submit().
+    std::size_t dropped = 0;         ///< Records discarded under DropNewest.
+    std::size_t writtenThrough = 0;  ///< Records appended on the caller's thread under WriteThrough.
+    std::size_t blocked = 0;         ///< Submissions that had to wait under Block.
+    std::size_t maxDepth = 0;        ///< Highest number of records waiting at once.
+};
+
+/**
+ * @class PersistenceQueue
+ * @brief Moves journal appends off the caller's thread onto a single background I/O thread.
+ *
+ * Records are copied into a fixed ring of slots whose string buffers are reused, so a steady
+ * stream of rows does not allocate. The I/O thread appends each record to its JournalWriter and,
+ * while idle, flushes journals whose age threshold has passed. All access to the journals, from
+ * the I/O thread or from withIoLock, is serialised by one I/O mutex.
+ */
+class PersistenceQueue {
+public:
+    /**
+     * @brief Starts the I/O thread.
+     * @param options Queue capacity and overflow policy.
+     */
+    explicit PersistenceQueue(const PersistenceOptions& options = PersistenceOptions());
+
+    /**
+     * @brief Writes out every queued record and stops the I/O thread.
+     */
+    ~PersistenceQueue();
+
+    PersistenceQueue(const PersistenceQueue&) = delete;
+    PersistenceQueue& operator=(const PersistenceQueue&) = delete;
+
+    /**
+     * @brief Queues a record for appending to a journal.
+     * @param journal The journal to append to; must outlive the queue.
+     * @param data Pointer to the record bytes, copied before returning.
+     * @param length Number of bytes.
+     * @param timestamp Unix seconds the record describes, passed on to JournalWriter::append().
+     * @return False if the record was dropped because the queue was full.
+     */
+    bool submit(JournalWriter& journal, const char* data, std::size_t length,
+                std::int64_t timestamp = JournalWriter::NO_TIMESTAMP);
+
+    /**
+     * @brief Blocks until every record submitted so far has been appended to its journal.
+     */
+    void drain();
+
+    /**
+     * @brief Runs fn while holding the I/O lock, so it can use the journals safely.
+     * @param fn The work to run; must not call submit() under the WriteThrough policy.
+     */
+    void withIoLock(const std::function<void()>& fn);
+
+    /**
+     * @brief Returns a copy of the traffic counters.
+     */
+    PersistenceStats getStats() const;
+
+private:
+    /**
+     * @brief One queued record and the journal it belongs to.
+     */
+    struct Slot {
+        JournalWriter* journal = nullptr;
+        std::string data;
+        std::int64_t timestamp = JournalWriter::NO_TIMESTAMP;
+    };
+
+    /**
+     * @brief Body of the I/O thread.
+     */
+    void run();
+
+    /**
+     * @brief Publishes the current number of waiting records to the depth gauge, if any. Caller holds mutex.
+     */
+    void updateDepthGauge() const {
+        if (options.depthGauge) options.depthGauge->store(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Appends a record and remembers its journal for idle flushing. Caller holds ioMutex.
+     */
+    void write(JournalWriter& journal, const char* data, std::size_t length, std::int64_t timestamp);
+
+    /**
+     * @brief How long the I/O thread sleeps between checks for journals whose flush is due.
+     */
+    static constexpr std::chrono::milliseconds IDLE_FLUSH_CHECK = std::chrono::milliseconds(100);
+
+    PersistenceOptions options;
+    std::vector<Slot> slots;
+    std::size_t head = 0;
+    std::size_t count = 0;
+    bool idle = true;
+    bool stopping = false;
+    PersistenceStats stats;
+
+    mutable std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::condition_variable drained;
+
+    std::mutex ioMutex;
+    std::vector<JournalWriter*> journals;
+
+    std::thread worker;
+};
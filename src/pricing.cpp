@@ -0,0 +1,135 @@
+#include "pricing.h"
+#include <algorithm>
+#include <cctype>
+
+/**
+ * @brief Folds a free-text slot size into a SlotClass.
+ *
+ * Matching is case-insensitive and accepts either the full word or its first letter,
+ * so "Small", "small" and "S" all map to SlotClass::Small.
+ *
+ * @param slotSize The slot size as entered for the car.
+ * @return The matching SlotClass, or SlotClass::Other.
+ */
+SlotClass slotClassOf(const std::string& slotSize) {
+    if (slotSize.empty()) return SlotClass::Other;
+    static const char* const names[] = { "small", "medium", "large" };
+    const char first = static_cast<char>(std::tolower(static_cast<unsigned char>(slotSize[0])));
+    for (std::size_t i = 0; i < 3; ++i) {
+        if (first != names[i][0]) continue;
+        if (slotSize.size() == 1) return static_cast<SlotClass>(i);
+        const std::string word(names[i]);
+        if (slotSize.size() != word.size()) continue;
+        bool same = true;
+        for (std::size_t j = 0; j < word.size() && same; ++j)
+            same = std::tolower(static_cast<unsigned char>(slotSize[j])) == word[j];
+        if (same) return static_cast<SlotClass>(i);
+    }
+    return SlotClass::Other;
+}
+
+const char* slotClassName(const SlotClass cls) {
+    switch (cls) {
+        case SlotClass::Small:  return "Small";
+        case SlotClass::Medium: return "Medium";
+        case SlotClass::Large:  return "Large";
+        default:                return "Other";
+    }
+}
+
+SurgeCurve::SurgeCurve()
+    : SurgeCurve({ {0.0, 1.0}, {0.6, 1.0}, {0.8, 1.25}, {0.9, 1.5}, {1.0, 2.0} }) {}
+
+/**
+ * @brief Builds the per-percent lookup table from the given breakpoints.
+ *
+ * Each table entry is the linear interpolation between the two breakpoints surrounding it.
+ * An empty breakpoint list yields a flat curve with multiplier 1.0.
+ *
+ * @param points (utilization, multiplier) breakpoints.
+ */
+SurgeCurve::SurgeCurve(std::vector<std::pair<double, double>> points) {
+    if (points.empty()) {
+        table.fill(1.0);
+        return;
+    }
+    std::sort(points.begin(), points.end());
+    for (std::size_t pct = 0; pct < table.size(); ++pct) {
+        const double u = static_cast<double>(pct) / 100.0;
+        if (u <= points.front().first) { table[pct] = points.front().second; continue; }
+        if (u >= points.back().first)  { table[pct] = points.back().second;  continue; }
+        auto hi = std::upper_bound(points.begin(), points.end(), std::make_pair(u, 0.0));
+        auto lo = hi - 1;
+        const double span = hi->first - lo->first;
+        const double t = span > 0.0 ? (u - lo->first) / span : 1.0;
+        table[pct] = lo->second + t * (hi->second - lo->second);
+    }
+}
+
+double SurgeCurve::multiplierAt(const std::size_t occupied, const std::size_t capacity) const {
+    if (capacity == 0 || occupied >= capacity) return table[100];
+    return table[occupied * 100 / capacity];
+}
+
+TariffCalendar::TariffCalendar()
+    : minuteRate(MINUTES_PER_WEEK, 1.0), prefix(MINUTES_PER_WEEK + 1, 0.0) {
+    rebuild();
+}
+
+void TariffCalendar::setBand(const int day, const int startMinute, const int endMinute, const double multiplier) {
+    const int base = ((day % 7) + 7) % 7 * 24 * 60;
+    for (int m = std::max(0, startMinute); m < endMinute; ++m)
+        minuteRate[(base + m) % MINUTES_PER_WEEK] = multiplier;
+    rebuild();
+}
+
+void TariffCalendar::rebuild() {
+    prefix[0] = 0.0;
+    for (int m = 0; m < MINUTES_PER_WEEK; ++m)
+        prefix[m + 1] = prefix[m] + minuteRate[m];
+}
+
+/**
+ * @brief Places a point in time within the weekly cycle.
+ *
+ * The Unix epoch fell on a Thursday, i.e. three days after a Monday, which anchors the cycle.
+ *
+ * @param t The point in time.
+ * @return The local minute of the week, Monday 00:00 = 0.
+ */
+int TariffCalendar::minuteOfWeek(const std::chrono::system_clock::time_point t) const {
+    using namespace std::chrono;
+    const long long epochMinutes = duration_cast<minutes>(t.time_since_epoch()).count();
+    const long long local = epochMinutes + utcOffsetMinutes + 3LL * 24 * 60;
+    return static_cast<int>(((local % MINUTES_PER_WEEK) + MINUTES_PER_WEEK) % MINUTES_PER_WEEK);
+}
+
+/**
+ * @brief Computes the rate-weighted hours of a stay in constant time.
+ *
+ * A stay of n minutes starting at minute a of the week covers n / W whole weeks plus a
+ * remainder that is either one contiguous range of the prefix sums or, if it wraps past the
+ * end of the week, two ranges.
+ *
+ * @param entry Time the car entered.
+ * @param exit Time the car left.
+ * @return The weighted number of hours to multiply by the hourly rate.
+ */
+double TariffCalendar::weightedHours(const std::chrono::system_clock::time_point entry,
+                                     const std::chrono::system_clock::time_point exit) const {
+    using namespace std::chrono;
+    if (exit <= entry) return 0.0;
+    const long long minutesParked = duration_cast<minutes>(exit - entry).count();
+    const long long fullWeeks = minutesParked / MINUTES_PER_WEEK;
+    const int remainder = static_cast<int>(minutesParked % MINUTES_PER_WEEK);
+    const int start = minuteOfWeek(entry);
+
+    double weighted = static_cast<double>(fullWeeks) * prefix[MINUTES_PER_WEEK];
+    if (start + remainder <= MINUTES_PER_WEEK) {
+        weighted += prefix[start + remainder] - prefix[start];
+    } else {
+        weighted += prefix[MINUTES_PER_WEEK] - prefix[start];
+        weighted += prefix[start + remainder - MINUTES_PER_WEEK];
+    }
+    return weighted / 60.0;
+}
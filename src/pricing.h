@@ -0,0 +1,195 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @enum SlotClass
+ * @brief Coarse slot-size categories used for occupancy tracking and pricing.
+ *
+ * Car::slotSize is free text entered at the gate; it is folded into one of these
+ * classes so that per-size counters can be kept in a fixed-size array.
+ */
+enum class SlotClass : unsigned char {
+    Small = 0,
+    Medium,
+    Large,
+    Other
+};
+
+/**
+ * @brief Number of distinct SlotClass values, used to size per-class arrays.
+ */
+constexpr std::size_t SLOT_CLASS_COUNT = 4;
+
+/**
+ * @brief Maps a free-text slot size (e.g. "Small", "medium", "L") to its SlotClass.
+ * @param slotSize The slot size as entered for the car.
+ * @return The matching SlotClass, or SlotClass::Other if it is not recognised.
+ */
+SlotClass slotClassOf(const std::string& slotSize);
+
+/**
+ * @brief Returns a printable name for a SlotClass.
+ * @param cls The slot class.
+ * @return A static string such as "Small" or "Other".
+ */
+const char* slotClassName(SlotClass cls);
+
+/**
+ * @class SurgeCurve
+ * @brief Piecewise-linear mapping from slot utilization to an hourly-rate multiplier.
+ *
+ * The curve is defined by (utilization, multiplier) breakpoints and is sampled once into a
+ * table with one entry per whole percent of utilization, so evaluating it at admission time
+ * is a single array lookup.
+ */
+class SurgeCurve {
+public:
+    /**
+     * @brief Constructs the default curve: flat up to 60% full, rising to 2x when the slot class is full.
+     */
+    SurgeCurve();
+
+    /**
+     * @brief Constructs a curve from explicit breakpoints.
+     * @param points (utilization in [0,1], multiplier) pairs; they are sorted by utilization.
+     *               Utilization below the first point or above the last one is clamped.
+     */
+    explicit SurgeCurve(std::vector<std::pair<double, double>> points);
+
+    /**
+     * @brief Returns the rate multiplier for the given occupancy.
+     * @param occupied Number of occupied slots.
+     * @param capacity Number of slots available in total; 0 is treated as fully occupied.
+     * @return The multiplier to apply to the base hourly rate.
+     */
+    double multiplierAt(std::size_t occupied, std::size_t capacity) const;
+
+private:
+    /**
+     * @brief Multiplier per whole percent of utilization, index 0..100.
+     */
+    std::array<double, 101> table;
+};
+
+/**
+ * @struct FeeBreakdown
+ * @brief The itemised charge for one parking session, as printed on the bill.
+ */
+struct FeeBreakdown {
+    /**
+     * @brief Wall-clock hours parked, in whole minutes.
+     */
+    double hours = 0.0;
+
+    /**
+     * @brief Hourly rate of the car.
+     */
+    double rate = 0.0;
+
+    /**
+     * @brief Charge before any discount, after applying the tariff calendar bands.
+     */
+    double gross = 0.0;
+
+    /**
+     * @brief Long-stay discount deducted from the gross charge.
+     */
+    double discount = 0.0;
+
+    /**
+     * @brief GST charged on the discounted amount.
+     */
+    double gst = 0.0;
+
+    /**
+     * @brief Amount payable.
+     */
+    double total = 0.0;
+};
+
+/**
+ * @class TariffCalendar
+ * @brief Weekly time-of-day and day-of-week rate bands with constant-time interval pricing.
+ *
+ * Each minute of the week carries a multiplier of the car's hourly rate. The calendar keeps a
+ * prefix sum of those multipliers over one weekly cycle, so the rate-weighted duration of any
+ * stay is one or two prefix-sum differences plus a multiple of the weekly total, regardless of
+ * how many days the car stayed.
+ */
+class TariffCalendar {
+public:
+    /**
+     * @brief Number of minutes in the weekly cycle.
+     */
+    static constexpr int MINUTES_PER_WEEK = 7 * 24 * 60;
+
+    /**
+     * @brief Constructs a flat calendar in which every minute is charged at 1x the hourly rate.
+     */
+    TariffCalendar();
+
+    /**
+     * @brief Sets the multiplier for a band of minutes on one day of the week.
+     *
+     * The band is [startMinute, endMinute) minutes after local midnight; endMinute may exceed
+     * 1440 to run past midnight into the next day. The prefix sums are rebuilt immediately.
+     *
+     * @param day Day of the week, 0 = Monday ... 6 = Sunday.
+     * @param startMinute First minute of the band.
+     * @param endMinute One past the last minute of the band.
+     * @param multiplier Multiplier applied to the hourly rate during the band.
+     */
+    void setBand(int day, int startMinute, int endMinute, double multiplier);
+
+    /**
+     * @brief Sets the offset of local time from UTC used to place stays in the week.
+     * @param minutes Local time minus UTC, in minutes (e.g. 330 for IST).
+     */
+    void setUtcOffsetMinutes(int minutes) { utcOffsetMinutes = minutes; }
+
+    /**
+     * @brief Returns the rate-weighted number of hours between entry and exit. O(1).
+     *
+     * The stay is measured in whole minutes from the entry minute; with a flat calendar the
+     * result is simply the number of hours parked.
+     *
+     * @param entry Time the car entered.
+     * @param exit Time the car left; stays with exit before entry are charged nothing.
+     * @return Sum of per-minute multipliers over the stay, divided by 60.
+     */
+    double weightedHours(std::chrono::system_clock::time_point entry,
+                         std::chrono::system_clock::time_point exit) const;
+
+private:
+    /**
+     * @brief Returns the minute of the week (Monday 00:00 local = 0) for a point in time.
+     * @param t The point in time.
+     * @return A value in [0, MINUTES_PER_WEEK).
+     */
+    int minuteOfWeek(std::chrono::system_clock::time_point t) const;
+
+    /**
+     * @brief Recomputes the prefix sums from the per-minute multipliers.
+     */
+    void rebuild();
+
+    /**
+     * @brief Multiplier of the hourly rate for each minute of the week.
+     */
+    std::vector<double> minuteRate;
+
+    /**
+     * @brief prefix[m] is the sum of minuteRate[0..m); prefix[MINUTES_PER_WEEK] is the weekly total.
+     */
+    std::vector<double> prefix;
+
+    /**
+     * @brief Local time minus UTC, in minutes.
+     */
+    int utcOffsetMinutes = 0;
+};
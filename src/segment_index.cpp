@@ -0,0 +1,190 @@
+#include "segment_index.h"
+#include "journal_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <limits>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace segment_index {
+
+namespace {
+
+/**
+ * @brief Parses one "sequence<TAB>start<TAB>end<TAB>bytes<TAB>first<TAB>last<TAB>file" index line.
+ *
+ * Older lines have no first and last record times; for those the segment's start and end are used.
+ */
+bool parseLine(const std::string& line, SegmentInfo& segment) {
+    unsigned long long sequence = 0, bytes = 0;
+    long long start = 0, end = 0, first = 0, last = 0;
+    int consumed = 0;
+    if (std::sscanf(line.c_str(), "%llu\t%lld\t%lld\t%llu\t%lld\t%lld\t%n",
+                    &sequence, &start, &end, &bytes, &first, &last, &consumed) != 6 || consumed <= 0) {
+        consumed = 0;
+        if (std::sscanf(line.c_str(), "%llu\t%lld\t%lld\t%llu\t%n", &sequence, &start, &end, &bytes, &consumed) != 4 ||
+            consumed <= 0)
+            return false;
+        first = start;
+        last = end;
+    }
+    if (static_cast<std::size_t>(consumed) >= line.size()) return false;
+    segment.sequence = sequence;
+    segment.startTime = start;
+    segment.endTime = end;
+    segment.bytes = bytes;
+    segment.firstRecord = first;
+    segment.lastRecord = last;
+    segment.file = line.substr(static_cast<std::size_t>(consumed));
+    return true;
+}
+
+std::string formatLine(const SegmentInfo& segment) {
+    char prefix[160];
+    std::snprintf(prefix, sizeof(prefix), "%llu\t%lld\t%lld\t%llu\t%lld\t%lld\t",
+                  static_cast<unsigned long long>(segment.sequence), static_cast<long long>(segment.startTime),
+                  static_cast<long long>(segment.endTime), static_cast<unsigned long long>(segment.bytes),
+                  static_cast<long long>(segment.firstRecord), static_cast<long long>(segment.lastRecord));
+    return prefix + segment.file + "\n";
+}
+
+bool exists(const std::string& path) {
+    return ::access(path.c_str(), F_OK) == 0;
+}
+
+std::string baseName(const std::string& path) {
+    const std::string::size_type slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+}  // namespace
+
+std::string indexPath(const std::string& journalPath) {
+    return journalPath + ".segments";
+}
+
+std::string segmentPath(const std::string& journalPath, const std::uint64_t sequence) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), ".%06llu", static_cast<unsigned long long>(sequence));
+    return journalPath + suffix;
+}
+
+/**
+ * @brief Reads the whole index with plain read() calls, so the calls can be counted, then parses it line by line.
+ */
+std::vector<SegmentInfo> readClosed(const std::string& journalPath, IoStats* io) {
+    IoStats calls;
+    std::string text;
+    const int fd = ::open(indexPath(journalPath).c_str(), O_RDONLY | O_CLOEXEC);
+    ++calls.syscalls;
+    if (fd >= 0) {
+        ++calls.filesOpened;
+        char chunk[4096];
+        for (;;) {
+            const ssize_t got = ::read(fd, chunk, sizeof(chunk));
+            ++calls.syscalls;
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) break;
+            text.append(chunk, static_cast<std::size_t>(got));
+        }
+        ::close(fd);
+        ++calls.syscalls;
+    }
+    if (io) *io += calls;
+
+    std::vector<SegmentInfo> segments;
+    SegmentInfo segment;
+    std::string::size_type begin = 0;
+    while (begin < text.size()) {
+        std::string::size_type end = text.find('\n', begin);
+        if (end == std::string::npos) end = text.size();
+        if (parseLine(text.substr(begin, end - begin), segment)) segments.push_back(segment);
+        begin = end + 1;
+    }
+    return segments;
+}
+
+std::vector<SegmentInfo> readAll(const std::string& journalPath) {
+    std::vector<SegmentInfo> segments = readClosed(journalPath);
+    if (exists(journalPath)) {
+        SegmentInfo active;
+        active.startTime = segments.empty() ? 0 : segments.back().endTime;
+        active.endTime = std::numeric_limits<std::int64_t>::max();
+        // Records reach the file in the order they were stamped, so none predates the last closed one
+        active.firstRecord = segments.empty() ? 0 : std::min(active.startTime, segments.back().lastRecord);
+        active.lastRecord = active.endTime;
+        active.file = journalPath;
+        segments.push_back(active);
+    }
+    return segments;
+}
+
+bool appendClosed(const std::string& journalPath, const SegmentInfo& segment, IoStats* io) {
+    IoStats calls;
+    const std::string line = formatLine(segment);
+    const int fd = ::open(indexPath(journalPath).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    ++calls.syscalls;
+    std::size_t done = 0;
+    if (fd >= 0) {
+        ++calls.filesOpened;
+        while (done < line.size()) {
+            const ssize_t written = ::write(fd, line.data() + done, line.size() - done);
+            ++calls.syscalls;
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) break;
+            calls.bytesWritten += static_cast<std::uint64_t>(written);
+            done += static_cast<std::size_t>(written);
+        }
+        ::close(fd);
+        ++calls.syscalls;
+    }
+    if (io) *io += calls;
+    return done == line.size();
+}
+
+std::vector<std::string> filesInRange(const std::string& journalPath, const std::int64_t from, const std::int64_t to) {
+    std::vector<std::string> files;
+    for (const SegmentInfo& segment : readAll(journalPath))
+        if (segment.firstRecord < to && segment.lastRecord >= from) files.push_back(segment.file);
+    return files;
+}
+
+std::vector<std::string> allFiles(const std::string& journalPath) {
+    std::vector<std::string> files;
+    for (const SegmentInfo& segment : readAll(journalPath)) files.push_back(segment.file);
+    return files;
+}
+
+/**
+ * @brief Renames old segments into the archive directory and rewrites the index to match.
+ */
+std::size_t archiveBefore(const std::string& journalPath, const std::int64_t before, const std::string& archiveDir) {
+    std::vector<SegmentInfo> segments = readClosed(journalPath);
+    if (::mkdir(archiveDir.c_str(), 0755) != 0 && errno != EEXIST) return 0;
+
+    std::size_t moved = 0;
+    const std::string prefix = archiveDir + "/";
+    for (SegmentInfo& segment : segments) {
+        if (segment.endTime >= before || segment.file.compare(0, prefix.size(), prefix) == 0) continue;
+        const std::string target = prefix + baseName(segment.file);
+        if (std::rename(segment.file.c_str(), target.c_str()) != 0) continue;
+        segment.file = target;
+        ++moved;
+    }
+    if (moved == 0) return 0;
+
+    const std::string index = indexPath(journalPath);
+    const std::string tmp = index + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        for (const SegmentInfo& segment : segments) out << formatLine(segment);
+        if (!out.flush()) return moved;
+    }
+    std::rename(tmp.c_str(), index.c_str());
+    return moved;
+}
+
+}  // namespace segment_index
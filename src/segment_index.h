@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct IoStats;
+
+/**
+ * @struct SegmentInfo
+ * @brief One segment of a rotated journal and the time range it covers.
+ */
+struct SegmentInfo {
+    std::uint64_t sequence = 0;  ///< Position of the segment in the journal, starting at 1; 0 for the active file.
+    std::int64_t startTime = 0;  ///< Unix seconds when the segment became active; 0 if unknown (pre-rotation history).
+    std::int64_t endTime = 0;    ///< Unix seconds when the segment was closed; INT64_MAX for the active file.
+    std::uint64_t bytes = 0;     ///< Size of the segment when it was closed.
+    std::int64_t firstRecord = 0;  ///< Earliest record timestamp in the segment, or startTime if earlier or unknown.
+    std::int64_t lastRecord = 0;   ///< Latest record timestamp in the segment, or endTime if later or unknown.
+    std::string file;            ///< Where the segment lives now, which changes when it is archived.
+};
+
+/**
+ * @namespace segment_index
+ * @brief The index of closed segments kept next to a rotated journal.
+ *
+ * When a JournalWriter rotates "<path>", the active file is renamed to "<path>.NNNNNN" and a line
+ * "sequence<TAB>start<TAB>end<TAB>bytes<TAB>first<TAB>last<TAB>file" is appended to "<path>.segments".
+ * Segments are contiguous in time: each one starts where the previous one ended, and the active
+ * file continues from the end of the last one. Records can be stamped before they reach the file
+ * (e.g. while waiting in a PersistenceQueue), so each line also holds the range of the record
+ * timestamps in the segment, and range queries select on that. Lines without the record range,
+ * written before it was added, are still read, using the segment's own start and end.
+ */
+namespace segment_index {
+
+/**
+ * @brief Returns the path of the index file of a journal.
+ */
+std::string indexPath(const std::string& journalPath);
+
+/**
+ * @brief Returns the file name a closed segment with the given sequence number is given.
+ */
+std::string segmentPath(const std::string& journalPath, std::uint64_t sequence);
+
+/**
+ * @brief Reads the closed segments of a journal, oldest first. A missing index yields none.
+ * @param io If not null, the open, read and close calls made on the index are added to it.
+ */
+std::vector<SegmentInfo> readClosed(const std::string& journalPath, IoStats* io = nullptr);
+
+/**
+ * @brief Returns the closed segments followed by the active file, oldest first.
+ */
+std::vector<SegmentInfo> readAll(const std::string& journalPath);
+
+/**
+ * @brief Appends a closed segment to the journal's index.
+ * @param io If not null, the open, write and close calls and bytes written are added to it.
+ * @return False if the index could not be written.
+ */
+bool appendClosed(const std::string& journalPath, const SegmentInfo& segment, IoStats* io = nullptr);
+
+/**
+ * @brief Returns the files, oldest first, of the segments whose record time range overlaps [from, to).
+ */
+std::vector<std::string> filesInRange(const std::string& journalPath, std::int64_t from, std::int64_t to);
+
+/**
+ * @brief Returns every file of the journal, closed segments first and the active file last.
+ */
+std::vector<std::string> allFiles(const std::string& journalPath);
+
+/**
+ * @brief Moves closed segments that ended before the cutoff into an archive directory.
+ *
+ * The index is rewritten (via a temporary file and rename) to point at the archived locations,
+ * so range queries keep finding them. Must not run concurrently with a rotation of the same journal.
+ *
+ * @param journalPath Path of the journal.
+ * @param before Segments whose end time is earlier than this (Unix seconds) are archived.
+ * @param archiveDir Directory to move them to; created if missing.
+ * @return The number of segments moved.
+ */
+std::size_t archiveBefore(const std::string& journalPath, std::int64_t before, const std::string& archiveDir);
+
+}  // namespace segment_index
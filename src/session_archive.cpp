@@ -0,0 +1,528 @@
+#include "session_archive.h"
+#include "car_codec.h"
+#include "car_csv.h"
+#include "csv_reader.h"
+#include "segment_index.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Identifies a session archive and its format version.
+ */
+const char ARCHIVE_MAGIC[8] = { 'P', 'K', 'A', 'R', 'C', 'H', '0', '1' };
+
+/**
+ * @brief Column encodings stored in the chunk directory.
+ */
+constexpr std::uint32_t ENC_DELTA = 1;       ///< First value, then blocks of bit-packed deltas.
+constexpr std::uint32_t ENC_DICTIONARY = 2;  ///< Dictionary followed by bit-packed indices.
+
+/**
+ * @brief Size of a chunk header: row count, directory and header CRC.
+ */
+constexpr std::size_t CHUNK_HEADER = 4 + SESSION_COLUMNS * 12 + 4;
+
+std::size_t columnIndex(const SessionColumn column) {
+    return static_cast<std::size_t>(column);
+}
+
+bool isIntegerColumn(const SessionColumn column) {
+    return column == SessionColumn::Id || column == SessionColumn::EntryTime || column == SessionColumn::ExitTime;
+}
+
+void putVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+bool getVarint(const char*& p, const char* const end, std::uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+        const unsigned char byte = static_cast<unsigned char>(*p++);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+std::uint64_t zigzag(const std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(const std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/**
+ * @brief Returns the number of bits needed to store indices below count.
+ */
+unsigned bitWidth(const std::size_t count) {
+    unsigned width = 0;
+    while ((static_cast<std::uint64_t>(1) << width) < count) ++width;
+    return width;
+}
+
+/**
+ * @brief Returns the number of bits needed to store value.
+ */
+unsigned valueWidth(const std::uint64_t value) {
+    unsigned width = 0;
+    while (width < 64 && (value >> width) != 0) ++width;
+    return width;
+}
+
+/**
+ * @brief Appends count values of width bits each, least significant bit first.
+ */
+template<typename T>
+void packBits(std::string& out, const T* values, const std::size_t count, const unsigned width) {
+    unsigned pending = 0;
+    unsigned char byte = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint64_t value = values[i];
+        for (unsigned done = 0; done < width;) {
+            const unsigned take = std::min(width - done, 8 - pending);
+            byte |= static_cast<unsigned char>(((value >> done) & ((1u << take) - 1)) << pending);
+            done += take;
+            pending += take;
+            if (pending == 8) {
+                out += static_cast<char>(byte);
+                byte = 0;
+                pending = 0;
+            }
+        }
+    }
+    if (pending > 0) out += static_cast<char>(byte);
+}
+
+/**
+ * @brief Reads bit-packed values written by packBits; the caller checks that enough bytes remain.
+ */
+class BitReader {
+public:
+    explicit BitReader(const char* p) : p(reinterpret_cast<const unsigned char*>(p)) {}
+
+    std::uint64_t read(const unsigned width) {
+        std::uint64_t value = 0;
+        for (unsigned done = 0; done < width;) {
+            const unsigned take = std::min(width - done, 8 - offset);
+            value |= static_cast<std::uint64_t>((*p >> offset) & ((1u << take) - 1)) << done;
+            done += take;
+            offset += take;
+            if (offset == 8) {
+                ++p;
+                offset = 0;
+            }
+        }
+        return value;
+    }
+
+private:
+    const unsigned char* p;
+    unsigned offset = 0;
+};
+
+/**
+ * @brief Number of deltas that share one minimum and bit width.
+ */
+constexpr std::size_t DELTA_BLOCK = 128;
+
+std::int64_t toSeconds(const std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+/**
+ * @brief Encodes the first value as a zigzag varint, then the deltas between neighbours in blocks.
+ *
+ * Each block stores its smallest delta as a zigzag varint and a bit width, followed by every
+ * delta's offset from that minimum, bit-packed. Steadily increasing IDs pack to zero bits, and
+ * timestamps cost only the bits their spread needs.
+ */
+void encodeDeltas(std::string& out, const std::vector<std::int64_t>& values) {
+    if (values.empty()) return;
+    putVarint(out, zigzag(values[0]));
+    std::uint64_t offsets[DELTA_BLOCK];
+    for (std::size_t start = 1; start < values.size(); start += DELTA_BLOCK) {
+        const std::size_t count = std::min(DELTA_BLOCK, values.size() - start);
+        std::int64_t minDelta = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::int64_t delta = static_cast<std::int64_t>(
+                static_cast<std::uint64_t>(values[start + i]) - static_cast<std::uint64_t>(values[start + i - 1]));
+            offsets[i] = static_cast<std::uint64_t>(delta);
+            if (i == 0 || delta < minDelta) minDelta = delta;
+        }
+        std::uint64_t widest = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            offsets[i] -= static_cast<std::uint64_t>(minDelta);
+            widest |= offsets[i];
+        }
+        const unsigned width = valueWidth(widest);
+        putVarint(out, zigzag(minDelta));
+        out += static_cast<char>(width);
+        packBits(out, offsets, count, width);
+    }
+}
+
+/**
+ * @brief Car members holding each string column, indexed by SessionColumn; null for the other columns.
+ */
+std::string Car::* const TEXT_MEMBERS[SESSION_COLUMNS] = {
+    nullptr, &Car::ownerName, &Car::licensePlate, &Car::model, &Car::color, &Car::fuelType, &Car::phone,
+    &Car::email, &Car::membership, &Car::paymentMethod, &Car::slot, &Car::slotSize, nullptr, nullptr,
+    nullptr, nullptr
+};
+
+}  // namespace
+
+void SessionArchiveWriter::DictionaryColumn::add(const std::string& value) {
+    auto found = lookup.find(value);
+    if (found == lookup.end()) {
+        found = lookup.emplace(value, static_cast<std::uint32_t>(entries.size())).first;
+        entries.push_back(&found->first);
+    }
+    indices.push_back(found->second);
+}
+
+SessionArchiveWriter::SessionArchiveWriter(const std::string& path, const std::size_t chunkRows)
+    : path(path), tmpPath(path + ".tmp"), chunkRows(chunkRows ? chunkRows : 1) {
+    fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) writeBytes(std::string(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)));
+}
+
+SessionArchiveWriter::~SessionArchiveWriter() {
+    if (fd >= 0) close();
+}
+
+bool SessionArchiveWriter::append(const Car& car, const std::chrono::system_clock::time_point exitTime) {
+    if (fd < 0 || failed) return false;
+    ids.push_back(car.id);
+    entryTimes.push_back(toSeconds(car.parkingTime));
+    exitTimes.push_back(toSeconds(exitTime));
+    for (std::size_t c = 0; c < SESSION_COLUMNS; ++c)
+        if (TEXT_MEMBERS[c]) text[c].add(car.*TEXT_MEMBERS[c]);
+
+    std::uint64_t rateBits;
+    std::memcpy(&rateBits, &car.hourlyRate, sizeof(rateBits));
+    std::string rate;
+    car_codec::putU64(rate, rateBits);
+    text[columnIndex(SessionColumn::Rate)].add(rate);
+    text[columnIndex(SessionColumn::Dynamic)].add(car.dynamicPricing ? "Yes" : "No");
+
+    ++sessions;
+    return ids.size() < chunkRows || flushChunk();
+}
+
+/**
+ * @brief Encodes the buffered sessions as one chunk and resets the column buffers.
+ *
+ * All column payloads are encoded into one buffer first, so the directory in front of them can
+ * record each column's length and checksum.
+ */
+bool SessionArchiveWriter::flushChunk() {
+    if (ids.empty()) return !failed;
+    std::uint32_t encoding[SESSION_COLUMNS];
+    std::size_t length[SESSION_COLUMNS];
+    payload.clear();
+    for (std::size_t c = 0; c < SESSION_COLUMNS; ++c) {
+        const std::size_t start = payload.size();
+        const SessionColumn column = static_cast<SessionColumn>(c);
+        if (isIntegerColumn(column)) {
+            encoding[c] = ENC_DELTA;
+            encodeDeltas(payload, column == SessionColumn::Id ? ids
+                                  : column == SessionColumn::EntryTime ? entryTimes : exitTimes);
+        } else {
+            encoding[c] = ENC_DICTIONARY;
+            const DictionaryColumn& dict = text[c];
+            putVarint(payload, dict.entries.size());
+            for (const std::string* entry : dict.entries) {
+                putVarint(payload, entry->size());
+                payload += *entry;
+            }
+            const unsigned width = bitWidth(dict.entries.size());
+            payload += static_cast<char>(width);
+            packBits(payload, dict.indices.data(), dict.indices.size(), width);
+        }
+        length[c] = payload.size() - start;
+    }
+
+    chunk.clear();
+    car_codec::putU32(chunk, static_cast<std::uint32_t>(ids.size()));
+    const char* column = payload.data();
+    for (std::size_t c = 0; c < SESSION_COLUMNS; ++c) {
+        car_codec::putU32(chunk, encoding[c]);
+        car_codec::putU32(chunk, static_cast<std::uint32_t>(length[c]));
+        car_codec::putU32(chunk, car_codec::crc32(column, length[c]));
+        column += length[c];
+    }
+    car_codec::putU32(chunk, car_codec::crc32(chunk.data(), chunk.size()));
+
+    ids.clear();
+    entryTimes.clear();
+    exitTimes.clear();
+    for (DictionaryColumn& dict : text) {
+        dict.indices.clear();
+        dict.entries.clear();
+        dict.lookup.clear();
+    }
+    return writeBytes(chunk) && writeBytes(payload);
+}
+
+bool SessionArchiveWriter::writeBytes(const std::string& data) {
+    const char* p = data.data();
+    std::size_t length = data.size();
+    while (length > 0 && !failed) {
+        const ssize_t written = ::write(fd, p, length);
+        if (written < 0) {
+            if (errno != EINTR) failed = true;
+            continue;
+        }
+        p += written;
+        length -= static_cast<std::size_t>(written);
+        bytesWritten += static_cast<std::size_t>(written);
+    }
+    return !failed;
+}
+
+bool SessionArchiveWriter::close() {
+    if (fd < 0) return false;
+    const bool written = flushChunk() && ::fsync(fd) == 0;
+    ::close(fd);
+    fd = -1;
+    if (!written || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+SessionArchiveReader::SessionArchiveReader(const std::string& path) : file(path) {
+    valid = file.isOpen() && file.size() >= sizeof(ARCHIVE_MAGIC) &&
+            std::memcmp(file.data(), ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) == 0;
+    if (!valid) return;
+    file.adviseSequential();
+    cursor = file.data() + sizeof(ARCHIVE_MAGIC);
+}
+
+/**
+ * @brief Checks the chunk header and records where each column lies; no column data is read.
+ */
+bool SessionArchiveReader::nextChunk() {
+    chunkRows = 0;
+    if (!valid || corrupt) return false;
+    const char* const end = file.data() + file.size();
+    if (cursor == end) return false;
+    if (static_cast<std::size_t>(end - cursor) < CHUNK_HEADER ||
+        car_codec::crc32(cursor, CHUNK_HEADER - 4) != car_codec::getU32(cursor + CHUNK_HEADER - 4)) {
+        corrupt = true;
+        return false;
+    }
+
+    const char* entry = cursor + 4;
+    const char* column = cursor + CHUNK_HEADER;
+    for (std::size_t c = 0; c < SESSION_COLUMNS; ++c, entry += 12) {
+        const std::uint32_t length = car_codec::getU32(entry + 4);
+        if (length > static_cast<std::size_t>(end - column)) {
+            corrupt = true;
+            return false;
+        }
+        encodings[c] = car_codec::getU32(entry);
+        columnCrc[c] = car_codec::getU32(entry + 8);
+        columnBegin[c] = column;
+        columnEnd[c] = column + length;
+        column += length;
+    }
+    chunkRows = car_codec::getU32(cursor);
+    cursor = column;
+    return true;
+}
+
+bool SessionArchiveReader::columnBytes(const SessionColumn column, const std::uint32_t encoding,
+                                       const char*& begin, const char*& end) const {
+    const std::size_t c = columnIndex(column);
+    if (chunkRows == 0 || c >= SESSION_COLUMNS || encodings[c] != encoding) return false;
+    begin = columnBegin[c];
+    end = columnEnd[c];
+    return car_codec::crc32(begin, static_cast<std::size_t>(end - begin)) == columnCrc[c];
+}
+
+bool SessionArchiveReader::decodeIntegers(const SessionColumn column, std::vector<std::int64_t>& out) {
+    const char* p;
+    const char* end;
+    if (!isIntegerColumn(column) || !columnBytes(column, ENC_DELTA, p, end)) return false;
+    out.resize(chunkRows);
+    std::uint64_t first;
+    if (!getVarint(p, end, first)) return false;
+    out[0] = unzigzag(first);
+    for (std::size_t start = 1; start < chunkRows; start += DELTA_BLOCK) {
+        const std::size_t count = std::min(DELTA_BLOCK, chunkRows - start);
+        std::uint64_t minDelta;
+        if (!getVarint(p, end, minDelta) || p == end) return false;
+        const unsigned width = static_cast<unsigned char>(*p++);
+        const std::size_t bytes = (count * width + 7) / 8;
+        if (width > 64 || bytes > static_cast<std::size_t>(end - p)) return false;
+        BitReader bits(p);
+        for (std::size_t i = 0; i < count; ++i)
+            out[start + i] = static_cast<std::int64_t>(static_cast<std::uint64_t>(out[start + i - 1]) +
+                                                       static_cast<std::uint64_t>(unzigzag(minDelta)) + bits.read(width));
+        p += bytes;
+    }
+    return p == end;
+}
+
+bool SessionArchiveReader::decodeDictionary(const SessionColumn column, std::vector<FieldView>& out) {
+    const char* p;
+    const char* end;
+    std::uint64_t count;
+    if (!columnBytes(column, ENC_DICTIONARY, p, end) || !getVarint(p, end, count) ||
+        count > static_cast<std::size_t>(end - p))
+        return false;
+    dictionary.clear();
+    for (std::uint64_t i = 0; i < count; ++i) {
+        std::uint64_t length;
+        if (!getVarint(p, end, length) || length > static_cast<std::size_t>(end - p)) return false;
+        dictionary.push_back(FieldView(p, static_cast<std::size_t>(length)));
+        p += length;
+    }
+    if (p == end) return false;
+    const unsigned width = static_cast<unsigned char>(*p++);
+    if (width != bitWidth(dictionary.size()) || static_cast<std::size_t>(end - p) != (chunkRows * width + 7) / 8)
+        return false;
+
+    out.resize(chunkRows);
+    BitReader bits(p);
+    for (FieldView& value : out) {
+        const std::uint64_t index = bits.read(width);
+        if (index >= dictionary.size()) return false;
+        value = dictionary[static_cast<std::size_t>(index)];
+    }
+    return true;
+}
+
+bool SessionArchiveReader::decodeStrings(const SessionColumn column, std::vector<FieldView>& out) {
+    return !isIntegerColumn(column) && column != SessionColumn::Rate && decodeDictionary(column, out);
+}
+
+bool SessionArchiveReader::decodeRates(std::vector<double>& out) {
+    std::vector<FieldView> values;
+    if (!decodeDictionary(SessionColumn::Rate, values)) return false;
+    out.resize(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (values[i].size != 8) return false;
+        const std::uint64_t bits = car_codec::getU64(values[i].data);
+        std::memcpy(&out[i], &bits, sizeof(bits));
+    }
+    return true;
+}
+
+bool SessionArchiveReader::decodeSessions(std::vector<Car>& cars, std::vector<std::int64_t>& exitTimes) {
+    std::vector<std::int64_t> ids, entryTimes;
+    std::vector<double> rates;
+    std::vector<FieldView> values;
+    if (!decodeIntegers(SessionColumn::Id, ids) || !decodeIntegers(SessionColumn::EntryTime, entryTimes) ||
+        !decodeIntegers(SessionColumn::ExitTime, exitTimes) || !decodeRates(rates))
+        return false;
+
+    cars.assign(chunkRows, Car());
+    for (std::size_t i = 0; i < chunkRows; ++i) {
+        cars[i].id = static_cast<int>(ids[i]);
+        cars[i].parkingTime = std::chrono::system_clock::time_point(std::chrono::seconds(entryTimes[i]));
+        cars[i].hourlyRate = rates[i];
+    }
+    for (std::size_t c = 0; c < SESSION_COLUMNS; ++c) {
+        if (!TEXT_MEMBERS[c]) continue;
+        if (!decodeStrings(static_cast<SessionColumn>(c), values)) return false;
+        for (std::size_t i = 0; i < chunkRows; ++i) (cars[i].*TEXT_MEMBERS[c]).assign(values[i].data, values[i].size);
+    }
+    if (!decodeStrings(SessionColumn::Dynamic, values)) return false;
+    for (std::size_t i = 0; i < chunkRows; ++i) cars[i].dynamicPricing = values[i].equals("Yes");
+    return true;
+}
+
+namespace {
+
+/**
+ * @brief Every admission time recorded for one car ID, and which of them a departure has claimed.
+ */
+struct AdmissionTimes {
+    std::vector<std::int64_t> times;  ///< Sorted once all admissions are read.
+    std::vector<bool> claimed;
+
+    /**
+     * @brief Claims the latest unclaimed admission at or before an exit time.
+     * @return False if there is none.
+     */
+    bool claim(const std::int64_t exitTime, std::int64_t& entryTime) {
+        std::size_t i = static_cast<std::size_t>(std::upper_bound(times.begin(), times.end(), exitTime) - times.begin());
+        while (i > 0) {
+            --i;
+            if (claimed[i]) continue;
+            claimed[i] = true;
+            entryTime = times[i];
+            return true;
+        }
+        return false;
+    }
+};
+
+}  // namespace
+
+/**
+ * @brief Collects admission times by car ID, then streams the departures into the archive.
+ *
+ * IDs were reissued by older versions, which restarted at 1001 on every run, so one ID can have
+ * several sessions. Each departure is paired with the latest admission of its ID at or before the
+ * exit time that no earlier departure has claimed.
+ */
+ArchiveStats archiveSessionsFromCsv(const std::string& departuresPath, const std::string& carsPath,
+                                    const std::string& archivePath) {
+    ArchiveStats stats;
+    std::unordered_map<int, AdmissionTimes> entryTimes;
+    for (const std::string& path : segment_index::allFiles(carsPath)) {
+        CsvReader admissions(path);
+        if (!admissions.isOpen()) continue;
+        while (admissions.next()) {
+            int id;
+            std::chrono::system_clock::time_point entry;
+            if (car_csv::parseInt(admissions.field(car_csv::COL_ID), id) &&
+                car_csv::parseCtime(admissions.field(car_csv::COL_TIME), entry))
+                entryTimes[id].times.push_back(toSeconds(entry));
+        }
+    }
+    for (auto& admissions : entryTimes) {
+        std::sort(admissions.second.times.begin(), admissions.second.times.end());
+        admissions.second.claimed.assign(admissions.second.times.size(), false);
+    }
+
+    SessionArchiveWriter writer(archivePath);
+    if (!writer.isOpen()) return stats;
+    Car car;
+    for (const std::string& path : segment_index::allFiles(departuresPath)) {
+        CsvReader departures(path);
+        if (!departures.isOpen()) continue;
+        stats.csvBytes += departures.size();
+        while (departures.next()) {
+            if (car_csv::isHeader(departures.field(car_csv::COL_ID))) continue;
+            if (!car_csv::carFromRow(departures.fields(), car)) { ++stats.skipped; continue; }
+            const std::chrono::system_clock::time_point exitTime = car.parkingTime;
+            const auto admissions = entryTimes.find(car.id);
+            std::int64_t entry;
+            if (admissions != entryTimes.end() && admissions->second.claim(toSeconds(exitTime), entry))
+                car.parkingTime = std::chrono::system_clock::time_point(std::chrono::seconds(entry));
+            else
+                ++stats.unmatched;
+            if (!writer.append(car, exitTime)) return stats;
+            ++stats.sessions;
+        }
+    }
+    if (writer.close()) stats.archiveBytes = writer.getBytesWritten();
+    return stats;
+}
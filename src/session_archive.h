@@ -0,0 +1,218 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "car.h"
+#include "mapped_file.h"
+
+/**
+ * @brief The columns of a session archive, in their on-disk order.
+ *
+ * Id, EntryTime and ExitTime are integer columns; Rate holds doubles; every other column holds strings.
+ */
+enum class SessionColumn : std::uint8_t {
+    Id, Owner, Plate, Model, Color, Fuel, Phone, Email, Membership, Payment, Slot, Size, Rate, Dynamic,
+    EntryTime, ExitTime
+};
+
+/**
+ * @brief Number of columns in every archive chunk.
+ */
+constexpr std::size_t SESSION_COLUMNS = 16;
+
+/**
+ * @class SessionArchiveWriter
+ * @brief Writes closed parking sessions to a compressed, columnar archive file.
+ *
+ * Sessions are buffered column by column and written in chunks of up to chunkRows sessions.
+ * Within a chunk, string and rate columns are dictionary encoded with bit-packed indices, so a
+ * value like "Cash" or "Medium" is stored once per chunk and then costs a few bits per session.
+ * IDs and timestamps are delta encoded: varint block minimums plus bit-packed offsets, so runs of
+ * consecutive IDs cost almost nothing and timestamps only the bits their spread needs. Every
+ * column carries its own CRC-32 and byte length, so a reader can locate and check one column
+ * without touching the others.
+ *
+ * The archive is written to "<path>.tmp" and renamed into place by close(), so a reader never
+ * sees a half-written archive.
+ *
+ * File layout: the 8-byte magic "PKARCH01", then chunks, each
+ * [u32 rows][16 x (u32 encoding, u32 bytes, u32 crc)][u32 crc of the preceding chunk header]
+ * followed by the 16 column payloads, all little-endian.
+ */
+class SessionArchiveWriter {
+public:
+    /**
+     * @brief Creates the temporary archive file; check isOpen() for success.
+     * @param path Final path of the archive.
+     * @param chunkRows Sessions per chunk; bounds the writer's memory.
+     */
+    explicit SessionArchiveWriter(const std::string& path, std::size_t chunkRows = 65536);
+
+    /**
+     * @brief Closes the archive if close() has not been called.
+     */
+    ~SessionArchiveWriter();
+
+    SessionArchiveWriter(const SessionArchiveWriter&) = delete;
+    SessionArchiveWriter& operator=(const SessionArchiveWriter&) = delete;
+
+    /**
+     * @brief Returns true while the archive is open for writing.
+     */
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * @brief Adds one closed session; the car's parking time is its entry time.
+     * @return False if a full chunk could not be written.
+     */
+    bool append(const Car& car, std::chrono::system_clock::time_point exitTime);
+
+    /**
+     * @brief Writes the last partial chunk, syncs the file and renames it into place.
+     * @return False if any write failed; the temporary file is then removed.
+     */
+    bool close();
+
+    /**
+     * @brief Returns the number of sessions appended.
+     */
+    std::size_t getSessionCount() const { return sessions; }
+
+    /**
+     * @brief Returns the number of bytes written so far, including the magic.
+     */
+    std::size_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    /**
+     * @brief A string column being built: its dictionary and the per-row dictionary indices.
+     */
+    struct DictionaryColumn {
+        std::unordered_map<std::string, std::uint32_t> lookup;
+        std::vector<const std::string*> entries;
+        std::vector<std::uint32_t> indices;
+        void add(const std::string& value);
+    };
+
+    bool flushChunk();
+    bool writeBytes(const std::string& data);
+
+    std::string path;
+    std::string tmpPath;
+    std::size_t chunkRows;
+    int fd = -1;
+    bool failed = false;
+    std::size_t sessions = 0;
+    std::size_t bytesWritten = 0;
+    std::vector<std::int64_t> ids;
+    std::vector<std::int64_t> entryTimes;
+    std::vector<std::int64_t> exitTimes;
+    DictionaryColumn text[SESSION_COLUMNS];
+    std::string chunk;
+    std::string payload;
+};
+
+/**
+ * @class SessionArchiveReader
+ * @brief Reads a session archive chunk by chunk, decoding only the columns asked for.
+ *
+ * The archive is memory-mapped. nextChunk() checks a chunk's header and locates its columns;
+ * each decode call then checks and decodes that one column only. Decoded strings are views of
+ * the chunk's dictionary inside the mapping, so no per-session strings are allocated.
+ */
+class SessionArchiveReader {
+public:
+    /**
+     * @brief Opens and maps an archive; check isOpen() for success.
+     */
+    explicit SessionArchiveReader(const std::string& path);
+
+    /**
+     * @brief Returns true if the file was mapped and starts with the archive magic.
+     */
+    bool isOpen() const { return valid; }
+
+    /**
+     * @brief Advances to the next chunk.
+     * @return False at the end of the archive or if the chunk header is corrupt; see isCorrupt().
+     */
+    bool nextChunk();
+
+    /**
+     * @brief Returns true if reading stopped at a damaged chunk rather than the end of the file.
+     */
+    bool isCorrupt() const { return corrupt; }
+
+    /**
+     * @brief Returns the number of sessions in the current chunk.
+     */
+    std::size_t rows() const { return chunkRows; }
+
+    /**
+     * @brief Decodes an integer column (Id, EntryTime or ExitTime) of the current chunk.
+     * @return False if the column is not an integer column or fails its checksum.
+     */
+    bool decodeIntegers(SessionColumn column, std::vector<std::int64_t>& out);
+
+    /**
+     * @brief Decodes a string column of the current chunk into views of the mapping.
+     * @return False if the column is not a string column or fails its checksum.
+     */
+    bool decodeStrings(SessionColumn column, std::vector<FieldView>& out);
+
+    /**
+     * @brief Decodes the Rate column of the current chunk.
+     */
+    bool decodeRates(std::vector<double>& out);
+
+    /**
+     * @brief Decodes every column of the current chunk into cars and their exit times.
+     */
+    bool decodeSessions(std::vector<Car>& cars, std::vector<std::int64_t>& exitTimes);
+
+private:
+    bool decodeDictionary(SessionColumn column, std::vector<FieldView>& out);
+    bool columnBytes(SessionColumn column, std::uint32_t encoding, const char*& begin, const char*& end) const;
+
+    MappedFile file;
+    bool valid = false;
+    bool corrupt = false;
+    const char* cursor = nullptr;
+    std::size_t chunkRows = 0;
+    std::uint32_t encodings[SESSION_COLUMNS] = {};
+    const char* columnBegin[SESSION_COLUMNS] = {};
+    const char* columnEnd[SESSION_COLUMNS] = {};
+    std::uint32_t columnCrc[SESSION_COLUMNS] = {};
+    std::vector<FieldView> dictionary;
+};
+
+/**
+ * @struct ArchiveStats
+ * @brief Outcome of archiving the CSV session history.
+ */
+struct ArchiveStats {
+    std::size_t sessions = 0;      ///< Departure rows archived.
+    std::size_t unmatched = 0;     ///< Sessions with no admission row; archived with entry time = exit time.
+    std::size_t skipped = 0;       ///< Rows that could not be parsed.
+    std::size_t csvBytes = 0;      ///< Size of the departure files read.
+    std::size_t archiveBytes = 0;  ///< Size of the archive written.
+};
+
+/**
+ * @brief Archives every closed session of the CSV history.
+ *
+ * Each departure row of Customer_details.csv, including rotated segments, becomes one session; its
+ * entry time is taken from an admission row with the same car ID in cars_data.csv. Older histories
+ * reuse IDs, so a departure takes the latest admission of its ID at or before its exit time that no
+ * earlier departure has taken.
+ *
+ * @param departuresPath Path of the departures file ("Customer_details.csv").
+ * @param carsPath Path of the admissions file ("cars_data.csv"). May be missing.
+ * @param archivePath Path of the archive to write.
+ * @return Counts of sessions archived and the sizes before and after. archiveBytes is 0 on failure.
+ */
+ArchiveStats archiveSessionsFromCsv(const std::string& departuresPath, const std::string& carsPath,
+                                    const std::string& archivePath);
@@ -0,0 +1,93 @@
+#include "snapshot.h"
+#include "car_codec.h"
+#include "mapped_file.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Identifies a lot snapshot and its format version.
+ */
+const char SNAPSHOT_MAGIC[8] = { 'P', 'K', 'S', 'N', 'A', 'P', '0', '1' };
+
+/**
+ * @brief Size of the [lsn][next id][count] header that follows the magic.
+ */
+constexpr std::size_t STATE_HEADER = 16;
+
+bool writeAllTo(const int fd, const char* data, std::size_t length) {
+    while (length > 0) {
+        const ssize_t written = ::write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        length -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Flushes the directory holding path so that a rename inside it is durable.
+ */
+void syncParentDirectory(const std::string& path) {
+    const std::string::size_type slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return;
+    ::fsync(fd);
+    ::close(fd);
+}
+
+}  // namespace
+
+bool writeSnapshot(const std::string& path, const SnapshotState& state) {
+    std::string data(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    data.reserve(64 + state.cars.size() * 160);
+    car_codec::putU64(data, state.lsn);
+    car_codec::putU32(data, static_cast<std::uint32_t>(state.nextCarID));
+    car_codec::putU32(data, static_cast<std::uint32_t>(state.cars.size()));
+    for (const Car& car : state.cars) car_codec::encodeCar(data, car);
+    car_codec::putU32(data, car_codec::crc32(data.data() + sizeof(SNAPSHOT_MAGIC), data.size() - sizeof(SNAPSHOT_MAGIC)));
+
+    const std::string tmpPath = path + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    const bool written = writeAllTo(fd, data.data(), data.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!written || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    syncParentDirectory(path);
+    return true;
+}
+
+SnapshotStatus readSnapshot(const std::string& path, SnapshotState& state) {
+    MappedFile file(path);
+    if (!file.isOpen()) return SnapshotStatus::Missing;
+    const char* p = file.data();
+    const char* const end = p + file.size();
+    if (file.size() < sizeof(SNAPSHOT_MAGIC) + STATE_HEADER + 4 ||
+        std::memcmp(p, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+        return SnapshotStatus::Corrupt;
+    p += sizeof(SNAPSHOT_MAGIC);
+    if (car_codec::crc32(p, static_cast<std::size_t>(end - 4 - p)) != car_codec::getU32(end - 4))
+        return SnapshotStatus::Corrupt;
+
+    SnapshotState loaded;
+    loaded.lsn = car_codec::getU64(p);
+    loaded.nextCarID = static_cast<int>(car_codec::getU32(p + 8));
+    const std::uint32_t count = car_codec::getU32(p + 12);
+    p += STATE_HEADER;
+    loaded.cars.resize(count);
+    for (Car& car : loaded.cars)
+        if (!car_codec::decodeCar(p, end - 4, car)) return SnapshotStatus::Corrupt;
+    state = std::move(loaded);
+    return SnapshotStatus::Loaded;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "car.h"
+
+/**
+ * @struct SnapshotState
+ * @brief The full lot state captured by a checkpoint.
+ *
+ * Occupancy counters are not stored: they are derived from the cars and rebuilt as the cars are
+ * restored, so a snapshot can never disagree with its own index.
+ */
+struct SnapshotState {
+    std::uint64_t lsn = 0;  ///< Last event-log sequence number reflected in the snapshot.
+    int nextCarID = 0;      ///< ID the lot will assign to the next car parked.
+    std::vector<Car> cars;  ///< Cars parked at the time of the snapshot, in admission order.
+};
+
+/**
+ * @enum SnapshotStatus
+ * @brief Result of reading a snapshot file.
+ */
+enum class SnapshotStatus {
+    Missing,  ///< No snapshot file exists.
+    Loaded,   ///< The snapshot was read and its checksum verified.
+    Corrupt   ///< The file exists but its header, length or checksum is wrong.
+};
+
+/**
+ * @brief Durably replaces the snapshot at path with the given state.
+ *
+ * The file is written as "PKSNAP01", [u64 LSN][u32 next car ID][u32 car count], the cars encoded with
+ * car_codec, and a trailing CRC-32 of everything after the magic. It is written to "<path>.tmp",
+ * fsync'd, renamed over path, and the directory is fsync'd, so a crash leaves either the old or the
+ * new snapshot in place, never a partial one.
+ *
+ * @param path Path of the snapshot file.
+ * @param state The state to store.
+ * @return False if any step failed; the previous snapshot is then left untouched.
+ */
+bool writeSnapshot(const std::string& path, const SnapshotState& state);
+
+/**
+ * @brief Reads and verifies a snapshot file.
+ * @param path Path of the snapshot file.
+ * @param state Receives the stored state when the result is Loaded.
+ * @return Whether the snapshot was missing, loaded, or corrupt.
+ */
+SnapshotStatus readSnapshot(const std::string& path, SnapshotState& state);
@@ -0,0 +1,247 @@
+#include "storage_backend.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include "car_codec.h"
+#include "car_csv.h"
+#include "mapped_file.h"
+#include "persistence_queue.h"
+#include "segment_index.h"
+
+namespace {
+
+constexpr char LOG_MAGIC[8] = {'P', 'K', 'D', 'A', 'T', 'A', '0', '1'};
+
+/**
+ * @brief Bytes before a binary log payload: the type byte and the u32 payload length.
+ */
+constexpr std::size_t RECORD_HEADER = 5;
+
+std::int64_t toNanos(const std::chrono::system_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point fromNanos(const std::int64_t ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+/**
+ * @brief Hands one decoded binary log record to the target backend.
+ * @return False if the payload does not decode as its type.
+ */
+bool dispatch(const StorageRecordType type, const char* p, const char* end, StorageBackend& target) {
+    switch (type) {
+        case StorageRecordType::Admission: {
+            Car car;
+            if (!car_codec::decodeCar(p, end, car) || p != end) return false;
+            target.saveAdmission(car);
+            return true;
+        }
+        case StorageRecordType::Departure: {
+            Car car;
+            if (!car_codec::decodeCar(p, end, car) || end - p != 8) return false;
+            target.saveDeparture(car, fromNanos(static_cast<std::int64_t>(car_codec::getU64(p))));
+            return true;
+        }
+        case StorageRecordType::Bill:
+            target.saveBill(p, static_cast<std::size_t>(end - p));
+            return true;
+        case StorageRecordType::BillRecord: {
+            BillRecord record;
+            if (static_cast<std::size_t>(end - p) != bill_records::RECORD_SIZE || !bill_records::decode(p, record))
+                return false;
+            target.saveBillRecord(record);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Replays one file of a binary log, stopping at the first truncated or corrupt record.
+ */
+std::size_t replayFile(const std::string& path, StorageBackend& target) {
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() < sizeof(LOG_MAGIC) ||
+        std::memcmp(file.data(), LOG_MAGIC, sizeof(LOG_MAGIC)) != 0)
+        return 0;
+    file.adviseSequential();
+
+    std::size_t replayed = 0;
+    const char* p = file.data() + sizeof(LOG_MAGIC);
+    const char* const end = file.data() + file.size();
+    while (static_cast<std::size_t>(end - p) >= RECORD_HEADER + 4) {
+        const std::uint32_t length = car_codec::getU32(p + 1);
+        if (static_cast<std::size_t>(end - p) - RECORD_HEADER - 4 < length) break;
+        const char* payload = p + RECORD_HEADER;
+        if (car_codec::crc32(p, RECORD_HEADER + length) != car_codec::getU32(payload + length)) break;
+        if (!dispatch(static_cast<StorageRecordType>(static_cast<unsigned char>(*p)), payload, payload + length, target))
+            break;
+        ++replayed;
+        p = payload + length + 4;
+    }
+    return replayed;
+}
+
+}  // namespace
+
+/**
+ * @brief Queues the bytes for the I/O thread if the lot enabled asynchronous persistence, else appends them here.
+ */
+void StorageBackend::write(JournalWriter& journal, const char* data, const std::size_t length,
+                           const std::int64_t timestamp) {
+    if (persistence)
+        persistence->submit(journal, data, length, timestamp);
+    else
+        journal.append(data, length, timestamp);
+}
+
+CsvStorage::CsvStorage(const std::string& prefix)
+    : carsJournal(prefix + "cars_data.csv",
+                  "CarID,OwnerName,LicensePlate,Model,Color,FuelType,Phone,Email,Membership,PaymentMethod,Slot,Size,Rate,DynamicPricing,EntryTime\n"),
+      departuresJournal(prefix + "Customer_details.csv",
+                        "CarID,OwnerName,LicensePlate,Model,Color,FuelType,Phone,Email,Membership,PaymentMethod,Slot,Size,Rate,DynamicPricing,RemovedTime\n"),
+      billsJournal(prefix + "bill_history.txt"),
+      billRecordsJournal(prefix + "bill_records.bin", std::string(bill_records::FILE_MAGIC, sizeof(bill_records::FILE_MAGIC))) {
+    billRecordsJournal.setRecordSize(bill_records::RECORD_SIZE);
+}
+
+/**
+ * @brief Appends the car to "cars_data.csv", stamped with its entry time.
+ *
+ * The row is formatted in a reused buffer and handed to a long-lived journal writer, which writes
+ * the header when the file is new and batches rows into a single write per flush.
+ */
+void CsvStorage::saveAdmission(const Car& car) {
+    appendCarRow(car, std::chrono::system_clock::to_time_t(car.parkingTime), carsJournal);
+}
+
+void CsvStorage::saveDeparture(const Car& car, const std::chrono::system_clock::time_point removedAt) {
+    appendCarRow(car, std::chrono::system_clock::to_time_t(removedAt), departuresJournal);
+}
+
+void CsvStorage::appendCarRow(const Car& car, const std::time_t stamp, JournalWriter& journal) {
+    const char* timeStr = std::ctime(&stamp);
+    std::size_t timeLen = timeStr ? std::strlen(timeStr) : 0;
+    if (timeLen > 0 && timeStr[timeLen - 1] == '\n') --timeLen;
+
+    char number[32];
+    recordBuffer.clear();
+    recordBuffer.append(number, static_cast<std::size_t>(std::snprintf(number, sizeof(number), "%d", car.id)));
+    const std::string* fields[] = {
+        &car.ownerName, &car.licensePlate, &car.model, &car.color, &car.fuelType, &car.phone,
+        &car.email, &car.membership, &car.paymentMethod, &car.slot, &car.slotSize
+    };
+    for (const std::string* field : fields) {
+        recordBuffer += ',';
+        car_csv::appendField(recordBuffer, *field);
+    }
+    recordBuffer += ',';
+    recordBuffer.append(number, static_cast<std::size_t>(std::snprintf(number, sizeof(number), "%g", car.hourlyRate)));
+    recordBuffer += car.dynamicPricing ? ",Yes," : ",No,";
+    if (timeStr) recordBuffer.append(timeStr, timeLen);
+    recordBuffer += '\n';
+    write(journal, recordBuffer.data(), recordBuffer.size(), static_cast<std::int64_t>(stamp));
+}
+
+/**
+ * @brief Appends the bill to "bill_history.txt", followed by a blank line.
+ */
+void CsvStorage::saveBill(const char* text, const std::size_t length) {
+    recordBuffer.assign(text, length);
+    recordBuffer += '\n';
+    write(billsJournal, recordBuffer.data(), recordBuffer.size());
+}
+
+/**
+ * @brief Appends the bill as a fixed-width record to "bill_records.bin".
+ */
+void CsvStorage::saveBillRecord(const BillRecord& record) {
+    recordBuffer.clear();
+    bill_records::encode(recordBuffer, record);
+    write(billRecordsJournal, recordBuffer.data(), recordBuffer.size(), record.exitTime);
+}
+
+std::vector<JournalWriter*> CsvStorage::journals() {
+    return { &carsJournal, &departuresJournal, &billsJournal, &billRecordsJournal };
+}
+
+const JournalWriter* CsvStorage::journalFor(const StorageStream stream) const {
+    switch (stream) {
+    case StorageStream::Admissions:
+        return &carsJournal;
+    case StorageStream::Departures:
+        return &departuresJournal;
+    case StorageStream::Bills:
+        return &billsJournal;
+    case StorageStream::BillRecords:
+        return &billRecordsJournal;
+    }
+    return nullptr;
+}
+
+BinaryLogStorage::BinaryLogStorage(const std::string& prefix)
+    : log(prefix + "parking_data.bin", std::string(LOG_MAGIC, sizeof(LOG_MAGIC))) {}
+
+void BinaryLogStorage::saveAdmission(const Car& car) {
+    recordBuffer.assign(RECORD_HEADER, '\0');
+    car_codec::encodeCar(recordBuffer, car);
+    appendRecord(StorageRecordType::Admission);
+}
+
+void BinaryLogStorage::saveDeparture(const Car& car, const std::chrono::system_clock::time_point removedAt) {
+    recordBuffer.assign(RECORD_HEADER, '\0');
+    car_codec::encodeCar(recordBuffer, car);
+    car_codec::putU64(recordBuffer, static_cast<std::uint64_t>(toNanos(removedAt)));
+    appendRecord(StorageRecordType::Departure);
+}
+
+void BinaryLogStorage::saveBill(const char* text, const std::size_t length) {
+    recordBuffer.assign(RECORD_HEADER, '\0');
+    recordBuffer.append(text, length);
+    appendRecord(StorageRecordType::Bill);
+}
+
+void BinaryLogStorage::saveBillRecord(const BillRecord& record) {
+    recordBuffer.assign(RECORD_HEADER, '\0');
+    bill_records::encode(recordBuffer, record);
+    appendRecord(StorageRecordType::BillRecord);
+}
+
+/**
+ * @brief Fills in the type and length in front of the payload, appends the CRC and writes the record.
+ */
+void BinaryLogStorage::appendRecord(const StorageRecordType type) {
+    const std::uint32_t length = static_cast<std::uint32_t>(recordBuffer.size() - RECORD_HEADER);
+    recordBuffer[0] = static_cast<char>(type);
+    for (int i = 0; i < 4; ++i) recordBuffer[1 + i] = static_cast<char>(length >> (8 * i));
+    car_codec::putU32(recordBuffer, car_codec::crc32(recordBuffer.data(), recordBuffer.size()));
+    write(log, recordBuffer.data(), recordBuffer.size());
+}
+
+std::vector<JournalWriter*> BinaryLogStorage::journals() {
+    return { &log };
+}
+
+std::size_t BinaryLogStorage::replay(const std::string& path, StorageBackend& target) {
+    std::size_t replayed = 0;
+    for (const std::string& file : segment_index::allFiles(path)) replayed += replayFile(file, target);
+    return replayed;
+}
+
+void MemoryStorage::saveDeparture(const Car& car, const std::chrono::system_clock::time_point removedAt) {
+    Departure departure;
+    departure.car = car;
+    departure.removedAt = removedAt;
+    departures.push_back(departure);
+}
+
+std::unique_ptr<StorageBackend> makeStorageBackend(const StorageKind kind, const std::string& prefix) {
+    switch (kind) {
+        case StorageKind::BinaryLog: return std::unique_ptr<StorageBackend>(new BinaryLogStorage(prefix));
+        case StorageKind::Memory: return std::unique_ptr<StorageBackend>(new MemoryStorage());
+        case StorageKind::Csv: break;
+    }
+    return std::unique_ptr<StorageBackend>(new CsvStorage(prefix));
+}
@@ -0,0 +1,225 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bill_record.h"
+#include "car.h"
+#include "journal_writer.h"
+
+class PersistenceQueue;
+
+/**
+ * @brief The kinds of record a lot persists, for asking a backend where each one goes.
+ */
+enum class StorageStream {
+    Admissions,   ///< saveAdmission, the car rows of saveCarToCSV.
+    Departures,   ///< saveDeparture.
+    Bills,        ///< saveBill, the text of saveBillToText.
+    BillRecords   ///< saveBillRecord.
+};
+
+/**
+ * @class StorageBackend
+ * @brief Where a ParkingLot records admissions, departures and bills.
+ *
+ * The lot decides what to record and when; a backend decides the format and the medium. File-based
+ * backends write through JournalWriters, which they expose through journals() so the lot can apply
+ * flush options and flush them. When the lot enables asynchronous persistence it hands the backend
+ * its queue, and every journal write goes through the queue's I/O thread instead, whatever the backend.
+ */
+class StorageBackend {
+public:
+    virtual ~StorageBackend() = default;
+
+    /**
+     * @brief Records a car entering the lot; its parking time is the entry time.
+     */
+    virtual void saveAdmission(const Car& car) = 0;
+
+    /**
+     * @brief Records a car leaving the lot at removedAt.
+     */
+    virtual void saveDeparture(const Car& car, std::chrono::system_clock::time_point removedAt) = 0;
+
+    /**
+     * @brief Records the text of a rendered bill.
+     */
+    virtual void saveBill(const char* text, std::size_t length) = 0;
+
+    /**
+     * @brief Records the structured form of a bill.
+     */
+    virtual void saveBillRecord(const BillRecord& record) = 0;
+
+    /**
+     * @brief Returns the journals the backend writes to; empty for backends that keep nothing on disk.
+     */
+    virtual std::vector<JournalWriter*> journals() { return std::vector<JournalWriter*>(); }
+
+    /**
+     * @brief Returns the journal a kind of record is written to, or null if it is not written to disk.
+     *
+     * Backends that interleave every kind of record in one file return that journal for each kind.
+     */
+    virtual const JournalWriter* journalFor(StorageStream) const { return nullptr; }
+
+    /**
+     * @brief Routes journal writes through the given queue, or writes them directly when null.
+     */
+    void setPersistenceQueue(PersistenceQueue* queue) { persistence = queue; }
+
+protected:
+    /**
+     * @brief Appends bytes to one of the backend's journals, through the persistence queue if one is set.
+     * @param timestamp Unix seconds the record describes, used to index rotated segments.
+     */
+    void write(JournalWriter& journal, const char* data, std::size_t length,
+               std::int64_t timestamp = JournalWriter::NO_TIMESTAMP);
+
+    /**
+     * @brief Scratch buffer reused to format records without allocating per event.
+     */
+    std::string recordBuffer;
+
+private:
+    PersistenceQueue* persistence = nullptr;
+};
+
+/**
+ * @class CsvStorage
+ * @brief The original text files: cars_data.csv, Customer_details.csv, bill_history.txt and bill_records.bin.
+ *
+ * Admissions and departures are CSV rows stamped with a std::ctime time, bills are appended as text,
+ * and structured bills as fixed-width bill_records. These are the files read by loadLotFromCsv,
+ * archiveSessionsFromCsv and bill_records::reconcile.
+ */
+class CsvStorage : public StorageBackend {
+public:
+    /**
+     * @brief Creates the journals; no file is touched until the first flush.
+     * @param prefix Prepended to every file name, e.g. a directory ending in '/'.
+     */
+    explicit CsvStorage(const std::string& prefix = std::string());
+
+    void saveAdmission(const Car& car) override;
+    void saveDeparture(const Car& car, std::chrono::system_clock::time_point removedAt) override;
+    void saveBill(const char* text, std::size_t length) override;
+    void saveBillRecord(const BillRecord& record) override;
+    std::vector<JournalWriter*> journals() override;
+    const JournalWriter* journalFor(StorageStream stream) const override;
+
+private:
+    /**
+     * @brief Formats a car as a CSV row stamped with the given time and appends it to a journal.
+     */
+    void appendCarRow(const Car& car, std::time_t stamp, JournalWriter& journal);
+
+    JournalWriter carsJournal;
+    JournalWriter departuresJournal;
+    JournalWriter billsJournal;
+    JournalWriter billRecordsJournal;
+};
+
+/**
+ * @brief Kinds of records in a binary storage log.
+ */
+enum class StorageRecordType : std::uint8_t {
+    Admission = 1,   ///< Payload: car_codec encoding of the car.
+    Departure = 2,   ///< Payload: car_codec encoding of the car, then u64 removal time in ns since the epoch.
+    Bill = 3,        ///< Payload: the bill text.
+    BillRecord = 4   ///< Payload: one bill_records encoding.
+};
+
+/**
+ * @class BinaryLogStorage
+ * @brief Records everything in one append-only binary log, "parking_data.bin".
+ *
+ * Each record is [u8 type][u32 payload length][payload][u32 CRC-32 of type, length and payload].
+ * Cars are written with car_codec, so nothing is formatted as text and one journal, one write and
+ * one sync per flush cover every kind of event. replay() reads a log back into any other backend.
+ */
+class BinaryLogStorage : public StorageBackend {
+public:
+    /**
+     * @brief Creates the journal; no file is touched until the first flush.
+     * @param prefix Prepended to the file name, e.g. a directory ending in '/'.
+     */
+    explicit BinaryLogStorage(const std::string& prefix = std::string());
+
+    void saveAdmission(const Car& car) override;
+    void saveDeparture(const Car& car, std::chrono::system_clock::time_point removedAt) override;
+    void saveBill(const char* text, std::size_t length) override;
+    void saveBillRecord(const BillRecord& record) override;
+    std::vector<JournalWriter*> journals() override;
+    const JournalWriter* journalFor(StorageStream) const override { return &log; }
+
+    /**
+     * @brief Replays a binary log, including rotated segments, into another backend.
+     *
+     * Reading stops at the first truncated or corrupt record of each file.
+     *
+     * @param path Path of the log ("parking_data.bin").
+     * @param target Receives every record in order.
+     * @return The number of records replayed.
+     */
+    static std::size_t replay(const std::string& path, StorageBackend& target);
+
+private:
+    /**
+     * @brief Frames the payload in recordBuffer, which starts with reserved room for the header, and appends it.
+     */
+    void appendRecord(StorageRecordType type);
+
+    JournalWriter log;
+};
+
+/**
+ * @class MemoryStorage
+ * @brief Keeps every record in memory, for tests and for callers that inspect what the lot persisted.
+ */
+class MemoryStorage : public StorageBackend {
+public:
+    /**
+     * @struct Departure
+     * @brief A departed car and the time it left.
+     */
+    struct Departure {
+        Car car;
+        std::chrono::system_clock::time_point removedAt;
+    };
+
+    void saveAdmission(const Car& car) override { admissions.push_back(car); }
+    void saveDeparture(const Car& car, std::chrono::system_clock::time_point removedAt) override;
+    void saveBill(const char* text, std::size_t length) override { bills.emplace_back(text, length); }
+    void saveBillRecord(const BillRecord& record) override { billRecords.push_back(record); }
+
+    const std::vector<Car>& getAdmissions() const { return admissions; }
+    const std::vector<Departure>& getDepartures() const { return departures; }
+    const std::vector<std::string>& getBills() const { return bills; }
+    const std::vector<BillRecord>& getBillRecords() const { return billRecords; }
+
+private:
+    std::vector<Car> admissions;
+    std::vector<Departure> departures;
+    std::vector<std::string> bills;
+    std::vector<BillRecord> billRecords;
+};
+
+/**
+ * @brief The built-in storage backends.
+ */
+enum class StorageKind {
+    Csv,        ///< CsvStorage: the human-readable files, as before.
+    BinaryLog,  ///< BinaryLogStorage: one compact binary log.
+    Memory      ///< MemoryStorage: nothing written to disk.
+};
+
+/**
+ * @brief Creates a built-in storage backend.
+ * @param kind Which backend to create.
+ * @param prefix Prepended to the file names of file-based backends.
+ */
+std::unique_ptr<StorageBackend> makeStorageBackend(StorageKind kind, const std::string& prefix = std::string());
@@ -0,0 +1,108 @@
+#include "trace.h"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+/**
+ * @brief One completed span, in microseconds since begin().
+ */
+struct Event {
+    const char* name;
+    double startUs;
+    double durationUs;
+    unsigned thread;
+};
+
+/**
+ * @brief Spans buffered before a chunk is written to the trace file.
+ */
+constexpr std::size_t CHUNK_EVENTS = 16384;
+
+std::atomic<bool> recording(false);
+std::atomic<unsigned> nextThread(1);
+std::mutex mutex;
+std::FILE* file = nullptr;
+std::vector<Event> events;
+std::chrono::steady_clock::time_point origin;
+std::size_t spans = 0;
+bool firstEvent = true;
+
+/**
+ * @brief Returns a small, stable number for the calling thread, used as the trace "tid".
+ */
+unsigned threadNumber() {
+    static thread_local unsigned number = nextThread.fetch_add(1);
+    return number;
+}
+
+/**
+ * @brief Appends the buffered events to the file. Caller holds mutex.
+ */
+void writeEvents() {
+    for (const Event& e : events) {
+        std::fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"parking\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                     firstEvent ? "\n" : ",\n", e.name, e.startUs, e.durationUs, e.thread);
+        firstEvent = false;
+    }
+    events.clear();
+}
+
+}  // namespace
+
+bool begin(const std::string& path) {
+    end();
+    std::lock_guard<std::mutex> lock(mutex);
+    file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+    events.reserve(CHUNK_EVENTS);
+    origin = std::chrono::steady_clock::now();
+    spans = 0;
+    firstEvent = true;
+    recording.store(true);
+    return true;
+}
+
+void end() {
+    recording.store(false);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) return;
+    writeEvents();
+    std::fputs("\n]}\n", file);
+    std::fclose(file);
+    file = nullptr;
+}
+
+bool active() {
+    return recording.load(std::memory_order_relaxed);
+}
+
+std::size_t spanCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return spans;
+}
+
+/**
+ * @brief Buffers the span; every CHUNK_EVENTS spans the recording thread writes the chunk out.
+ */
+void record(const char* name, const std::chrono::steady_clock::time_point start,
+            const std::chrono::steady_clock::time_point end) {
+    const unsigned thread = threadNumber();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file) return;
+    Event event;
+    event.name = name;
+    event.startUs = std::chrono::duration<double, std::micro>(start - origin).count();
+    event.durationUs = std::chrono::duration<double, std::micro>(end - start).count();
+    event.thread = thread;
+    events.push_back(event);
+    ++spans;
+    if (events.size() >= CHUNK_EVENTS) writeEvents();
+}
+
+}  // namespace trace
@@ -0,0 +1,78 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Chrome trace-event recording of timed spans, for opening in chrome://tracing or Perfetto.
+ *
+ * Spans are placed with TRACE_SPAN, which compiles to nothing unless the build defines
+ * PARKING_TRACE (CMake option PARKING_TRACE=ON). In a tracing build a span records nothing until
+ * trace::begin() has been called. Recorded spans are buffered in memory and streamed to the
+ * trace file in chunks as "X" (complete) events with the thread they ran on.
+ */
+namespace trace {
+
+/**
+ * @brief Starts recording into a new trace file.
+ * @param path The JSON file to write; replaced if it exists.
+ * @return False if the file could not be created.
+ */
+bool begin(const std::string& path);
+
+/**
+ * @brief Writes the buffered spans, closes the JSON document and stops recording.
+ */
+void end();
+
+/**
+ * @brief Returns true between begin() and end().
+ */
+bool active();
+
+/**
+ * @brief Returns the number of spans recorded since begin().
+ */
+std::size_t spanCount();
+
+/**
+ * @brief Records one completed span. Called by Span; the name must be a string literal.
+ */
+void record(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+/**
+ * @class Span
+ * @brief Records the time from construction to destruction as a span, if a trace is active.
+ */
+class Span {
+public:
+    explicit Span(const char* name) : name(name), recording(active()) {
+        if (recording) start = std::chrono::steady_clock::now();
+    }
+
+    ~Span() {
+        if (recording) record(name, start, std::chrono::steady_clock::now());
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name;
+    bool recording;
+    std::chrono::steady_clock::time_point start;
+};
+
+}  // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Traces the rest of the enclosing scope as a span with the given literal name.
+ */
+#ifdef PARKING_TRACE
+#define TRACE_SPAN(name) ::trace::Span TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) static_cast<void>(0)
+#endif
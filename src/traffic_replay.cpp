@@ -0,0 +1,165 @@
+#include "traffic_replay.h"
+#include "car_csv.h"
+#include "csv_reader.h"
+#include "parking_lot.h"
+#include "segment_index.h"
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+/**
+ * @brief A car parked by the replay: the ID the lot gave it and the owner it was parked under.
+ */
+struct ReplayedCar {
+    int lotId;
+    std::string owner;
+};
+
+/**
+ * @brief Appends an event for every parseable row of a car file and its segments.
+ * @return The number of rows read.
+ */
+std::size_t readEvents(const std::string& path, const bool departure, std::vector<TrafficEvent>& events,
+                       std::size_t& skipped) {
+    std::size_t rows = 0;
+    for (const std::string& file : segment_index::allFiles(path)) {
+        CsvReader reader(file);
+        if (!reader.isOpen()) continue;
+        while (reader.next()) {
+            if (car_csv::isHeader(reader.field(car_csv::COL_ID))) continue;
+            TrafficEvent event;
+            if (!car_csv::carFromRow(reader.fields(), event.car)) {
+                ++skipped;
+                continue;
+            }
+            event.at = event.car.parkingTime;
+            event.departure = departure;
+            events.push_back(std::move(event));
+            ++rows;
+        }
+    }
+    return rows;
+}
+
+AdmissionRequest requestFor(const Car& car) {
+    AdmissionRequest request;
+    request.ownerName = car.ownerName;
+    request.licensePlate = car.licensePlate;
+    request.model = car.model;
+    request.color = car.color;
+    request.fuelType = car.fuelType;
+    request.phone = car.phone;
+    request.email = car.email;
+    request.membership = car.membership;
+    request.paymentMethod = car.paymentMethod;
+    request.slot = car.slot;
+    request.slotSize = car.slotSize;
+    request.reservedSlot = car.reservedSlot;
+    request.exitGate = car.exitGate;
+    request.hourlyRate = car.hourlyRate;
+    request.dynamicPricing = car.dynamicPricing;
+    return request;
+}
+
+}  // namespace
+
+std::vector<TrafficEvent> loadTraffic(const std::string& carsPath, const std::string& departuresPath,
+                                      TrafficLoadStats* stats) {
+    TrafficLoadStats counts;
+    std::vector<TrafficEvent> events;
+    counts.admissions = readEvents(carsPath, false, events, counts.skipped);
+    counts.departures = readEvents(departuresPath, true, events, counts.skipped);
+    std::stable_sort(events.begin(), events.end(), [](const TrafficEvent& a, const TrafficEvent& b) {
+        return a.at < b.at || (a.at == b.at && !a.departure && b.departure);
+    });
+    // Within one second, departures of cars that arrived earlier free their slots before the
+    // admissions of that second; a car both admitted and removed within it keeps that order.
+    std::unordered_set<int> admittedNow;
+    for (auto group = events.begin(); group != events.end();) {
+        auto groupEnd = group;
+        admittedNow.clear();
+        while (groupEnd != events.end() && groupEnd->at == group->at) {
+            if (!groupEnd->departure) admittedNow.insert(groupEnd->car.id);
+            ++groupEnd;
+        }
+        std::stable_partition(group, groupEnd, [&](const TrafficEvent& event) {
+            return event.departure && admittedNow.count(event.car.id) == 0;
+        });
+        group = groupEnd;
+    }
+    if (stats) *stats = counts;
+    return events;
+}
+
+/**
+ * @brief Sleeps until each event's scheduled time, measured from the first event, then applies it.
+ *
+ * A replay that falls behind does not skip events; it carries on as fast as it can and records
+ * how far behind it got.
+ */
+TrafficReplayStats replayTraffic(ParkingLot& lot, const std::vector<TrafficEvent>& events,
+                                 const TrafficReplayOptions& options) {
+    using namespace std::chrono;
+    TrafficReplayStats stats;
+    // Historical ID -> cars parked by this replay, oldest first; older histories reuse IDs, so one
+    // historical ID can have several cars parked and each departure takes the earliest that its owner parked
+    std::unordered_map<int, std::deque<ReplayedCar>> lotIds;
+    const steady_clock::time_point start = steady_clock::now();
+    const bool paced = options.speed > 0.0 && !events.empty();
+    for (const TrafficEvent& event : events) {
+        if (paced) {
+            const double offset = duration<double>(event.at - events.front().at).count() / options.speed;
+            const steady_clock::time_point due = start + duration_cast<steady_clock::duration>(duration<double>(offset));
+            const steady_clock::time_point now = steady_clock::now();
+            if (now < due) std::this_thread::sleep_until(due);
+            else stats.maxLagSeconds = std::max(stats.maxLagSeconds, duration<double>(now - due).count());
+        }
+        if (!event.departure) {
+            const int id = lot.admit(requestFor(event.car));
+            if (id == 0) {
+                ++stats.refused;
+                continue;
+            }
+            lotIds[event.car.id].push_back(ReplayedCar{id, event.car.ownerName});
+            ++stats.admitted;
+            continue;
+        }
+        const auto admitted = lotIds.find(event.car.id);
+        if (admitted == lotIds.end()) {
+            ++stats.unmatched;
+            continue;
+        }
+        // Only the matching car is removed, so the Remove latencies are one call per departure
+        std::deque<ReplayedCar>& parked = admitted->second;
+        const auto removed = std::find_if(parked.begin(), parked.end(), [&event](const ReplayedCar& car) {
+            return car.owner == event.car.ownerName;
+        });
+        if (removed == parked.end()) {
+            ++stats.unmatched;
+            continue;
+        }
+        const bool departed = lot.removeCarByIdAndOwner(removed->lotId, event.car.ownerName);
+        parked.erase(removed);
+        if (parked.empty()) lotIds.erase(admitted);
+        if (departed) ++stats.departed;
+        else ++stats.unmatched;
+    }
+    stats.seconds = duration<double>(steady_clock::now() - start).count();
+    return stats;
+}
+
+std::string formatTrafficReport(const TrafficReplayStats& s, const std::size_t events) {
+    char text[384];
+    std::snprintf(text, sizeof(text),
+                  "Replayed %zu events in %.3f s (%.0f events/s)\n"
+                  "Admitted %zu, refused %zu, departed %zu, unmatched departures %zu\n"
+                  "Max lag behind schedule: %.3f ms\n",
+                  events, s.seconds, s.seconds > 0.0 ? static_cast<double>(events) / s.seconds : 0.0,
+                  s.admitted, s.refused, s.departed, s.unmatched, s.maxLagSeconds * 1000.0);
+    return text;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "car.h"
+
+class ParkingLot;
+
+/**
+ * @struct TrafficEvent
+ * @brief One admission or departure taken from the lot's CSV history.
+ */
+struct TrafficEvent {
+    std::chrono::system_clock::time_point at;  ///< When it happened: the entry time or the removal time.
+    bool departure = false;                    ///< False for an admission.
+    Car car;                                   ///< The car as recorded, with its historical ID.
+};
+
+/**
+ * @struct TrafficLoadStats
+ * @brief Rows read while building a traffic timeline.
+ */
+struct TrafficLoadStats {
+    std::size_t admissions = 0;  ///< Admission rows read from the cars file.
+    std::size_t departures = 0;  ///< Departure rows read from the departures file.
+    std::size_t skipped = 0;     ///< Rows that could not be parsed.
+};
+
+/**
+ * @brief Turns cars_data.csv and Customer_details.csv into one timeline of admissions and departures.
+ *
+ * Both files are read with CsvReader, including rotated segments, oldest first. Events are ordered
+ * by time, which has the one-second resolution of the files. Within one second, departures of cars
+ * admitted earlier come first, then admissions, then departures of cars admitted in that second;
+ * otherwise the files' order is kept.
+ *
+ * @param carsPath Path of the admissions file. A missing file contributes nothing.
+ * @param departuresPath Path of the departures file. A missing file contributes nothing.
+ * @param stats Receives row counts, or null.
+ */
+std::vector<TrafficEvent> loadTraffic(const std::string& carsPath, const std::string& departuresPath,
+                                      TrafficLoadStats* stats = nullptr);
+
+/**
+ * @struct TrafficReplayOptions
+ * @brief How fast a timeline is replayed.
+ */
+struct TrafficReplayOptions {
+    /**
+     * @brief Historical seconds replayed per wall-clock second: 1 for real time, 60 for a minute a
+     *        second. 0 replays as fast as possible.
+     */
+    double speed = 1.0;
+};
+
+/**
+ * @struct TrafficReplayStats
+ * @brief What a traffic replay did and how well it kept to schedule.
+ */
+struct TrafficReplayStats {
+    std::size_t admitted = 0;      ///< Admissions the lot accepted.
+    std::size_t refused = 0;       ///< Admissions refused for lack of a slot.
+    std::size_t departed = 0;      ///< Departures that removed a car.
+    std::size_t unmatched = 0;     ///< Departures of cars this replay never admitted.
+    double seconds = 0.0;          ///< Wall time of the whole replay.
+    double maxLagSeconds = 0.0;    ///< Furthest any event fell behind its scheduled time.
+};
+
+/**
+ * @brief Replays a timeline against a lot, paced by the options.
+ *
+ * Each admission is admitted afresh, so the lot assigns it a new ID and an entry time of when it is
+ * replayed; departures are matched to it through its historical ID. When a historical ID was
+ * issued more than once, each departure takes the earliest of its admitted cars with the same owner. Cars admitted with dynamic
+ * pricing get the lot's current surge multiplier on top of the recorded rate.
+ *
+ * @param lot The lot to drive.
+ * @param events The timeline, as built by loadTraffic().
+ * @param options Replay speed.
+ */
+TrafficReplayStats replayTraffic(ParkingLot& lot, const std::vector<TrafficEvent>& events,
+                                 const TrafficReplayOptions& options);
+
+/**
+ * @brief Formats a replay's counts, throughput and lag for the console.
+ */
+std::string formatTrafficReport(const TrafficReplayStats& stats, std::size_t events);